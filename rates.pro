@@ -14,4 +14,39 @@ SOURCES += src/main.cpp \
            src/widgets/floatLegSpec.cpp \
            src/widgets/optionality.cpp \
            src/widgets/modelInfo.cpp \
-           src/widgets/mainWindow.cpp
+           src/widgets/mainWindow.cpp \
+           src/model/bermudanSwaption.cpp \
+           src/model/fastOisRateHelper.cpp \
+           src/model/curveBuilder.cpp \
+           src/model/calibrationCache.cpp \
+           src/model/g2GaussHermiteSwaptionEngine.cpp \
+           src/model/impliedVolatility.cpp \
+           src/model/hullWhiteKernels.cpp \
+           src/model/richardsonSwaptionEngine.cpp \
+           src/model/fdHullWhiteExerciseEngine.cpp \
+           src/model/controlVariateSwaptionEngine.cpp \
+           src/model/swaptionVolSurface.cpp \
+           src/model/approximateSwaption.cpp \
+           src/model/calibrationBasket.cpp \
+           src/service/pricingProtocol.cpp \
+           src/service/pricingService.cpp \
+           src/service/pricingClient.cpp \
+           src/model/evaluationContext.cpp \
+           src/model/historicalVar.cpp \
+           src/model/scenarioBook.cpp \
+           src/model/scenarioGrid.cpp \
+           src/model/rollDown.cpp \
+           src/service/marketFeed.cpp \
+           src/service/liveMarks.cpp \
+           src/model/marketUpdate.cpp \
+           src/service/quoteRing.cpp \
+           src/model/sharedMarket.cpp \
+           src/model/curveNodes.cpp \
+           src/model/checkpoint.cpp \
+           src/service/bbgWorkbook.cpp \
+           src/service/marketHistory.cpp \
+           src/service/backtest.cpp \
+           src/model/gridSwaptionEngine.cpp \
+           src/model/fdG2GridSwaptionEngine.cpp \
+           src/model/bookPricing.cpp \
+           src/model/piecewiseHullWhite.cpp
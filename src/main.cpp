@@ -14,7 +14,10 @@
 #include <QMenuBar>
 #include <QMenu>
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "mainWindow.moc"
 #include "widgets/dealInfo.h"
@@ -22,6 +25,8 @@
 #include "widgets/floatLegSpec.h"
 #include "widgets/optionality.h"
 #include "widgets/modelInfo.h"
+#include "service/marketHistory.h"
+#include "service/pricingService.h"
 
 #define WINDOW_HEIGHT 720
 #define WINDOW_WIDTH  640
@@ -126,6 +131,20 @@ QTableWidget *buildIrCurvePanel(QWidget *parent) {
 }
 
 int main(int argc, char *argv[]) {
+    // headless pricing daemon: rates --serve <socket> [workers]
+    if (argc >= 3 && std::string(argv[1]) == "--serve") {
+        PricingService service(argv[2], argc >= 4 ? std::atoi(argv[3]) : 0);
+        service.run();
+        return 0;
+    }
+
+    // BBG workbooks into the market history: rates --ingest <dir> <xlsx>...
+    if (argc >= 4 && std::string(argv[1]) == "--ingest") {
+        MarketHistory history(argv[2]);
+        std::vector<std::string> files(argv + 3, argv + argc);
+        return ingestBbgWorkbooks(history, files) == files.size() ? 0 : 1;
+    }
+
     QApplication app(argc, argv);
 
     RatesMainWindow *window = new RatesMainWindow();
@@ -142,16 +161,19 @@ int main(int argc, char *argv[]) {
     QTableWidget *marketPanel = buildMarketPanel(tabs);
     QTableWidget *oisPanel = buildIrCurvePanel(tabs);
     QTableWidget *forwardPanel = buildIrCurvePanel(tabs);
+    QTableWidget *scenarioPanel = new QTableWidget(tabs);
 
     tabs->setFixedSize(WINDOW_WIDTH, WINDOW_HEIGHT);
     tabs->addTab(pricingPanel, "Pricing");
     tabs->addTab(marketPanel,  "Market Volatility");
     tabs->addTab(oisPanel, "OIS Curve");
     tabs->addTab(forwardPanel, "Forward Curve");
+    tabs->addTab(scenarioPanel, "Scenario Grid");
 
     window->setVolTableWidget(marketPanel);
     window->setOisTableWidget(oisPanel);
     window->setForwardTableWidget(forwardPanel);
+    window->setScenarioTableWidget(scenarioPanel);
     window->setCentralWidget(centralWidget);
     window->show();
 
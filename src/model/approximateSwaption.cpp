@@ -0,0 +1,127 @@
+/*
+ * Fast approximate Bermudan swaption values off the swaption vol surface.
+ */
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/experimental/swaptions/haganirregularswaptionengine.hpp>
+#include <ql/experimental/swaptions/irregularswaption.hpp>
+#include <ql/pricingengines/blackformula.hpp>
+#include <ql/settings.hpp>
+
+#include "model/approximateSwaption.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    // coupons accruing from the exercise date on
+    Leg remainingLeg(const Leg &leg, const Date &exerciseDate) {
+        Leg remaining;
+        for (Size i = 0; i < leg.size(); i++) {
+            ext::shared_ptr<Coupon> coupon =
+                    ext::dynamic_pointer_cast<Coupon>(leg[i]);
+            if (coupon && coupon->accrualStartDate() >= exerciseDate)
+                remaining.push_back(leg[i]);
+        }
+        return remaining;
+    }
+
+}
+
+Real haganBermudanValue(const ext::shared_ptr<VanillaSwap> &swap,
+                        const ext::shared_ptr<Exercise> &exercise,
+                        const Handle<YieldTermStructure> &discountTermStructure,
+                        const Handle<SwaptionVolatilityStructure> &vol) {
+    ext::shared_ptr<PricingEngine> engine(
+            new HaganIrregularSwaptionEngine(vol, discountTermStructure));
+    IrregularSwap::Type type = (swap->type() == VanillaSwap::Payer ?
+                                IrregularSwap::Payer : IrregularSwap::Receiver);
+
+    Date today = Settings::instance().evaluationDate();
+    Real value = 0.0;
+    const std::vector<Date> &dates = exercise->dates();
+    for (Size i = 0; i < dates.size(); i++) {
+        if (dates[i] <= today)
+            continue;
+        Leg fixedLeg = remainingLeg(swap->fixedLeg(), dates[i]);
+        Leg floatLeg = remainingLeg(swap->floatingLeg(), dates[i]);
+        if (fixedLeg.empty() || floatLeg.empty())
+            continue;
+
+        IrregularSwaption european(
+                ext::make_shared<IrregularSwap>(type, fixedLeg, floatLeg),
+                ext::make_shared<EuropeanExercise>(dates[i]));
+        european.setPricingEngine(engine);
+        value = std::max(value, european.NPV());
+    }
+    return value;
+}
+
+
+ScreeningResult screenSwaption(const VanillaSwap &swap,
+                               const Exercise &exercise,
+                               const YieldTermStructure &discount,
+                               const YieldTermStructure &forecast,
+                               const SwaptionVolatilityStructure &vol,
+                               Real valueThreshold, Real moneynessThreshold) {
+    Date today = Settings::instance().evaluationDate();
+    Option::Type type = (swap.type() == VanillaSwap::Payer ?
+                         Option::Call : Option::Put);
+    Real w = (swap.type() == VanillaSwap::Payer ? 1.0 : -1.0);
+    Rate strike = swap.fixedRate();
+
+    ScreeningResult result = { 0.0, Null<Real>(), false };
+    const std::vector<Date> &exerciseDates = exercise.dates();
+    for (Size e = 0; e < exerciseDates.size(); e++) {
+        const Date &exerciseDate = exerciseDates[e];
+        if (exerciseDate <= today)
+            continue;
+
+        Real annuity = 0.0;
+        Date lastDate;
+        const std::vector<Date> &fixedDates = swap.fixedSchedule().dates();
+        for (Size i = 1; i < fixedDates.size(); i++) {
+            if (fixedDates[i - 1] < exerciseDate)
+                continue;
+            annuity += swap.fixedDayCount().yearFraction(
+                    fixedDates[i - 1], fixedDates[i]) *
+                discount.discount(fixedDates[i]);
+            lastDate = fixedDates[i];
+        }
+        Real floating = 0.0;
+        const std::vector<Date> &floatDates = swap.floatingSchedule().dates();
+        for (Size i = 1; i < floatDates.size(); i++) {
+            if (floatDates[i - 1] < exerciseDate)
+                continue;
+            floating += (forecast.discount(floatDates[i - 1]) /
+                         forecast.discount(floatDates[i]) - 1.0) *
+                discount.discount(floatDates[i]);
+        }
+        if (annuity <= 0.0)
+            continue;
+
+        Rate forward = floating / annuity;
+        Time expiry = vol.timeFromReference(exerciseDate);
+        Volatility sigma = vol.volatility(
+                expiry, vol.swapLength(exerciseDate, lastDate), strike, true);
+        Real stdDev = sigma * std::sqrt(expiry);
+        // no lognormal value to screen on: leave it to the model
+        if (forward <= 0.0 || strike <= 0.0 || stdDev <= 0.0) {
+            result.fullPricing = true;
+            return result;
+        }
+        Real value = swap.nominal() * annuity *
+            blackFormula(type, strike, forward, stdDev);
+        if (value > result.approximateValue) {
+            result.approximateValue = value;
+            result.moneyness = w * std::log(forward / strike) / stdDev;
+        }
+    }
+
+    result.fullPricing =
+        result.approximateValue > valueThreshold * swap.nominal() ||
+        (result.moneyness != Null<Real>() &&
+         std::fabs(result.moneyness) < moneynessThreshold);
+    return result;
+}
@@ -0,0 +1,49 @@
+/*
+ * Fast approximate Bermudan swaption values off the swaption vol surface.
+ */
+
+#ifndef APPROXIMATE_SWAPTION_H
+#define APPROXIMATE_SWAPTION_H
+
+#include <ql/exercise.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/termstructures/volatility/swaption/swaptionvolstructure.hpp>
+
+using namespace QuantLib;
+
+/*
+ * Largest co-terminal European, each one priced with
+ * HaganIrregularSwaptionEngine off the vol surface.  This is a lower
+ * bound of the Bermudan and, for deals far from the exercise boundary,
+ * a close one.
+ */
+Real haganBermudanValue(const ext::shared_ptr<VanillaSwap> &swap,
+                        const ext::shared_ptr<Exercise> &exercise,
+                        const Handle<YieldTermStructure> &discountTermStructure,
+                        const Handle<SwaptionVolatilityStructure> &vol);
+
+struct ScreeningResult {
+    Real approximateValue;
+    // ln(F/K) / (sigma sqrt(T)) of the chosen European, in the
+    // direction of the option
+    Real moneyness;
+    bool fullPricing;
+};
+
+/*
+ * Screening value of a Bermudan: for a plain swap Hagan's replication
+ * basket is the co-terminal swap itself, so each European is the Black
+ * value off the surface, evaluated from discount factors only.  The
+ * deal is flagged for full model pricing when its approximate value
+ * exceeds valueThreshold * nominal or its option is within
+ * moneynessThreshold standard deviations of the money, and always when
+ * a forward or the strike is not positive or a vol is zero.
+ */
+ScreeningResult screenSwaption(const VanillaSwap &swap,
+                               const Exercise &exercise,
+                               const YieldTermStructure &discount,
+                               const YieldTermStructure &forecast,
+                               const SwaptionVolatilityStructure &vol,
+                               Real valueThreshold, Real moneynessThreshold);
+
+#endif
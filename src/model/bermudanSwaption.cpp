@@ -12,6 +12,7 @@
 #include <ql/time/calendars/target.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 #include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
 #include <ql/time/daycounters/thirty360.hpp>
 #include <ql/time/schedule.hpp>
 #include <ql/math/interpolations/forwardflatinterpolation.hpp>
@@ -20,15 +21,17 @@
 
 #include <ql/instruments/swaption.hpp>
 #include <ql/pricingengines/swaption/fdhullwhiteswaptionengine.hpp>
-#include <ql/pricingengines/swaption/fdg2swaptionengine.hpp>
 #include <ql/pricingengines/swaption/treeswaptionengine.hpp>
 #include <ql/pricingengines/swaption/g2swaptionengine.hpp>
+#include <ql/pricingengines/swaption/gaussian1dswaptionengine.hpp>
 #include <ql/models/shortrate/calibrationhelpers/swaptionhelper.hpp>
 #include <ql/models/shortrate/twofactormodels/g2.hpp>
+#include <ql/models/shortrate/onefactormodels/gsr.hpp>
 #include <ql/math/array.hpp>
 #include <ql/math/optimization/levenbergmarquardt.hpp>
 #include <ql/math/optimization/simplex.hpp>
 #include <ql/math/solvers1d/bisection.hpp>
+#include <ql/math/solvers1d/brent.hpp>
 #include <ql/math/solvers1d/ridder.hpp>
 
 #include <ql/cashflows/coupon.hpp>
@@ -36,20 +39,37 @@
 
 #include <ql/experimental/shortrate/generalizedhullwhite.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <sstream>
 
 #include "model/bermudanSwaption.h"
+#include "model/approximateSwaption.h"
+#include "model/calibrationBasket.h"
+#include "model/calibrationCache.h"
+#include "model/checkpoint.h"
+#include "model/controlVariateSwaptionEngine.h"
+#include "model/curveBuilder.h"
+#include "model/fastOisRateHelper.h"
+#include "model/fdG2GridSwaptionEngine.h"
+#include "model/fdHullWhiteExerciseEngine.h"
+#include "model/g2GaussHermiteSwaptionEngine.h"
+#include "model/globalNewtonBootstrap.h"
+#include "model/hullWhiteKernels.h"
+#include "model/impliedVolatility.h"
+#include "model/piecewiseHullWhite.h"
+#include "model/richardsonSwaptionEngine.h"
+#include "model/sharedMarket.h"
+#include "model/swaptionVolSurface.h"
 
 using namespace QuantLib;
 
-#if defined(QL_ENABLE_SESSONS)
-namespace QuantLib {
-    Integer sessionId() { return 0; }
-}
-#endif
-
 Date ghwDates[] = { Date(16, July,    2019),
                     Date(16, August,  2019),
                     Date(15, October, 2019),
@@ -90,8 +110,52 @@ double liborDiscountingVols[] = {
     0.3454, 0.3361, 0.3265,
     0.3115 };
 
+/*
+ * Without an imported surface only the static basket quotes are known.
+ * They run roughly co-terminal, so they are read as a term structure of
+ * co-terminal vols in the option expiry, linear in between and flat
+ * outside; the swap end is not used.
+ */
+BasketVolatility staticBasketVolatility(const double *bsVols) {
+    Date today = Settings::instance().evaluationDate();
+    Actual365Fixed dc;
+    std::vector<Time> times;
+    std::vector<Volatility> vols;
+    for (Size i = 0; i < sizeof(maturities) / sizeof(maturities[0]); i++) {
+        times.push_back(dc.yearFraction(today, today + maturities[i]));
+        vols.push_back(bsVols[i]);
+    }
+    return [today, dc, times, vols](const Date &expiry, const Date &) {
+        Time t = dc.yearFraction(today, expiry);
+        if (t <= times.front())
+            return vols.front();
+        if (t >= times.back())
+            return vols.back();
+        Size i = std::upper_bound(times.begin(), times.end(), t)
+                - times.begin();
+        Real w = (t - times[i - 1]) / (times[i] - times[i - 1]);
+        return (1.0 - w) * vols[i - 1] + w * vols[i];
+    };
+}
+
+void printHelperFit(const ext::shared_ptr<BlackCalibrationHelper> &helper,
+                    Volatility implied) {
+    ext::shared_ptr<SwaptionHelper> swaptionHelper =
+            ext::dynamic_pointer_cast<SwaptionHelper>(helper);
+    Volatility market = helper->volatility()->value();
+    Volatility diff = implied - market;
+
+    std::cout << swaptionHelper->swaption()->exercise()->date(0) << "x"
+              << swaptionHelper->underlyingSwap()->maturityDate()
+              << std::setprecision(5) << std::noshowpos
+              << ": model " << std::setw(7) << io::volatility(implied)
+              << ", market " << std::setw(7)
+              << io::volatility(market)
+              << " (" << std::setw(7) << std::showpos
+              << io::volatility(diff) << std::noshowpos << ")\n";
+}
+
 void bbgCalibrateModel(
-          const double *bsImpliedVols,
           const ext::shared_ptr<ShortRateModel>& model,
           const std::vector<ext::shared_ptr<BlackCalibrationHelper> >& helpers,
           const std::vector<bool>& fixParameters=std::vector<bool>()) {
@@ -103,23 +167,13 @@ void bbgCalibrateModel(
     // Output the implied Black volatilities
     for (Size i=0; i<helpers.size(); i++) {
         Real npv = helpers[i]->modelValue();
-        Volatility implied = helpers[i]->impliedVolatility(npv, 1e-4,
-                1000, 0.00, 1.00);
-        Volatility diff = implied - bsImpliedVols[i];
-
-        std::cout << maturities[i] << "x"
-                  << lengths[i]
-                  << std::setprecision(5) << std::noshowpos
-                  << ": model " << std::setw(7) << io::volatility(implied)
-                  << ", market " << std::setw(7)
-                  << io::volatility(bsImpliedVols[i])
-                  << " (" << std::setw(7) << std::showpos
-                  << io::volatility(diff) << std::noshowpos << ")\n";
+        Volatility implied = swaptionImpliedVolatility(helpers[i], npv,
+                1e-4, 1000, 0.00, 1.00);
+        printHelperFit(helpers[i], implied);
     }
 }
 
 void calibrateG2Model(
-          const double *bsImpliedVols,
           const ext::shared_ptr<ShortRateModel>& model,
           const std::vector<ext::shared_ptr<BlackCalibrationHelper> >& helpers,
           double simplex) {
@@ -137,19 +191,10 @@ void calibrateG2Model(
     // Output the implied Black volatilities
     for (Size i=0; i<helpers.size(); i++) {
         Real npv = helpers[i]->modelValue();
-        Volatility implied = helpers[i]->impliedVolatility(npv, 1e-4,
-                1000, 0.05, 0.50);
+        Volatility implied = swaptionImpliedVolatility(helpers[i], npv,
+                1e-4, 1000, 0.05, 0.50);
         std::cout << npv << std::endl;
-        Volatility diff = implied - bsImpliedVols[i];
-
-        std::cout << maturities[i] << "x"
-                  << lengths[i]
-                  << std::setprecision(5) << std::noshowpos
-                  << ": model " << std::setw(7) << io::volatility(implied)
-                  << ", market " << std::setw(7)
-                  << io::volatility(bsImpliedVols[i])
-                  << " (" << std::setw(7) << std::showpos
-                  << io::volatility(diff) << std::noshowpos << ")\n";
+        printHelperFit(helpers[i], implied);
     }
 }
 
@@ -217,6 +262,14 @@ bool isConstantModel(QString complexity) {
     return complexity == QString::fromUtf8("常函数");
 }
 
+bool isGaussian1dEngine(QString engine) {
+    return engine == QString::fromUtf8("高斯积分(Gaussian1d)");
+}
+
+bool isApproximateEngine(QString engine) {
+    return engine == QString::fromUtf8("近似(Hagan)");
+}
+
 ext::shared_ptr<Exercise> getQuantLibOptionExercise(QString style,
             ext::shared_ptr<VanillaSwap> swap, Date startDate,
             bool changeFirstExerciseDate, Date firstExerciseDate){
@@ -254,86 +307,6 @@ ext::shared_ptr<Exercise> getQuantLibOptionExercise(QString style,
     return ext::shared_ptr<Exercise>(NULL);
 }
 
-ext::shared_ptr<GeneralizedHullWhite> buildGhw(
-            const Handle<YieldTermStructure> &yt, Real speed) {
-    Date dates[] = { Date(16, July,    2019),
-                     Date(16, August,  2019),
-                     Date(15, October, 2019),
-                     Date(15, January, 2020),
-                     Date(16, April,   2020),
-                     Date(16, July,    2020),
-                     Date(16, July,    2021),
-                     Date(18, July,    2022),
-                     Date(17, July,    2023),
-                     Date(16, July,    2024) };
-    Real vols[] = { 0.0075, 0.0073, 0.0073, 
-                    0.0072, 0.0073, 0.0072,
-                    0.0070, 0.0072, 0.0070,
-                    0.0075 };
-    std::vector<Date> vd = std::vector<Date>(std::begin(dates),
-                                             std::end(dates));
-    std::vector<Real> vv = std::vector<Real>(std::begin(vols),
-                                             std::end(vols));
-    std::vector<Real> vr = std::vector<Real>(vv.size(), speed);
-    return ext::make_shared<GeneralizedHullWhite>(yt, vd, vd, vr, vv);
-};
-
-// functor for equation solver
-struct ghwBlackSolverImpl {
-    ghwBlackSolverImpl(ext::shared_ptr<GeneralizedHullWhite> &model,
-            ext::shared_ptr<BlackCalibrationHelper> &helper,
-            Size index, bool fillUncalibrated):model_(model),
-                helper_(helper), index_(index),
-                size_(model_->FixedReversion().size() / 2),
-                fillUncalibrated_(fillUncalibrated) {
-    }
-
-    Real operator()(Real vol) const {
-        // size of the model
-        Disposable<Array> params = model_->params();
-        if (fillUncalibrated_) {
-            for (Size i = index_; i < size_; i++)
-                params[size_ + i] = vol;
-        } else {
-            params[size_ + index_] = vol;
-        }
-        model_->setParams(params);
-        Real npv = helper_->modelValue();
-        Volatility implied = helper_->impliedVolatility(npv, 1e-6, 1000,
-                    1e-5, 1000);
-        std::cout << "Implied vol: " << implied
-                  << " black vol: " << helper_->volatility()->value()
-                  << " spot vol: " << vol
-                  << std::endl;
-        return implied - helper_->volatility()->value();
-    }
-
-private:
-    ext::shared_ptr<GeneralizedHullWhite> &model_;
-    ext::shared_ptr<BlackCalibrationHelper> &helper_;
-    Size index_;
-    Size size_;
-    bool fillUncalibrated_;
-};
-
-void calibrateGhw( ext::shared_ptr<GeneralizedHullWhite> &model,
-        std::vector<ext::shared_ptr<BlackCalibrationHelper> >& helpers,
-        bool fillUncalibrated) {
-    // need to build a series of calibration helper.
-    // when calibrate the spot vol, the european swaption is assumed.
-    std::cout << "In calibrateGhw" << std::endl;
-
-    for (Size i = 0; i < helpers.size(); i++) {
-        ghwBlackSolverImpl solver(model, helpers[i], i, fillUncalibrated);
-        Bisection bsolver;
-        std::cout << "solve " << i << std::endl;
-        Real root = bsolver.solve(solver, 1e-5, 0.0015, 0.001, 0.02);
-    }
-
-    std::cout << "GHW calibrated." << std::endl;
-};
-
-
 void printParams( ext::shared_ptr<GeneralizedHullWhite> &model ) {
     Disposable<Array> params = model->params();
     for (Size i = 0; i < params.size(); i++)
@@ -341,67 +314,184 @@ void printParams( ext::shared_ptr<GeneralizedHullWhite> &model ) {
 }
 
 ext::shared_ptr<PricingEngine> getQuantLibPricingEngine (
-            QString model, QString engine,
-            QString complexity, Size nHelpers,
-            ext::shared_ptr<IborIndex> &liborIndex, double *bsVols,
+            QString currency, QString model, QString engine,
+            QString complexity,
+            std::vector<ext::shared_ptr<BlackCalibrationHelper> > &bbgCalibrateSwaptions,
             RelinkableHandle<YieldTermStructure> &fwdTermStructure,
-            RelinkableHandle<YieldTermStructure> &discountTermStructure) {
-    // setup calibration helpers
-    std::vector<ext::shared_ptr<BlackCalibrationHelper> > bbgCalibrateSwaptions;
-    for (Size i=0; i<nHelpers; i++) {
-        ext::shared_ptr<Quote> vol(new SimpleQuote(bsVols[i]));
-        bbgCalibrateSwaptions.push_back(
-                    ext::shared_ptr<BlackCalibrationHelper>(new
-                            SwaptionHelper(maturities[i],
-                                           lengths[i],
-                                           Handle<Quote>(vol),
-                                           liborIndex,
-                                           Period(6, Months),
-                                           Thirty360(Thirty360::USA),
-                                           Actual360(),
-                                           discountTermStructure)));
-    }
+            RelinkableHandle<YieldTermStructure> &discountTermStructure,
+            Real gridTolerance, Array *params = NULL,
+            Size *evaluations = NULL) {
+    // parameters restored from a checkpoint replace the calibration;
+    // params returns the model's parameters either way
+    bool restore = params && !params->empty();
+    // cost function or root-finder evaluations of the calibration
+    Size modelEvaluations = 0;
+
+    // warm start from the last calibration of the same model
+    Date today = Settings::instance().evaluationDate();
+    std::string cacheKey = CalibrationCache::key(
+                currency.toUtf8().constData(), model.toUtf8().constData(),
+                complexity.toUtf8().constData());
+    Array warmParams;
+    bool warmStart = CalibrationCache::instance().lookup(
+                cacheKey, today, TARGET(), warmParams);
+    if (warmStart)
+        std::cout << "Warm start " << cacheKey << ": " << warmParams << std::endl;
 
     if (model == "Hull-White One Factor") {
         if (complexity == QString::fromUtf8( "常函数" )) {
             ext::shared_ptr<HullWhite> bbgHW(
                         new HullWhite(fwdTermStructure, 0.03, 0.00727));
+            if (warmStart && warmParams.size() == 2)
+                bbgHW.reset(new HullWhite(fwdTermStructure,
+                                          warmParams[0], warmParams[1]));
+            restore = restore && params->size() == 2;
+            if (restore)
+                bbgHW.reset(new HullWhite(fwdTermStructure,
+                                          (*params)[0], (*params)[1]));
 
             std::vector<bool> bbgFixParam;
             bbgFixParam.push_back(true);
             bbgFixParam.push_back(false);
-            for (Size i = 0; i < nHelpers; i++ ) {
+            for (Size i = 0; i < bbgCalibrateSwaptions.size(); i++ ) {
                 // set pricing engine
                 bbgCalibrateSwaptions[i]->setPricingEngine(
                        ext::shared_ptr<PricingEngine>(
-                            new FdHullWhiteSwaptionEngine(bbgHW)));
+                            new BatchedJamshidianSwaptionEngine(bbgHW)));
             }
 
-            bbgCalibrateModel(
-                    bsVols, bbgHW, bbgCalibrateSwaptions, bbgFixParam);
-            std::cout << "Calibrated (with BBG vol) results: "
-                      << "a = " << bbgHW->params()[0] << ", "
-                      << "sigma = " << bbgHW->params()[1] << std::endl;
+            if (!restore) {
+                bbgCalibrateModel(
+                        bbgHW, bbgCalibrateSwaptions, bbgFixParam);
+                modelEvaluations = bbgHW->functionEvaluation();
+                std::cout << "Calibrated (with BBG vol) results: "
+                          << "a = " << bbgHW->params()[0] << ", "
+                          << "sigma = " << bbgHW->params()[1] << std::endl;
+                CalibrationCache::instance().store(
+                            cacheKey, today, bbgHW->params());
+            }
+            if (params)
+                *params = bbgHW->params();
+            if (evaluations)
+                *evaluations = modelEvaluations;
+
+            // grid error corrected by the co-terminal Europeans, which
+            // have a closed form under Hull-White; with the correction a
+            // 50 x 25 grid holds test/controlVariate's tolerance
+            ext::shared_ptr<PricingEngine> jamshidian(
+                        new BatchedJamshidianSwaptionEngine(bbgHW));
+            if (gridTolerance > 0.0)
+                return ext::shared_ptr<PricingEngine>(
+                        new RichardsonSwaptionEngine([bbgHW, jamshidian](Size n) {
+                                return ext::shared_ptr<PricingEngine>(
+                                        new ControlVariateSwaptionEngine(
+                                                ext::make_shared<FdHullWhiteExerciseSwaptionEngine>(
+                                                        bbgHW, n, n / 2),
+                                                jamshidian));
+                            }, 30, 480, gridTolerance, 2.0));
+            return ext::shared_ptr<PricingEngine>(
+                        new ControlVariateSwaptionEngine(
+                                ext::make_shared<FdHullWhiteExerciseSwaptionEngine>(
+                                        bbgHW, 50, 25),
+                                jamshidian));
+        } else if (isGaussian1dEngine(engine)) {
+            // piecewise volatility Hull-White as a Gsr model, calibrated
+            // and priced by Gauss-Hermite integration instead of trees.
+            std::chrono::steady_clock::time_point start =
+                        std::chrono::steady_clock::now();
+            ext::shared_ptr<Gsr> gsr(buildGsr(
+                            fwdTermStructure, bbgCalibrateSwaptions, 0.03));
+
+            std::cout << "Calibrate Gsr model..." << std::endl;
+            for (Size i = 0; i < bbgCalibrateSwaptions.size(); i++) {
+                bbgCalibrateSwaptions[i]->setPricingEngine(ext::shared_ptr<PricingEngine>(
+                            new Gaussian1dSwaptionEngine(gsr, 64, 7.0, true,
+                                    false, discountTermStructure)));
+            }
+
+            restore = restore && params->size() == gsr->params().size();
+            if (restore) {
+                gsr->setParams(*params);
+            } else {
+                std::string gsrKey = cacheKey + "/Gsr";
+                Array gsrParams;
+                if (CalibrationCache::instance().lookup(
+                            gsrKey, today, TARGET(), gsrParams) &&
+                        gsrParams.size() == gsr->params().size())
+                    gsr->setParams(gsrParams);
+
+                modelEvaluations += calibrateGsr(gsr, bbgCalibrateSwaptions);
+                CalibrationCache::instance().store(
+                            gsrKey, today, gsr->params());
+            }
+            if (params)
+                *params = gsr->params();
+            if (evaluations)
+                *evaluations = modelEvaluations;
+
+            std::cout << (restore ? "Gsr restored in " : "Gsr calibrated in ")
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - start).count()
+                      << " ms, sigma = " << gsr->volatility() << std::endl;
 
             return ext::shared_ptr<PricingEngine>(
-                        new FdHullWhiteSwaptionEngine(bbgHW));
+                    new Gaussian1dSwaptionEngine(gsr, 64, 7.0, true,
+                            false, discountTermStructure));
         } else {
             // calibrate piecewise Hull-White one factor
             // named generalized Hull White.
+            std::chrono::steady_clock::time_point start =
+                        std::chrono::steady_clock::now();
             ext::shared_ptr<GeneralizedHullWhite> bbgPiecewiseHW(buildGhw(
-                            fwdTermStructure, 0.03));
+                            fwdTermStructure, bbgCalibrateSwaptions, 0.03));
 
             std::cout << "Calibrate piecewise Hull-White model..." << std::endl;
-            for (Size i = 0; i < nHelpers; i++) {
+            for (Size i = 0; i < bbgCalibrateSwaptions.size(); i++) {
                 bbgCalibrateSwaptions[i]->setPricingEngine(ext::shared_ptr<PricingEngine>(
                             new TreeSwaptionEngine(bbgPiecewiseHW, 150,
                                     discountTermStructure)));
             }
 
-            calibrateGhw(bbgPiecewiseHW, bbgCalibrateSwaptions, true);
-            calibrateGhw(bbgPiecewiseHW, bbgCalibrateSwaptions, false);
-            calibrateGhw(bbgPiecewiseHW, bbgCalibrateSwaptions, false);
-
+            restore = restore &&
+                    params->size() == bbgPiecewiseHW->params().size();
+            if (restore) {
+                bbgPiecewiseHW->setParams(*params);
+            } else if (warmStart &&
+                       warmParams.size() == bbgPiecewiseHW->params().size()) {
+                // the previous pieces are already consistent, no fill pass
+                bbgPiecewiseHW->setParams(warmParams);
+                for (Size pass = 0; pass < 2; pass++)
+                    modelEvaluations += calibrateGhw(bbgPiecewiseHW,
+                                bbgCalibrateSwaptions, false, true);
+            } else {
+                modelEvaluations += calibrateGhw(bbgPiecewiseHW,
+                            bbgCalibrateSwaptions, true);
+                for (Size pass = 0; pass < 2; pass++)
+                    modelEvaluations += calibrateGhw(bbgPiecewiseHW,
+                                bbgCalibrateSwaptions, false);
+            }
+            if (!restore)
+                CalibrationCache::instance().store(
+                            cacheKey, today, bbgPiecewiseHW->params());
+            if (params)
+                *params = bbgPiecewiseHW->params();
+            if (evaluations)
+                *evaluations = modelEvaluations;
+            std::cout << (restore ? "GHW restored in " : "GHW calibrated in ")
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - start).count()
+                      << " ms" << std::endl;
+
+            if (gridTolerance > 0.0) {
+                Handle<YieldTermStructure> discount = discountTermStructure;
+                return ext::shared_ptr<PricingEngine>(
+                        new RichardsonSwaptionEngine(
+                                [bbgPiecewiseHW, discount](Size n) {
+                                return ext::shared_ptr<PricingEngine>(
+                                        new TreeSwaptionEngine(
+                                                bbgPiecewiseHW, n, discount));
+                            }, 50, 800, gridTolerance, 1.0));
+            }
             return ext::shared_ptr<PricingEngine>(
                     new TreeSwaptionEngine(
                             bbgPiecewiseHW, 500, discountTermStructure));
@@ -410,40 +500,78 @@ ext::shared_ptr<PricingEngine> getQuantLibPricingEngine (
         ext::shared_ptr<G2> g2(
                     new G2(fwdTermStructure, 0.049235,
                              0.00278221, 0.049235, 0.00916386, -0.650439));
-
-        for (Size i=0; i<nHelpers; i++) {
+        if (warmStart && warmParams.size() == 5)
+            g2.reset(new G2(fwdTermStructure, warmParams[0], warmParams[1],
+                            warmParams[2], warmParams[3], warmParams[4]));
+        restore = restore && params->size() == 5;
+        if (restore)
+            g2.reset(new G2(fwdTermStructure, (*params)[0], (*params)[1],
+                            (*params)[2], (*params)[3], (*params)[4]));
+
+        for (Size i=0; i<bbgCalibrateSwaptions.size(); i++) {
             // set pricing engine
             bbgCalibrateSwaptions[i]->setPricingEngine(
                    ext::shared_ptr<PricingEngine>(
-                        new G2SwaptionEngine(g2, 6, 100)));
+                        new G2GaussHermiteSwaptionEngine(g2, 64)));
+        }
+        if (!restore) {
+            calibrateG2Model(
+                    g2, bbgCalibrateSwaptions, 0.05);
+            modelEvaluations = g2->functionEvaluation();
+            std::cout << "Calibrated (with BBG vol) results: "
+                << g2->params() << std::endl;
+            CalibrationCache::instance().store(cacheKey, today, g2->params());
         }
-        calibrateG2Model(
-                bsVols, g2, bbgCalibrateSwaptions, 0.05);
-        std::cout << "Calibrated (with BBG vol) results: "
-            << g2->params() << std::endl;
+        if (params)
+            *params = g2->params();
+        if (evaluations)
+            *evaluations = modelEvaluations;
+        // grid error corrected by the co-terminal Europeans, priced by
+        // Gauss-Hermite integration; with the correction a 100 x 25 x 25
+        // grid holds test/controlVariate's tolerance
+        ext::shared_ptr<PricingEngine> european(
+                    new G2GaussHermiteSwaptionEngine(g2, 64));
+        if (gridTolerance > 0.0)
+            return ext::shared_ptr<PricingEngine>(
+                    new RichardsonSwaptionEngine([g2, european](Size n) {
+                            return ext::shared_ptr<PricingEngine>(
+                                    new ControlVariateSwaptionEngine(
+                                            ext::make_shared<FdG2GridSwaptionEngine>(
+                                                    g2, n, n / 2, n / 2),
+                                            european));
+                        }, 40, 320, gridTolerance, 2.0));
         return ext::shared_ptr<PricingEngine>(
-                    new FdG2SwaptionEngine(g2, 500));
+                    new ControlVariateSwaptionEngine(
+                            ext::make_shared<FdG2GridSwaptionEngine>(g2, 100, 25, 25),
+                            european));
     }
 }
 
-double *extractExternalVols(std::vector<std::vector<double> > &volSurface) {
-    double *vols = new double[10];
-    vols[ 0 ] = volSurface[ 0 ][ 5 ] / 100;
-    vols[ 1 ] = volSurface[ 1 ][ 5 ] / 100;
-    vols[ 2 ] = volSurface[ 2 ][ 4 ] / 100;
-    vols[ 3 ] = volSurface[ 3 ][ 4 ] / 100;
-    vols[ 4 ] = volSurface[ 4 ][ 4 ] / 100;
-    vols[ 5 ] = volSurface[ 5 ][ 3 ] / 100;
-    vols[ 6 ] = volSurface[ 6 ][ 2 ] / 100;
-    vols[ 7 ] = volSurface[ 7 ][ 1 ] / 100;
-    vols[ 8 ] = volSurface[ 8 ][ 0 ] / 100;
-    vols[ 9 ] = volSurface[ 9 ][ 0 ] / 100;
-
-    for (Size i = 0; i < 10; i++) {
-        std::cout << i << " " << vols[ i ] << std::endl;
+ext::shared_ptr<YieldTermStructure> buildZeroCurve(Date settlementDate,
+            const std::vector<ext::shared_ptr<ZeroYield::helper> > &helpers,
+            DayCounter dayCounter, bool useGlobalBootstrap) {
+    // the global Newton bootstrap solves all pillars at once instead of
+    // one Brent search per pillar.
+    ext::shared_ptr<YieldTermStructure> curve;
+    if (useGlobalBootstrap) {
+        curve.reset(new PiecewiseYieldCurve<ZeroYield, Linear, GlobalNewtonBootstrap>(
+                        settlementDate, helpers, dayCounter ) );
+    } else {
+        curve.reset(new PiecewiseYieldCurve<ZeroYield, Linear>(
+                        settlementDate, helpers, dayCounter ) );
     }
+    curve->enableExtrapolation();
+
+    return curve;
+}
 
-    return vols;
+// the quote a rate helper is built on, kept for the scenario engines
+Handle<Quote> marketQuote(Real value,
+            std::vector<ext::shared_ptr<SimpleQuote> > *quotes) {
+    ext::shared_ptr<SimpleQuote> quote(new SimpleQuote(value));
+    if (quotes)
+        quotes->push_back(quote);
+    return Handle<Quote>(quote);
 }
 
 void bootstrapIrTermStructure(const std::vector<Period> &oisTenors, const std::vector<double> &oisRates,
@@ -454,136 +582,214 @@ void bootstrapIrTermStructure(const std::vector<Period> &oisTenors, const std::v
             DayCounter dayCounter, ext::shared_ptr<IborIndex> liborIndex,
             bool endOfMonth, bool useDualCurve,
             RelinkableHandle<YieldTermStructure> &discountTermStructure,
-            RelinkableHandle<YieldTermStructure> &forecastTermStructure) {
+            RelinkableHandle<YieldTermStructure> &forecastTermStructure,
+            bool useGlobalBootstrap, MarketQuotes *quotes) {
+    std::vector<ext::shared_ptr<SimpleQuote> > *oisQuotes =
+            quotes ? &quotes->ois : NULL;
+    std::vector<ext::shared_ptr<SimpleQuote> > *depositQuotes =
+            quotes ? &quotes->deposits : NULL;
+    std::vector<ext::shared_ptr<SimpleQuote> > *futuresQuotes =
+            quotes ? &quotes->futures : NULL;
+    std::vector<ext::shared_ptr<SimpleQuote> > *swapRateQuotes =
+            quotes ? &quotes->swaps : NULL;
+
     // OIS curve construction
     DayCounter oisDayCounter = Actual360();
-    std::vector<ext::shared_ptr<ZeroYield::helper> > oisHelper;
-    oisHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
-                                    new DepositRateHelper(
-                                        Handle<Quote>(
-                                                ext::shared_ptr<Quote>(
-                                                    new SimpleQuote(oisRates[ 0 ]))),
-                                            Period(1, Days), settlementDays, calendar,
-                                            ModifiedFollowing, endOfMonth, oisDayCounter ) ) );
-    for (unsigned long i = 1; i < oisTenors.size(); i++) {
+    CurveBuilder::Constructor buildOisCurve = [&]() {
+        std::vector<ext::shared_ptr<ZeroYield::helper> > oisHelper;
         oisHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
-                        new OISRateHelper(
-                                settlementDays, oisTenors[ i ],
-                                Handle<Quote>(
-                                    ext::shared_ptr<Quote>(
-                                        new SimpleQuote( oisRates[ i ] )) ),
-                                ext::shared_ptr<OvernightIndex>(new FedFunds()) ) ) );
-    }
+                                        new DepositRateHelper(
+                                            marketQuote(oisRates[ 0 ], oisQuotes),
+                                                Period(1, Days), settlementDays, calendar,
+                                                ModifiedFollowing, endOfMonth, oisDayCounter ) ) );
+        for (unsigned long i = 1; i < oisTenors.size(); i++) {
+            oisHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
+                            new FastOISRateHelper(
+                                    settlementDays, oisTenors[ i ],
+                                    marketQuote(oisRates[ i ], oisQuotes),
+                                    ext::shared_ptr<OvernightIndex>(new FedFunds()) ) ) );
+        }
+        return buildZeroCurve(settlementDate, oisHelper, dayCounter,
+                              useGlobalBootstrap);
+    };
 
     // forward curve construction
     DayCounter cashDayCounter = Actual360();
-    std::vector<ext::shared_ptr<ZeroYield::helper> > depositHelper;
-    depositHelper.push_back( ext::shared_ptr<ZeroYield::helper >(
-                                        new DepositRateHelper(
-                                            Handle<Quote>(ext::shared_ptr<Quote>(
-                                                    new SimpleQuote(depositRate) ) ),
-                                                depositTenor, settlementDays, calendar,
-                                                ModifiedFollowing, endOfMonth,
-                                                cashDayCounter ) ) );
-    // futures prices represent 3m-2y futures rate
     DayCounter futuresDayCounter = Actual360();
-    for (unsigned long i = 0; i < futuresMaturities.size(); i++) {
-        depositHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
-                                        new FuturesRateHelper(
-                                            Handle<Quote>(ext::shared_ptr<Quote>(
-                                                    new SimpleQuote(futuresPrices[i]))),
-                                                futuresMaturities[i], 3, calendar,
-                                                ModifiedFollowing, endOfMonth,
-                                                futuresDayCounter,
-                                            Handle<Quote>(ext::shared_ptr<SimpleQuote>(new SimpleQuote(0.0))) ) ) );
-    }
-
-    // swap quotes
-    for (unsigned long i = 0; i < swapQuotes.size(); i++) {
-        depositHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
-                                    new SwapRateHelper(
-                                        Handle<Quote>(ext::shared_ptr<Quote>(
-                                                    new SimpleQuote(swapQuotes[ i ]))),
-                                        swapTenors[ i ], calendar, Semiannual,
-                                        ModifiedFollowing, dayCounter,
-                                        liborIndex, Handle<Quote>(), Period(0, Days),
-                                        discountTermStructure, settlementDays ) ) );
-    }
+    CurveBuilder::Constructor buildForecastCurve = [&]() {
+        std::vector<ext::shared_ptr<ZeroYield::helper> > depositHelper;
+        depositHelper.push_back( ext::shared_ptr<ZeroYield::helper >(
+                                            new DepositRateHelper(
+                                                marketQuote(depositRate, depositQuotes),
+                                                    depositTenor, settlementDays, calendar,
+                                                    ModifiedFollowing, endOfMonth,
+                                                    cashDayCounter ) ) );
+        // futures prices represent 3m-2y futures rate
+        for (unsigned long i = 0; i < futuresMaturities.size(); i++) {
+            depositHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
+                                            new FuturesRateHelper(
+                                                marketQuote(futuresPrices[i], futuresQuotes),
+                                                    futuresMaturities[i], 3, calendar,
+                                                    ModifiedFollowing, endOfMonth,
+                                                    futuresDayCounter,
+                                                Handle<Quote>(ext::shared_ptr<SimpleQuote>(new SimpleQuote(0.0))) ) ) );
+        }
 
-    ext::shared_ptr<PiecewiseYieldCurve<ZeroYield, Linear> > depoFuturesSwapCurve(
-                new PiecewiseYieldCurve<ZeroYield, Linear>(
-                        settlementDate, depositHelper, dayCounter ) );
-    ext::shared_ptr<PiecewiseYieldCurve<ZeroYield, Linear> > oisCurve(
-                new PiecewiseYieldCurve<ZeroYield, Linear>(
-                        settlementDate, oisHelper, dayCounter ) );
-    depoFuturesSwapCurve->enableExtrapolation();
-    oisCurve->enableExtrapolation();
+        // swap quotes
+        for (unsigned long i = 0; i < swapQuotes.size(); i++) {
+            depositHelper.push_back( ext::shared_ptr<ZeroYield::helper>(
+                                        new SwapRateHelper(
+                                            marketQuote(swapQuotes[ i ], swapRateQuotes),
+                                            swapTenors[ i ], calendar, Semiannual,
+                                            ModifiedFollowing, dayCounter,
+                                            liborIndex, Handle<Quote>(), Period(0, Days),
+                                            discountTermStructure, settlementDays ) ) );
+        }
+        return buildZeroCurve(settlementDate, depositHelper, dayCounter,
+                              useGlobalBootstrap);
+    };
 
+    // the forecast curve only depends on the OIS curve through the swap
+    // discounting; in single-curve mode the OIS curve is not built at all.
+    CurveBuilder builder;
     if (useDualCurve) {
-        discountTermStructure.linkTo( oisCurve );
-    }
-    else {
-        discountTermStructure.linkTo( depoFuturesSwapCurve );
+        std::vector<RelinkableHandle<YieldTermStructure> > oisHandles;
+        oisHandles.push_back(discountTermStructure);
+        builder.addCurve("OIS", std::vector<std::string>(),
+                         buildOisCurve, oisHandles);
+
+        std::vector<RelinkableHandle<YieldTermStructure> > forecastHandles;
+        forecastHandles.push_back(forecastTermStructure);
+        builder.addCurve("Forecast", std::vector<std::string>(1, "OIS"),
+                         buildForecastCurve, forecastHandles);
+    } else {
+        std::vector<RelinkableHandle<YieldTermStructure> > forecastHandles;
+        forecastHandles.push_back(discountTermStructure);
+        forecastHandles.push_back(forecastTermStructure);
+        builder.addCurve("Forecast", std::vector<std::string>(),
+                         buildForecastCurve, forecastHandles);
     }
-    forecastTermStructure.linkTo( depoFuturesSwapCurve );
+    builder.require("Forecast");
+    builder.build();
 }
 
-double priceSwaption(double notional,
-        QString currency, std::string effectiveDate, std::string maturityDate, bool changeFirstExerciseDate, std::string firstExerciseDate,
-        QString fixedDirection, double fixedCoupon, QString fixedPayFreq, std::string fixedDayCounter,
-        QString floatDirection, QString floatIndex, QString floatPayFreq, std::string floatDayCounter,
-        QString style, QString position, QString callFreq,
-        std::string today, QString model, QString engine,
-        QString complexity, QString curve, bool useExternalVolSurface,
+ext::shared_ptr<SwaptionMarket> buildSwaptionMarket(
+        std::string today, QString curve, bool useExternalVolSurface,
         std::vector<std::vector<double> > &volSurface,
+        const std::vector<std::string> &volExpiries,
+        const std::vector<std::string> &volTenors,
         std::vector<Period> &oisTenors, std::vector<double> &oisRates,
         Period depositTenor, double depositRate,
         std::vector<Date> &futuresMaturities, std::vector<double> &futuresPrices,
-        std::vector<Period> &swapTenors, std::vector<double> &swapQuotes) {
-    // unused arguments
-    currency = currency;
-    floatDirection  = floatDirection;
-    floatDayCounter = floatDayCounter;
-    position = position;
-    callFreq = callFreq;
+        std::vector<Period> &swapTenors, std::vector<double> &swapQuotes,
+        bool useGlobalBootstrap, bool storedCurves) {
+    ext::shared_ptr<SwaptionMarket> market(new SwaptionMarket);
     bool endOfMonth = true;
-    
-    Date todaysDate = DateParser::parseFormatted(today, "%Y/%m/%d");
-    Calendar calendar = TARGET();
-    int settlementDays  = 2;
-    Date settlementDate = calendar.advance(todaysDate, settlementDays,
-                Days, ModifiedFollowing);
-    Settings::instance().evaluationDate() = todaysDate;
 
-    std::cout << todaysDate << " " << settlementDate << std::endl;
+    market->today = DateParser::parseFormatted(today, "%Y/%m/%d");
+    market->calendar = TARGET();
+    int settlementDays  = 2;
+    Date settlementDate = market->calendar.advance(market->today,
+                settlementDays, Days, ModifiedFollowing);
+    Settings::instance().evaluationDate() = market->today;
 
+    std::cout << market->today << " " << settlementDate << std::endl;
 
     DayCounter fixedLegDayCounter = Thirty360();
-    RelinkableHandle<YieldTermStructure> discountTermStructure;
-    RelinkableHandle<YieldTermStructure> forecastTermStructure; 
-    ext::shared_ptr<IborIndex> liborIndex( new USDLibor( Period(3, Months), forecastTermStructure ) );
-
-    bool useDualCurve = isDualCurve(curve);
+    market->liborIndex.reset(new USDLibor(Period(3, Months),
+                                          market->forecastTermStructure));
+
+    market->useDualCurve = isDualCurve(curve);
+
+    std::ostringstream inputs;
+    inputs << std::setprecision(std::numeric_limits<double>::digits10 + 2)
+           << market->today.serialNumber() << market->useDualCurve
+           << useGlobalBootstrap << depositTenor << depositRate;
+    for (Size i = 0; i < oisTenors.size(); i++)
+        inputs << ' ' << oisTenors[i] << ' ' << oisRates[i];
+    for (Size i = 0; i < futuresMaturities.size(); i++)
+        inputs << ' ' << futuresMaturities[i].serialNumber()
+               << ' ' << futuresPrices[i];
+    for (Size i = 0; i < swapTenors.size(); i++)
+        inputs << ' ' << swapTenors[i] << ' ' << swapQuotes[i];
+    market->curveInputs = inputs.str();
+
+    // curves bootstrapped on the same inputs before a restart, or by
+    // another process
+    SharedMarket *shared = storedCurves ? SharedMarket::host() : NULL;
+    std::string curveKey;
+    if (shared) {
+        std::ostringstream key;
+        key << "curves/" << std::hex
+            << std::hash<std::string>()(market->curveInputs);
+        curveKey = key.str();
+    }
+    bool fromCheckpoint = false, fromShared = false;
+    CurveCheckpoint checkpoint;
+    if (storedCurves && loadCheckpoint(market->curveInputs, checkpoint)) {
+        std::cout << "Curves restored from the checkpoint" << std::endl;
+        market->discountTermStructure.linkTo(nodesCurve(checkpoint.discount));
+        market->forecastTermStructure.linkTo(nodesCurve(checkpoint.forecast));
+        fromCheckpoint = true;
+    } else if (shared) {
+        ext::shared_ptr<YieldTermStructure> discount =
+                shared->readCurve(curveKey + "/discount");
+        ext::shared_ptr<YieldTermStructure> forecast =
+                shared->readCurve(curveKey + "/forecast");
+        if (discount && forecast) {
+            std::cout << "Curves read from the shared market" << std::endl;
+            market->discountTermStructure.linkTo(discount);
+            market->forecastTermStructure.linkTo(forecast);
+            fromShared = true;
+        }
+    }
 
     // construct input to the bootstrap
-    bootstrapIrTermStructure(oisTenors, oisRates,
-            depositTenor, depositRate,
-            futuresMaturities, futuresPrices,
-            swapTenors, swapQuotes,
-            settlementDays, calendar, settlementDate, fixedLegDayCounter, liborIndex,
-            endOfMonth, useDualCurve,
-            discountTermStructure, forecastTermStructure);
-
-    double *bsVols = NULL;
-    if (useDualCurve) {
-        bsVols = oisDiscountingVols;
+    if (!fromCheckpoint && !fromShared)
+        bootstrapIrTermStructure(oisTenors, oisRates,
+                depositTenor, depositRate,
+                futuresMaturities, futuresPrices,
+                swapTenors, swapQuotes,
+                settlementDays, market->calendar, settlementDate,
+                fixedLegDayCounter, market->liborIndex,
+                endOfMonth, market->useDualCurve,
+                market->discountTermStructure, market->forecastTermStructure,
+                useGlobalBootstrap, &market->quotes);
+    if (storedCurves && !fromCheckpoint) {
+        checkpoint.quotes.ois = oisRates;
+        checkpoint.quotes.deposits = std::vector<Real>(1, depositRate);
+        checkpoint.quotes.futures = futuresPrices;
+        checkpoint.quotes.swaps = swapQuotes;
+        if (curveNodes(market->discountTermStructure.currentLink(),
+                       checkpoint.discount) &&
+            curveNodes(market->forecastTermStructure.currentLink(),
+                       checkpoint.forecast))
+            saveCheckpoint(market->curveInputs, checkpoint);
     }
-    else {
-        bsVols = liborDiscountingVols;
+    if (shared && !fromShared) {
+        shared->publishCurve(curveKey + "/discount",
+                             market->discountTermStructure.currentLink());
+        shared->publishCurve(curveKey + "/forecast",
+                             market->forecastTermStructure.currentLink());
     }
 
-    // if use external vol surface, read from user input.
-    if (useExternalVolSurface) bsVols = extractExternalVols(volSurface);
+    // if use external vol surface, the basket vols are read off the
+    // imported matrix
+    if (useExternalVolSurface)
+        market->volMatrix = buildSwaptionVolMatrix(volExpiries, volTenors,
+                    volSurface, market->calendar, &market->quotes.vols);
+
+    return market;
+}
+
+SwaptionDeal buildSwaptionDeal(const SwaptionMarket &market,
+        double notional,
+        std::string effectiveDate, std::string maturityDate,
+        bool changeFirstExerciseDate, std::string firstExerciseDate,
+        QString fixedDirection, double fixedCoupon, QString fixedPayFreq,
+        std::string fixedDayCounter, QString floatPayFreq, QString style) {
+    bool endOfMonth = true;
+    SwaptionDeal deal;
 
     // define the deal
     // deal property
@@ -597,56 +803,222 @@ double priceSwaption(double notional,
     BusinessDayConvention floatLegConvention = ModifiedFollowing;
 
     Date startDate = DateParser::parseFormatted(effectiveDate, "%Y/%m/%d");
-    Date maturity = DateParser::parseFormatted(maturityDate, "%Y/%m/%d");
+    deal.maturity = DateParser::parseFormatted(maturityDate, "%Y/%m/%d");
     Date firstDate = DateParser::parseFormatted(firstExerciseDate, "%Y/%m/%d");
 
     // fixed leg property
-    fixedLegDayCounter = getQuantLibDayCounter(fixedDayCounter);
+    DayCounter fixedLegDayCounter = getQuantLibDayCounter(fixedDayCounter);
     Rate fixedRate = fixedCoupon;
-    Schedule fixedSchedule(startDate, maturity, Period(fixedLegFrequency),
-                           calendar, fixedLegConvention, fixedLegConvention,
+    Schedule fixedSchedule(startDate, deal.maturity,
+                           Period(fixedLegFrequency), market.calendar,
+                           fixedLegConvention, fixedLegConvention,
                            DateGeneration::Backward, endOfMonth);
 
     // float leg property
     DayCounter floatLegDayCounter = Actual360();
-    Schedule floatSchedule(startDate, maturity, Period(floatLegFrequency),
-                           calendar,
+    Schedule floatSchedule(startDate, deal.maturity,
+                           Period(floatLegFrequency), market.calendar,
                            floatLegConvention, floatLegConvention,
                            DateGeneration::Backward, endOfMonth);
 
-    ext::shared_ptr<VanillaSwap> swap(new VanillaSwap(
+    deal.swap.reset(new VanillaSwap(
         type, notional,
         fixedSchedule, fixedRate, fixedLegDayCounter,
-        floatSchedule, liborIndex, 0.0,
+        floatSchedule, market.liborIndex, 0.0,
         floatLegDayCounter));
 
     // build the at the money swap
-    swap->setPricingEngine(ext::shared_ptr<PricingEngine>(
-                new DiscountingSwapEngine(discountTermStructure)));
+    deal.swap->setPricingEngine(ext::shared_ptr<PricingEngine>(
+                new DiscountingSwapEngine(market.discountTermStructure)));
 
     // at the money swap
-    Rate fixedATMRate = swap->fairRate();
+    Rate fixedATMRate = deal.swap->fairRate();
     std::cout << fixedATMRate << std::endl;
-    std::cout << swap->NPV() << std::endl;
+    std::cout << deal.swap->NPV() << std::endl;
 
     // construct swaption exercise
-    ext::shared_ptr<Exercise> exercise = getQuantLibOptionExercise(style,
-                swap, startDate, changeFirstExerciseDate, firstDate);
-    Swaption swaption(swap, exercise);
+    deal.exercise = getQuantLibOptionExercise(style,
+                deal.swap, startDate, changeFirstExerciseDate, firstDate);
+
+    return deal;
+}
+
+ext::shared_ptr<PricingEngine> calibrateSwaptionEngine(
+        SwaptionMarket &market, const SwaptionDeal &deal,
+        QString currency, QString model, QString engine,
+        QString complexity, Real gridTolerance, Real volScale,
+        CalibrationState *state, CalibrationReport *report) {
+    // co-terminal calibration basket on the deal's own exercise dates
+    BasketVolatility basketVol;
+    if (market.volMatrix) {
+        ext::shared_ptr<SwaptionVolGrid> volGrid(
+                    new SwaptionVolGrid(market.volMatrix));
+        basketVol = [volGrid](const Date &expiry, const Date &end) {
+            return volGrid->volatility(volGrid->optionTime(expiry),
+                                       volGrid->swapLength(expiry, end));
+        };
+    } else {
+        basketVol = staticBasketVolatility(market.useDualCurve ?
+                oisDiscountingVols : liborDiscountingVols);
+    }
+    if (volScale != 1.0) {
+        BasketVolatility unscaled = basketVol;
+        basketVol = [unscaled, volScale](const Date &expiry, const Date &end) {
+            return volScale * unscaled(expiry, end);
+        };
+    }
+    std::vector<ext::shared_ptr<BlackCalibrationHelper> > basket =
+            coterminalBasket(deal.exercise, deal.maturity, basketVol,
+                             market.liborIndex,
+                             Period(6, Months), Thirty360(Thirty360::USA),
+                             Actual360(), market.discountTermStructure);
+
+    // the given parameters only stand for this basket
+    CalibrationState current;
+    if (state) {
+        for (Size i = 0; i < basket.size(); i++) {
+            ext::shared_ptr<SwaptionHelper> helper =
+                    ext::dynamic_pointer_cast<SwaptionHelper>(basket[i]);
+            current.expiries.push_back(
+                        helper->swaption()->exercise()->date(0));
+            current.ends.push_back(helper->underlyingSwap()->maturityDate());
+            current.vols.push_back(helper->volatility()->value());
+        }
+        bool sameBasket = state->expiries == current.expiries &&
+                          state->ends == current.ends &&
+                          state->vols.size() == current.vols.size();
+        for (Size i = 0; sameBasket && i < current.vols.size(); i++)
+            sameBasket =
+                    std::fabs(state->vols[i] - current.vols[i]) < 1.0e-12;
+        if (sameBasket)
+            current.params = state->params;
+        else if (!state->params.empty())
+            std::cout << "Calibration basket changed, recalibrating"
+                      << std::endl;
+    }
 
     // pricing with generalized hull white for piece-wise term structure fit
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+    Size evaluations = 0;
     ext::shared_ptr<PricingEngine> pricingEngine = getQuantLibPricingEngine(
-                model, engine, complexity,
-                sizeof(oisDiscountingVols) / sizeof(oisDiscountingVols[0]),
-                liborIndex, bsVols,
-                forecastTermStructure,
-                discountTermStructure);
-    swaption.setPricingEngine(pricingEngine);
+                currency, model, engine, complexity, basket,
+                market.forecastTermStructure,
+                market.discountTermStructure,
+                gridTolerance, state ? &current.params : NULL,
+                &evaluations);
+
+    if (report) {
+        report->milliseconds = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+        report->evaluations = evaluations;
+        report->marketVols.clear();
+        report->modelVols.clear();
+        // the helpers are left on the model's calibration engines
+        for (Size i = 0; i < basket.size(); i++) {
+            report->marketVols.push_back(basket[i]->volatility()->value());
+            Volatility implied = Null<Volatility>();
+            try {
+                implied = swaptionImpliedVolatility(basket[i],
+                            basket[i]->modelValue(), 1e-6, 1000, 0.0, 1.0);
+            } catch (std::exception &) {}
+            report->modelVols.push_back(implied);
+        }
+    }
+    if (state)
+        *state = current;
+    return pricingEngine;
+}
 
-    std::cout << "Model price at " << swaption.NPV() << std::endl;
+ext::shared_ptr<PricingEngine> checkpointedSwaptionEngine(
+        SwaptionMarket &market, const SwaptionDeal &deal,
+        QString currency, QString model, QString engine,
+        QString complexity, Real gridTolerance,
+        CalibrationState *calibrated) {
+    std::ostringstream inputs;
+    inputs << std::setprecision(std::numeric_limits<double>::digits10 + 2)
+           << market.curveInputs << '|' << currency.toUtf8().constData()
+           << '|' << model.toUtf8().constData()
+           << '|' << engine.toUtf8().constData()
+           << '|' << complexity.toUtf8().constData()
+           << '|' << gridTolerance << '|' << deal.maturity.serialNumber();
+    const std::vector<Date> &dates = deal.exercise->dates();
+    for (Size i = 0; i < dates.size(); i++)
+        inputs << ' ' << dates[i].serialNumber();
+
+    CalibrationState state;
+    bool restored = loadCheckpoint(inputs.str(), state);
+    Array checkpointed = state.params;
+    ext::shared_ptr<PricingEngine> pricingEngine = calibrateSwaptionEngine(
+                market, deal, currency, model, engine, complexity,
+                gridTolerance, 1.0, &state);
+    // the checkpointed parameters come back unchanged unless the basket
+    // moved and the model was calibrated again
+    if (restored && state.params == checkpointed)
+        std::cout << "Model restored from the checkpoint" << std::endl;
+    else
+        saveCheckpoint(inputs.str(), state);
+    if (calibrated)
+        *calibrated = state;
+    return pricingEngine;
+}
+
+double priceSwaption(double notional,
+        QString currency, std::string effectiveDate, std::string maturityDate, bool changeFirstExerciseDate, std::string firstExerciseDate,
+        QString fixedDirection, double fixedCoupon, QString fixedPayFreq, std::string fixedDayCounter,
+        QString floatDirection, QString floatIndex, QString floatPayFreq, std::string floatDayCounter,
+        QString style, QString position, QString callFreq,
+        std::string today, QString model, QString engine,
+        QString complexity, QString curve, bool useExternalVolSurface,
+        std::vector<std::vector<double> > &volSurface,
+        const std::vector<std::string> &volExpiries,
+        const std::vector<std::string> &volTenors,
+        std::vector<Period> &oisTenors, std::vector<double> &oisRates,
+        Period depositTenor, double depositRate,
+        std::vector<Date> &futuresMaturities, std::vector<double> &futuresPrices,
+        std::vector<Period> &swapTenors, std::vector<double> &swapQuotes,
+        bool useGlobalBootstrap, bool adaptiveGrid) {
+    // unused arguments
+    floatDirection  = floatDirection;
+    floatDayCounter = floatDayCounter;
+    position = position;
+    callFreq = callFreq;
 
-    // release memory if useExternalVolSurface
-    if (useExternalVolSurface) delete [] bsVols;
+    ext::shared_ptr<SwaptionMarket> market = buildSwaptionMarket(
+                today, curve, useExternalVolSurface,
+                volSurface, volExpiries, volTenors,
+                oisTenors, oisRates, depositTenor, depositRate,
+                futuresMaturities, futuresPrices, swapTenors, swapQuotes,
+                useGlobalBootstrap, true);
+    SwaptionDeal deal = buildSwaptionDeal(*market, notional,
+                effectiveDate, maturityDate,
+                changeFirstExerciseDate, firstExerciseDate,
+                fixedDirection, fixedCoupon, fixedPayFreq, fixedDayCounter,
+                floatPayFreq, style);
+    Swaption swaption(deal.swap, deal.exercise);
+
+    // screening value straight off the imported surface, no calibration
+    if (isApproximateEngine(engine)) {
+        if (market->volMatrix) {
+            Handle<SwaptionVolatilityStructure> vol(market->volMatrix);
+            double price = haganBermudanValue(deal.swap, deal.exercise,
+                        market->discountTermStructure, vol);
+            std::cout << "Approximate price at " << price << std::endl;
+            return price;
+        }
+        std::cout << "Approximate engine needs the imported vol surface, "
+                  << "pricing with the model" << std::endl;
+    }
+
+    CalibrationState state;
+    swaption.setPricingEngine(checkpointedSwaptionEngine(*market, deal,
+                currency, model, engine, complexity,
+                adaptiveGrid ? 1.0e-5 * notional : 0.0, &state));
+    for (Size i = 0; i < state.expiries.size(); i++)
+        std::cout << "Basket " << state.expiries[i] << "x" << state.ends[i]
+                  << " " << state.vols[i] << std::endl;
+
+    std::cout << "Model price at " << swaption.NPV() << std::endl;
 
     return swaption.NPV();
 }
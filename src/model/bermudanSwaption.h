@@ -7,7 +7,12 @@
 
 #include <QString>
 
+#include <ql/exercise.hpp>
 #include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/math/array.hpp>
+#include <ql/pricingengine.hpp>
+#include <ql/quotes/simplequote.hpp>
 #include <ql/qldefines.hpp>
 #include <ql/time/calendar.hpp>
 #include <ql/time/date.hpp>
@@ -16,12 +21,24 @@
 
 #include <ql/termstructures/yield/piecewiseyieldcurve.hpp>
 #include <ql/termstructures/yield/zeroyieldstructure.hpp>
+#include <ql/termstructures/volatility/swaption/swaptionvolmatrix.hpp>
 
 #include <string>
 #include <vector>
 
 using namespace QuantLib;
 
+// the quotes the curves and the surface are built on, in the order of
+// the inputs; the scenario engines shock them in place
+struct MarketQuotes {
+    std::vector<ext::shared_ptr<SimpleQuote> > ois;
+    std::vector<ext::shared_ptr<SimpleQuote> > deposits;
+    std::vector<ext::shared_ptr<SimpleQuote> > futures;
+    std::vector<ext::shared_ptr<SimpleQuote> > swaps;
+    // decimal; empty unless the external vol surface is used
+    std::vector<std::vector<ext::shared_ptr<SimpleQuote> > > vols;
+};
+
 void bootstrapIrTermStructure(const std::vector<Period> &oisTenors, const std::vector<double> &oisRates,
             Period depositTenor, double depositRate,
             const std::vector<Date> &futuresMaturities, const std::vector<double> &futuresPrices,
@@ -30,7 +47,92 @@ void bootstrapIrTermStructure(const std::vector<Period> &oisTenors, const std::v
             DayCounter dayCounter, ext::shared_ptr<IborIndex> liborIndex,
             bool endOfMonth, bool useDualCurve,
             RelinkableHandle<YieldTermStructure> &discountTermStructure,
-            RelinkableHandle<YieldTermStructure> &forecastTermStructure);
+            RelinkableHandle<YieldTermStructure> &forecastTermStructure,
+            bool useGlobalBootstrap = false, MarketQuotes *quotes = NULL);
+
+// curves, index and surface of one pricing date, shared by all deals
+struct SwaptionMarket {
+    Date today;
+    Calendar calendar;
+    bool useDualCurve;
+    RelinkableHandle<YieldTermStructure> discountTermStructure;
+    RelinkableHandle<YieldTermStructure> forecastTermStructure;
+    ext::shared_ptr<IborIndex> liborIndex;
+    // null unless the external vol surface is used
+    ext::shared_ptr<SwaptionVolatilityMatrix> volMatrix;
+    MarketQuotes quotes;
+    // the curve inputs and conventions as text, keying stored curves
+    std::string curveInputs;
+};
+
+struct SwaptionDeal {
+    ext::shared_ptr<VanillaSwap> swap;
+    ext::shared_ptr<Exercise> exercise;
+    Date maturity;
+};
+
+// with storedCurves, curves bootstrapped on the same inputs are restored
+// from their checkpoint, or read from a host SharedMarket, and new ones
+// are stored to both; such a market has no rate quotes, so markets to
+// be shocked are built without
+ext::shared_ptr<SwaptionMarket> buildSwaptionMarket(
+        std::string today, QString curve, bool useExternalVolSurface,
+        std::vector<std::vector<double> > &volSurface,
+        const std::vector<std::string> &volExpiries,
+        const std::vector<std::string> &volTenors,
+        std::vector<Period> &oisTenors, std::vector<double> &oisRates,
+        Period depositTenor, double depositRate,
+        std::vector<Date> &futuresMaturities, std::vector<double> &futuresPrices,
+        std::vector<Period> &swapTenors, std::vector<double> &swapQuotes,
+        bool useGlobalBootstrap = false, bool storedCurves = false);
+
+SwaptionDeal buildSwaptionDeal(const SwaptionMarket &market,
+        double notional,
+        std::string effectiveDate, std::string maturityDate,
+        bool changeFirstExerciseDate, std::string firstExerciseDate,
+        QString fixedDirection, double fixedCoupon, QString fixedPayFreq,
+        std::string fixedDayCounter, QString floatPayFreq, QString style);
+
+// a calibrated model and the co-terminal basket it was calibrated to
+struct CalibrationState {
+    Array params;
+    std::vector<Date> expiries, ends;
+    std::vector<Volatility> vols;
+};
+
+// how a calibration went: per basket helper the market vol and the
+// model's implied vol
+struct CalibrationReport {
+    std::vector<Volatility> marketVols, modelVols;
+    // cost function evaluations, root-finder ones for GHW; none if the
+    // parameters were restored
+    Size evaluations;
+    double milliseconds;
+};
+
+// calibrates the model to the deal's co-terminal basket, its vols
+// scaled by volScale.  Given a state with the parameters of the same
+// model on the same basket, the model takes them and is not calibrated;
+// on return the state holds the model's parameters and its basket.  A
+// report costs one more model value per helper.
+ext::shared_ptr<PricingEngine> calibrateSwaptionEngine(
+        SwaptionMarket &market, const SwaptionDeal &deal,
+        QString currency, QString model, QString engine,
+        QString complexity, Real gridTolerance, Real volScale = 1.0,
+        CalibrationState *state = NULL, CalibrationReport *report = NULL);
+
+// calibrateSwaptionEngine() through the model checkpoints: a model
+// checkpointed on the same curve inputs, settings and exercise schedule
+// is restored if its basket is unchanged, otherwise the calibration is
+// run and checkpointed.  The state, if given, receives the basket and
+// parameters.
+ext::shared_ptr<PricingEngine> checkpointedSwaptionEngine(
+        SwaptionMarket &market, const SwaptionDeal &deal,
+        QString currency, QString model, QString engine,
+        QString complexity, Real gridTolerance,
+        CalibrationState *calibrated = NULL);
+
+bool isApproximateEngine(QString engine);
 
 double priceSwaption(double notional,
         QString currency, std::string effectiveDate, std::string maturityDate, bool changeFirstExerciseDate, std::string firstExerciseDate,
@@ -40,9 +142,12 @@ double priceSwaption(double notional,
         std::string today, QString model, QString engine,
         QString complexity, QString curve, bool useExternalVolSurface,
         std::vector<std::vector<double> > &volSurface,
+        const std::vector<std::string> &volExpiries,
+        const std::vector<std::string> &volTenors,
         std::vector<Period> &oisTenors, std::vector<double> &oisRates,
         Period depositTenor, double depositRate,
         std::vector<Date> &futuresMaturities, std::vector<double> &futuresPrices,
-        std::vector<Period> &swapTenors, std::vector<double> &swapQuotes);
+        std::vector<Period> &swapTenors, std::vector<double> &swapQuotes,
+        bool useGlobalBootstrap = false, bool adaptiveGrid = false);
 
 #endif
@@ -0,0 +1,73 @@
+/*
+ * Book revaluation screened by the approximate Bermudan values.
+ */
+
+#include <ql/instruments/swaption.hpp>
+
+#include "model/bookPricing.h"
+#include "model/evaluationContext.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+BookValuation priceSwaptionBook(const ScenarioBook &book,
+                                Real valueThreshold, Real moneynessThreshold,
+                                Size maxThreads) {
+    Size nDeals = book.deals.size();
+    QL_REQUIRE(nDeals > 0, "no deals given");
+    Size nThreads = std::min(EvaluationContext::threads(maxThreads), nDeals);
+    EvaluationContext::prepare(nThreads);
+
+    BookValuation result;
+    ScreeningResult unscreened = { Null<Real>(), Null<Real>(), true };
+    result.screening.assign(nDeals, unscreened);
+    result.prices.resize(nDeals);
+    std::atomic<Size> next(0);
+    std::vector<std::exception_ptr> errors(nThreads);
+
+    auto work = [&](Size worker) {
+        try {
+            EvaluationContext context;
+            // this worker's clone of the market
+            ext::shared_ptr<SwaptionMarket> market = book.market();
+            for (Size j = next++; j < nDeals; j = next++) {
+                SwaptionDeal deal = book.deals[j](*market);
+                ScreeningResult &screening = result.screening[j];
+                if (market->volMatrix)
+                    screening = screenSwaption(*deal.swap, *deal.exercise,
+                                **market->discountTermStructure,
+                                **market->forecastTermStructure,
+                                *market->volMatrix,
+                                valueThreshold, moneynessThreshold);
+
+                if (screening.fullPricing) {
+                    Swaption swaption(deal.swap, deal.exercise);
+                    swaption.setPricingEngine(book.engine(*market, deal, 1.0));
+                    result.prices[j] = swaption.NPV();
+                } else {
+                    result.prices[j] = screening.approximateValue;
+                }
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (Size t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (Size t = 0; t < errors.size(); t++)
+        if (errors[t])
+            std::rethrow_exception(errors[t]);
+
+    result.fullyPriced = 0;
+    for (Size j = 0; j < nDeals; j++)
+        if (result.screening[j].fullPricing)
+            result.fullyPriced++;
+    return result;
+}
@@ -0,0 +1,39 @@
+/*
+ * Book revaluation screened by the approximate Bermudan values.
+ */
+
+#ifndef BOOK_PRICING_H
+#define BOOK_PRICING_H
+
+#include "model/approximateSwaption.h"
+#include "model/scenarioBook.h"
+
+#include <vector>
+
+using namespace QuantLib;
+
+struct BookValuation {
+    // per deal, in book order; no screening values without a vol surface
+    std::vector<ScreeningResult> screening;
+    // the model price of the deals flagged for full pricing, the
+    // approximate value of the others
+    std::vector<Real> prices;
+    Size fullyPriced;
+};
+
+/*
+ * Screens every deal of the book off the market's swaption vol surface
+ * (see screenSwaption()) and prices only the flagged ones with the
+ * book's engine; without a vol surface every deal is fully priced.
+ * Every worker builds one clone of the market and takes deals one at a
+ * time.
+ *
+ * Workers run concurrently only with isolated evaluation contexts (see
+ * EvaluationContext); otherwise the run is serial.
+ */
+BookValuation priceSwaptionBook(const ScenarioBook &book,
+                                Real valueThreshold = 0.01,
+                                Real moneynessThreshold = 1.0,
+                                Size maxThreads = 0);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Deal-driven co-terminal calibration basket.
+ */
+
+#include <ql/models/shortrate/calibrationhelpers/swaptionhelper.hpp>
+#include <ql/quotes/simplequote.hpp>
+#include <ql/settings.hpp>
+
+#include "model/calibrationBasket.h"
+
+std::vector<Date> coterminalExpiries(
+        const ext::shared_ptr<Exercise> &exercise, const Date &maturity,
+        const Period &minUnderlying, const Period &minSpacing,
+        Size maxHelpers) {
+    QL_REQUIRE(maxHelpers > 0, "at least one helper needed");
+    Date today = Settings::instance().evaluationDate();
+
+    std::vector<Date> expiries;
+    const std::vector<Date> &dates = exercise->dates();
+    for (Size i = 0; i < dates.size(); i++) {
+        if (dates[i] <= today || dates[i] + minUnderlying > maturity)
+            continue;
+        if (!expiries.empty() && dates[i] < expiries.back() + minSpacing)
+            continue;
+        expiries.push_back(dates[i]);
+    }
+
+    if (expiries.size() > maxHelpers) {
+        std::vector<Date> thinned;
+        Size n = expiries.size() - 1;
+        for (Size k = 0; k < maxHelpers; k++) {
+            Size i = (maxHelpers == 1 ? 0 :
+                      (k * n + (maxHelpers - 1) / 2) / (maxHelpers - 1));
+            thinned.push_back(expiries[i]);
+        }
+        expiries.swap(thinned);
+    }
+
+    return expiries;
+}
+
+std::vector<ext::shared_ptr<BlackCalibrationHelper> > coterminalBasket(
+        const ext::shared_ptr<Exercise> &exercise, const Date &maturity,
+        const BasketVolatility &volatility,
+        const ext::shared_ptr<IborIndex> &index,
+        const Period &fixedLegTenor,
+        const DayCounter &fixedLegDayCounter,
+        const DayCounter &floatingLegDayCounter,
+        const Handle<YieldTermStructure> &discountTermStructure,
+        Size maxHelpers, const Period &minSpacing) {
+    std::vector<Date> expiries = coterminalExpiries(exercise, maturity,
+                fixedLegTenor, minSpacing, maxHelpers);
+    QL_REQUIRE(!expiries.empty(),
+               "no exercise date left to calibrate to before " << maturity);
+
+    std::vector<ext::shared_ptr<BlackCalibrationHelper> > helpers;
+    for (Size i = 0; i < expiries.size(); i++) {
+        Volatility vol = volatility(expiries[i], maturity);
+        helpers.push_back(ext::shared_ptr<BlackCalibrationHelper>(
+                    new SwaptionHelper(expiries[i], maturity,
+                            Handle<Quote>(ext::make_shared<SimpleQuote>(vol)),
+                            index, fixedLegTenor,
+                            fixedLegDayCounter, floatingLegDayCounter,
+                            discountTermStructure)));
+    }
+
+    return helpers;
+}
@@ -0,0 +1,53 @@
+/*
+ * Deal-driven co-terminal calibration basket.
+ */
+
+#ifndef CALIBRATION_BASKET_H
+#define CALIBRATION_BASKET_H
+
+#include <ql/exercise.hpp>
+#include <ql/indexes/iborindex.hpp>
+#include <ql/models/calibrationhelper.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <functional>
+#include <vector>
+
+using namespace QuantLib;
+
+// Black volatility of the swaption expiring on the first date into a
+// swap ending on the second one
+typedef std::function<Volatility(const Date &, const Date &)>
+        BasketVolatility;
+
+/*
+ * The exercise dates worth a helper: after the evaluation date, with at
+ * least minUnderlying of swap left to maturity, and at least minSpacing
+ * after the previously kept one.  The first exercise is always kept, as
+ * it carries most of the option value; if more than maxHelpers remain,
+ * they are thinned evenly, again keeping the first and the last.
+ */
+std::vector<Date> coterminalExpiries(
+        const ext::shared_ptr<Exercise> &exercise, const Date &maturity,
+        const Period &minUnderlying, const Period &minSpacing,
+        Size maxHelpers);
+
+/*
+ * One at-the-money co-terminal swaption helper per kept exercise date,
+ * all into the deal maturity, in the same conventions as the static
+ * basket.  This is the Naive basket of BasketGeneratingEngine without
+ * requiring a Gaussian1d model or a swap index, so it also serves the
+ * Hull-White, GHW and G2 calibrations.
+ */
+std::vector<ext::shared_ptr<BlackCalibrationHelper> > coterminalBasket(
+        const ext::shared_ptr<Exercise> &exercise, const Date &maturity,
+        const BasketVolatility &volatility,
+        const ext::shared_ptr<IborIndex> &index,
+        const Period &fixedLegTenor,
+        const DayCounter &fixedLegDayCounter,
+        const DayCounter &floatingLegDayCounter,
+        const Handle<YieldTermStructure> &discountTermStructure,
+        Size maxHelpers = 10,
+        const Period &minSpacing = Period(6, Months));
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Persistent cache of calibrated model parameters for warm starts.
+ */
+
+#include "model/calibrationCache.h"
+#include "model/sharedMarket.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#define CALIBRATION_CACHE_FILE "calibration.cache"
+
+namespace {
+
+    thread_local bool readOnly = false;
+    thread_local CalibrationCache::Chain *chain = NULL;
+
+}
+
+CalibrationCache &CalibrationCache::instance() {
+    static CalibrationCache cache(CALIBRATION_CACHE_FILE);
+    return cache;
+}
+
+CalibrationCache::CalibrationCache(const std::string &filename)
+    : filename_(filename) {
+    load();
+}
+
+std::string CalibrationCache::key(const std::string &currency,
+            const std::string &model, const std::string &complexity) {
+    return currency + "/" + model + "/" + complexity;
+}
+
+bool CalibrationCache::lookup(const std::string &key, const Date &today,
+            const Calendar &calendar, Array &params) const {
+    if (chain) {
+        Chain::const_iterator it = chain->find(key);
+        if (it == chain->end())
+            return false;
+        params = it->second;
+        return true;
+    }
+
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::map<std::string, Entry>::const_iterator it = entries_.find(key);
+        if (it != entries_.end())
+            entry = it->second;
+    }
+
+    // a calibration by another process on the host, if more recent
+    Date sharedDate;
+    Array sharedParams;
+    SharedMarket *shared = SharedMarket::host();
+    if (shared && shared->readParameters(key, sharedDate, sharedParams) &&
+            sharedDate <= today &&
+            (entry.date == Date() || sharedDate >= entry.date)) {
+        entry.date = sharedDate;
+        entry.params = sharedParams;
+    }
+    if (entry.date == Date())
+        return false;
+
+    // same business day or the next one
+    const Date &calibrated = entry.date;
+    if (calibrated > today ||
+            calendar.advance(calibrated, 1, Days) < today)
+        return false;
+
+    params = entry.params;
+    return true;
+}
+
+void CalibrationCache::store(const std::string &key, const Date &today,
+            const Array &params) {
+    if (chain) {
+        (*chain)[key] = params;
+        return;
+    }
+    if (readOnly)
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    entry.date = today;
+    entry.params = params;
+    entries_[key] = entry;
+    save();
+
+    SharedMarket *shared = SharedMarket::host();
+    if (shared)
+        shared->publishParameters(key, today, params);
+}
+
+CalibrationCache::ReadOnly::ReadOnly() : previous_(readOnly) {
+    readOnly = true;
+}
+
+CalibrationCache::ReadOnly::~ReadOnly() {
+    readOnly = previous_;
+}
+
+void CalibrationCache::load() {
+    // one entry per line: key <tab> serial date <tab> n p1 ... pn
+    std::ifstream input(filename_.c_str());
+    std::string line;
+    while (std::getline(input, line)) {
+        std::string::size_type first = line.find('\t');
+        std::string::size_type second = line.find('\t', first + 1);
+        if (first == std::string::npos || second == std::string::npos)
+            continue;
+
+        std::istringstream values(line.substr(first + 1));
+        BigInteger serial;
+        Size n;
+        if (!(values >> serial >> n))
+            continue;
+        Entry entry;
+        entry.date = Date(serial);
+        entry.params = Array(n);
+        bool complete = true;
+        for (Size i = 0; i < n && complete; i++)
+            complete = bool(values >> entry.params[i]);
+        if (complete)
+            entries_[line.substr(0, first)] = entry;
+    }
+}
+
+void CalibrationCache::save() const {
+    std::ofstream output(filename_.c_str());
+    output << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    for (std::map<std::string, Entry>::const_iterator it = entries_.begin();
+         it != entries_.end(); ++it) {
+        output << it->first << "\t"
+               << it->second.date.serialNumber() << "\t"
+               << it->second.params.size();
+        for (Size i = 0; i < it->second.params.size(); i++)
+            output << " " << it->second.params[i];
+        output << std::endl;
+    }
+
+    if (!output)
+        std::cout << "Failed to save " << filename_ << std::endl;
+}
+
+CalibrationCache::Chained::Chained(Chain &chain) : previous_(::chain) {
+    ::chain = &chain;
+}
+
+CalibrationCache::Chained::~Chained() {
+    ::chain = previous_;
+}
@@ -0,0 +1,77 @@
+/*
+ * Persistent cache of calibrated model parameters for warm starts.
+ */
+
+#ifndef CALIBRATION_CACHE_H
+#define CALIBRATION_CACHE_H
+
+#include <ql/math/array.hpp>
+#include <ql/time/calendar.hpp>
+#include <ql/time/date.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+using namespace QuantLib;
+
+/*
+ * Keeps the last converged parameter vector per (currency, model,
+ * complexity), with the date it was calibrated on, in a small text file.
+ * A cached vector is only offered as a starting point on the same
+ * business day or the next one; older entries are ignored.  With a host
+ * SharedMarket, stores are published to it too and lookups take the
+ * more recent of the local and the shared entry.
+ */
+class CalibrationCache {
+public:
+    static CalibrationCache &instance();
+
+    static std::string key(const std::string &currency,
+                           const std::string &model,
+                           const std::string &complexity);
+
+    // true and fills params if a usable entry exists for today
+    bool lookup(const std::string &key, const Date &today,
+                const Calendar &calendar, Array &params) const;
+    void store(const std::string &key, const Date &today,
+               const Array &params);
+
+    // stores from the calling thread are dropped for the scope, so that
+    // scenario recalibrations do not overwrite the base parameters
+    class ReadOnly {
+    public:
+        ReadOnly();
+        ~ReadOnly();
+    private:
+        bool previous_;
+    };
+
+    // lookups and stores from the calling thread go to the chain for the
+    // scope, which offers the last parameters stored whatever their date,
+    // so that a walk over dates warm-starts each one from the one before
+    typedef std::map<std::string, Array> Chain;
+    class Chained {
+    public:
+        explicit Chained(Chain &chain);
+        ~Chained();
+    private:
+        Chain *previous_;
+    };
+
+private:
+    explicit CalibrationCache(const std::string &filename);
+    void load();
+    void save() const;
+
+    struct Entry {
+        Date date;
+        Array params;
+    };
+
+    std::string filename_;
+    std::map<std::string, Entry> entries_;
+    mutable std::mutex mutex_;
+};
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * Versioned binary checkpoints of bootstrapped curves and calibrated
+ * models, for restarting without redoing either.
+ */
+
+#include <ql/errors.hpp>
+
+#include "model/checkpoint.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHECKPOINT_DIR "checkpoints"
+#define CHECKPOINT_MAGIC "RCKP"
+#define CHECKPOINT_VERSION 1
+
+namespace {
+
+    enum CheckpointKind {
+        CurveCheckpointKind = 1,
+        ModelCheckpointKind = 2
+    };
+
+    class Writer {
+    public:
+        void u8(std::uint8_t v) { raw(&v, sizeof(v)); }
+        void u32(std::uint32_t v) { raw(&v, sizeof(v)); }
+        void f64(double v) { raw(&v, sizeof(v)); }
+        void str(const std::string &v) {
+            u32(std::uint32_t(v.size()));
+            buffer_.append(v);
+        }
+        void date(const Date &v) { u32(std::uint32_t(v.serialNumber())); }
+        void f64s(const std::vector<Real> &v) {
+            u32(std::uint32_t(v.size()));
+            for (Size i = 0; i < v.size(); i++)
+                f64(v[i]);
+        }
+        void dates(const std::vector<Date> &v) {
+            u32(std::uint32_t(v.size()));
+            for (Size i = 0; i < v.size(); i++)
+                date(v[i]);
+        }
+        void nodes(const CurveNodes &v) {
+            u8(std::uint8_t(dayCounterCode(v.dayCounter)));
+            dates(v.dates);
+            f64s(v.zeroRates);
+        }
+
+        const std::string &buffer() const { return buffer_; }
+
+    private:
+        void raw(const void *p, std::size_t n) {
+            buffer_.append(static_cast<const char *>(p), n);
+        }
+
+        std::string buffer_;
+    };
+
+    class Reader {
+    public:
+        explicit Reader(const std::string &buffer)
+        : p_(buffer.data()), end_(buffer.data() + buffer.size()) {}
+
+        std::uint8_t u8() { std::uint8_t v; raw(&v, sizeof(v)); return v; }
+        std::uint32_t u32() { std::uint32_t v; raw(&v, sizeof(v)); return v; }
+        double f64() { double v; raw(&v, sizeof(v)); return v; }
+        std::string str() {
+            std::uint32_t n = u32();
+            need(n);
+            std::string v(p_, n);
+            p_ += n;
+            return v;
+        }
+        Date date() { return Date(BigInteger(u32())); }
+        std::vector<Real> f64s() {
+            std::vector<Real> v(count(sizeof(double)));
+            for (Size i = 0; i < v.size(); i++)
+                v[i] = f64();
+            return v;
+        }
+        std::vector<Date> dates() {
+            std::vector<Date> v(count(sizeof(std::uint32_t)));
+            for (Size i = 0; i < v.size(); i++)
+                v[i] = date();
+            return v;
+        }
+        CurveNodes nodes() {
+            CurveNodes v;
+            v.dayCounter = codeDayCounter(u8());
+            v.dates = dates();
+            v.zeroRates = f64s();
+            QL_REQUIRE(v.dates.size() == v.zeroRates.size() &&
+                       v.dates.size() >= 2, "malformed curve nodes");
+            return v;
+        }
+
+        void finish() const {
+            QL_REQUIRE(p_ == end_, "trailing bytes");
+        }
+
+    private:
+        Size count(std::size_t size) {
+            std::uint32_t n = u32();
+            need(std::size_t(n) * size);
+            return n;
+        }
+        void need(std::size_t n) const {
+            QL_REQUIRE(std::size_t(end_ - p_) >= n, "truncated");
+        }
+        void raw(void *v, std::size_t n) {
+            need(n);
+            std::memcpy(v, p_, n);
+            p_ += n;
+        }
+
+        const char *p_, *end_;
+    };
+
+    std::string checkpointFile(const std::string &inputs,
+                               CheckpointKind kind) {
+        std::ostringstream name;
+        name << CHECKPOINT_DIR << "/" << std::hex
+             << std::hash<std::string>()(inputs)
+             << (kind == CurveCheckpointKind ? ".curves" : ".model");
+        return name.str();
+    }
+
+    // the state of the checkpoint on these inputs, or false
+    bool readCheckpoint(const std::string &inputs, CheckpointKind kind,
+                        std::string &state) {
+        std::string filename = checkpointFile(inputs, kind);
+        std::ifstream input(filename.c_str(), std::ios::binary);
+        if (!input)
+            return false;
+        std::ostringstream contents;
+        contents << input.rdbuf();
+
+        std::string data = contents.str();
+        try {
+            Reader r(data);
+            std::string magic(4, ' ');
+            for (Size i = 0; i < magic.size(); i++)
+                magic[i] = char(r.u8());
+            QL_REQUIRE(magic == CHECKPOINT_MAGIC, "not a checkpoint");
+            std::uint32_t version = r.u32();
+            QL_REQUIRE(version == CHECKPOINT_VERSION,
+                       "version " << version << ", expected "
+                       << CHECKPOINT_VERSION);
+            QL_REQUIRE(r.u8() == kind, "wrong kind of checkpoint");
+            if (r.str() != inputs) {
+                std::cout << "Checkpoint " << filename
+                          << " is on other inputs, ignored" << std::endl;
+                return false;
+            }
+            state = r.str();
+            r.finish();
+        } catch (std::exception &e) {
+            std::cout << "Checkpoint " << filename << " ignored: "
+                      << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool writeCheckpoint(const std::string &inputs, CheckpointKind kind,
+                         const std::string &state) {
+        if (::mkdir(CHECKPOINT_DIR, 0755) != 0 && errno != EEXIST) {
+            std::cout << "Cannot create " << CHECKPOINT_DIR << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        Writer w;
+        for (const char *p = CHECKPOINT_MAGIC; *p; p++)
+            w.u8(std::uint8_t(*p));
+        w.u32(CHECKPOINT_VERSION);
+        w.u8(std::uint8_t(kind));
+        w.str(inputs);
+        w.str(state);
+
+        std::string filename = checkpointFile(inputs, kind);
+        // the GUI and the daemon may write the same checkpoint at once;
+        // each writes its own file and the last rename wins
+        std::ostringstream unique;
+        unique << filename << '.' << ::getpid() << '.'
+               << std::this_thread::get_id() << ".tmp";
+        std::string partial = unique.str();
+        {
+            std::ofstream output(partial.c_str(),
+                                 std::ios::binary | std::ios::trunc);
+            output.write(w.buffer().data(), w.buffer().size());
+            output.close();
+            if (!output) {
+                std::cout << "Failed to write " << partial << std::endl;
+                std::remove(partial.c_str());
+                return false;
+            }
+        }
+        if (std::rename(partial.c_str(), filename.c_str()) != 0) {
+            std::cout << "Failed to replace " << filename << ": "
+                      << std::strerror(errno) << std::endl;
+            std::remove(partial.c_str());
+            return false;
+        }
+        return true;
+    }
+
+}
+
+bool loadCheckpoint(const std::string &inputs, CurveCheckpoint &checkpoint) {
+    std::string state;
+    if (!readCheckpoint(inputs, CurveCheckpointKind, state))
+        return false;
+    try {
+        Reader r(state);
+        CurveCheckpoint c;
+        c.quotes.ois = r.f64s();
+        c.quotes.deposits = r.f64s();
+        c.quotes.futures = r.f64s();
+        c.quotes.swaps = r.f64s();
+        c.discount = r.nodes();
+        c.forecast = r.nodes();
+        r.finish();
+        checkpoint = c;
+    } catch (std::exception &e) {
+        std::cout << "Curve checkpoint ignored: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool loadCheckpoint(const std::string &inputs, CalibrationState &checkpoint) {
+    std::string state;
+    if (!readCheckpoint(inputs, ModelCheckpointKind, state))
+        return false;
+    try {
+        Reader r(state);
+        CalibrationState c;
+        std::vector<Real> params = r.f64s();
+        c.params = Array(params.begin(), params.end());
+        c.expiries = r.dates();
+        c.ends = r.dates();
+        c.vols = r.f64s();
+        r.finish();
+        QL_REQUIRE(c.ends.size() == c.expiries.size() &&
+                   c.vols.size() == c.expiries.size(),
+                   "malformed basket");
+        checkpoint = c;
+    } catch (std::exception &e) {
+        std::cout << "Model checkpoint ignored: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool saveCheckpoint(const std::string &inputs,
+                    const CurveCheckpoint &checkpoint) {
+    if (dayCounterCode(checkpoint.discount.dayCounter) == 0 ||
+        dayCounterCode(checkpoint.forecast.dayCounter) == 0) {
+        std::cout << "Curves on an unknown day counter, not checkpointed"
+                  << std::endl;
+        return false;
+    }
+    Writer w;
+    w.f64s(checkpoint.quotes.ois);
+    w.f64s(checkpoint.quotes.deposits);
+    w.f64s(checkpoint.quotes.futures);
+    w.f64s(checkpoint.quotes.swaps);
+    w.nodes(checkpoint.discount);
+    w.nodes(checkpoint.forecast);
+    return writeCheckpoint(inputs, CurveCheckpointKind, w.buffer());
+}
+
+bool saveCheckpoint(const std::string &inputs,
+                    const CalibrationState &checkpoint) {
+    Writer w;
+    w.f64s(std::vector<Real>(checkpoint.params.begin(),
+                             checkpoint.params.end()));
+    w.dates(checkpoint.expiries);
+    w.dates(checkpoint.ends);
+    w.f64s(checkpoint.vols);
+    return writeCheckpoint(inputs, ModelCheckpointKind, w.buffer());
+}
@@ -0,0 +1,41 @@
+/*
+ * Versioned binary checkpoints of bootstrapped curves and calibrated
+ * models, for restarting without redoing either.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "model/bermudanSwaption.h"
+#include "model/curveNodes.h"
+#include "model/scenarioBook.h"
+
+#include <string>
+
+using namespace QuantLib;
+
+// the rate quotes and the curves bootstrapped on them
+struct CurveCheckpoint {
+    QuoteValues quotes;
+    CurveNodes discount, forecast;
+};
+
+/*
+ * One file per set of inputs in CHECKPOINT_DIR, named by a hash of the
+ * inputs text: a magic, CHECKPOINT_VERSION, the kind of state, the full
+ * inputs text, then the state.  A checkpoint is only restored if it
+ * has the current version and exactly the inputs asked for; anything
+ * else, including a truncated file, is reported and ignored.  Files are
+ * written aside and renamed over the previous checkpoint, so a crash
+ * while saving leaves the previous one.
+ */
+bool loadCheckpoint(const std::string &inputs, CurveCheckpoint &checkpoint);
+bool loadCheckpoint(const std::string &inputs, CalibrationState &checkpoint);
+
+// false, with a message, if the checkpoint could not be written
+bool saveCheckpoint(const std::string &inputs,
+                    const CurveCheckpoint &checkpoint);
+bool saveCheckpoint(const std::string &inputs,
+                    const CalibrationState &checkpoint);
+
+#endif
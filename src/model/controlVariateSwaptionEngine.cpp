@@ -0,0 +1,104 @@
+/*
+ * Bermudan swaption engine corrected by a European control variate.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/settings.hpp>
+
+#include "model/controlVariateSwaptionEngine.h"
+
+namespace {
+
+    Real swaptionValue(const ext::shared_ptr<PricingEngine> &engine,
+                       const Swaption::arguments &arguments) {
+        Swaption::arguments *target =
+                dynamic_cast<Swaption::arguments *>(engine->getArguments());
+        QL_REQUIRE(target, "wrapped engine does not price swaptions");
+        *target = arguments;
+        engine->reset();
+        engine->calculate();
+        const Swaption::results *results =
+                dynamic_cast<const Swaption::results *>(engine->getResults());
+        QL_REQUIRE(results && results->value != Null<Real>(),
+                   "wrapped engine returned no value");
+        return results->value;
+    }
+
+    // the European exercising at the given date into the remaining swap
+    Swaption::arguments coterminal(const Swaption::arguments &bermudan,
+                                   const Date &exerciseDate) {
+        Swaption::arguments european = bermudan;
+        european.exercise = ext::make_shared<EuropeanExercise>(exerciseDate);
+
+        european.fixedResetDates.clear();
+        european.fixedPayDates.clear();
+        european.fixedCoupons.clear();
+        for (Size i = 0; i < bermudan.fixedResetDates.size(); i++) {
+            if (bermudan.fixedResetDates[i] < exerciseDate)
+                continue;
+            european.fixedResetDates.push_back(bermudan.fixedResetDates[i]);
+            european.fixedPayDates.push_back(bermudan.fixedPayDates[i]);
+            european.fixedCoupons.push_back(bermudan.fixedCoupons[i]);
+        }
+
+        european.floatingAccrualTimes.clear();
+        european.floatingResetDates.clear();
+        european.floatingFixingDates.clear();
+        european.floatingPayDates.clear();
+        european.floatingSpreads.clear();
+        european.floatingCoupons.clear();
+        for (Size i = 0; i < bermudan.floatingResetDates.size(); i++) {
+            if (bermudan.floatingResetDates[i] < exerciseDate)
+                continue;
+            european.floatingAccrualTimes.push_back(
+                        bermudan.floatingAccrualTimes[i]);
+            european.floatingResetDates.push_back(
+                        bermudan.floatingResetDates[i]);
+            european.floatingFixingDates.push_back(
+                        bermudan.floatingFixingDates[i]);
+            european.floatingPayDates.push_back(bermudan.floatingPayDates[i]);
+            european.floatingSpreads.push_back(bermudan.floatingSpreads[i]);
+            european.floatingCoupons.push_back(bermudan.floatingCoupons[i]);
+        }
+        return european;
+    }
+
+}
+
+ControlVariateSwaptionEngine::ControlVariateSwaptionEngine(
+            const ext::shared_ptr<GridSwaptionEngine> &latticeEngine,
+            const ext::shared_ptr<PricingEngine> &analyticEngine)
+    : latticeEngine_(latticeEngine), analyticEngine_(analyticEngine) {}
+
+void ControlVariateSwaptionEngine::calculate() const {
+    Real bermudan = latticeEngine_->gridValue(arguments_, arguments_);
+
+    // the most expensive co-terminal European is the best proxy
+    Date today = Settings::instance().evaluationDate();
+    const std::vector<Date> &dates = arguments_.exercise->dates();
+    Swaption::arguments control;
+    Real analytic = Null<Real>();
+    for (Size i = 0; i < dates.size(); i++) {
+        if (dates[i] <= today)
+            continue;
+        Swaption::arguments european = coterminal(arguments_, dates[i]);
+        if (european.fixedPayDates.empty() ||
+            european.floatingResetDates.empty())
+            continue;
+        Real value = swaptionValue(analyticEngine_, european);
+        if (analytic == Null<Real>() || value > analytic) {
+            analytic = value;
+            control = european;
+        }
+    }
+    if (analytic == Null<Real>()) {
+        results_.value = bermudan;
+        return;
+    }
+
+    // on the Bermudan's grid, so that the grid errors cancel
+    Real correction =
+            analytic - latticeEngine_->gridValue(control, arguments_);
+    results_.value = bermudan + correction;
+    results_.additionalResults["controlVariateCorrection"] = correction;
+}
@@ -0,0 +1,132 @@
+/*
+ * Curve builder: dependency-aware, concurrent curve bootstrap.
+ */
+
+#include <ql/errors.hpp>
+
+#include "model/curveBuilder.h"
+#include "model/evaluationContext.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+CurveBuilder::CurveBuilder(Size maxThreads) : maxThreads_(maxThreads) {
+    if (maxThreads_ == 0)
+        maxThreads_ = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void CurveBuilder::addCurve(const std::string &name,
+            const std::vector<std::string> &dependencies,
+            const Constructor &constructor,
+            const std::vector<RelinkableHandle<YieldTermStructure> > &handles) {
+    QL_REQUIRE(nodes_.find(name) == nodes_.end(),
+               "curve " << name << " already defined");
+    CurveNode node;
+    node.dependencies = dependencies;
+    node.constructor = constructor;
+    node.handles = handles;
+    nodes_[name] = node;
+}
+
+void CurveBuilder::require(const std::string &name) {
+    required_.push_back(name);
+}
+
+void CurveBuilder::collect(const std::string &name,
+            std::set<std::string> &needed,
+            std::set<std::string> &visiting) const {
+    if (needed.count(name))
+        return;
+    QL_REQUIRE(nodes_.find(name) != nodes_.end(),
+               "curve " << name << " not defined");
+    QL_REQUIRE(!visiting.count(name),
+               "circular curve dependency through " << name);
+    visiting.insert(name);
+    const CurveNode &node = nodes_.find(name)->second;
+    for (Size i = 0; i < node.dependencies.size(); i++)
+        collect(node.dependencies[i], needed, visiting);
+    visiting.erase(name);
+    needed.insert(name);
+}
+
+void CurveBuilder::bootstrap(
+            const std::vector<ext::shared_ptr<YieldTermStructure> > &curves,
+            bool concurrent) const {
+    // maxDate() triggers the lazy bootstrap without notifying observers
+    Size nThreads = concurrent ? std::min(maxThreads_, curves.size()) : 1;
+    if (nThreads <= 1) {
+        for (Size i = 0; i < curves.size(); i++)
+            curves[i]->maxDate();
+        return;
+    }
+
+    std::atomic<Size> next(0);
+    std::vector<std::exception_ptr> errors(curves.size());
+    // the workers bootstrap in the caller's evaluation context
+    Integer session = EvaluationContext::current();
+    std::vector<std::thread> workers;
+    for (Size t = 0; t < nThreads; t++) {
+        workers.push_back(std::thread([&]() {
+            EvaluationContext context(session);
+            for (Size i = next++; i < curves.size(); i = next++) {
+                try {
+                    curves[i]->maxDate();
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        }));
+    }
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (Size i = 0; i < errors.size(); i++)
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+}
+
+std::map<std::string, ext::shared_ptr<YieldTermStructure> > CurveBuilder::build() {
+    std::set<std::string> needed, visiting;
+    for (Size i = 0; i < required_.size(); i++)
+        collect(required_[i], needed, visiting);
+
+    std::map<std::string, ext::shared_ptr<YieldTermStructure> > curves;
+    while (curves.size() < needed.size()) {
+        // next level: every curve whose dependencies are all built
+        std::vector<std::string> level;
+        for (std::set<std::string>::const_iterator it = needed.begin();
+             it != needed.end(); ++it) {
+            if (curves.count(*it))
+                continue;
+            const CurveNode &node = nodes_[*it];
+            bool ready = true;
+            for (Size j = 0; j < node.dependencies.size(); j++)
+                ready = ready && curves.count(node.dependencies[j]);
+            if (ready)
+                level.push_back(*it);
+        }
+
+        // helpers of curves sharing a parent register with the same
+        // handle while bootstrapping
+        std::set<std::string> parents;
+        bool concurrent = true;
+        std::vector<ext::shared_ptr<YieldTermStructure> > built;
+        for (Size i = 0; i < level.size(); i++) {
+            CurveNode &node = nodes_[level[i]];
+            for (Size j = 0; j < node.dependencies.size(); j++)
+                if (!parents.insert(node.dependencies[j]).second)
+                    concurrent = false;
+            ext::shared_ptr<YieldTermStructure> curve = node.constructor();
+            for (Size j = 0; j < node.handles.size(); j++)
+                node.handles[j].linkTo(curve);
+            curves[level[i]] = curve;
+            built.push_back(curve);
+            std::cout << "Bootstrap curve " << level[i] << std::endl;
+        }
+        bootstrap(built, concurrent);
+    }
+
+    return curves;
+}
@@ -0,0 +1,68 @@
+/*
+ * Curve builder: dependency-aware, concurrent curve bootstrap.
+ */
+
+#ifndef CURVE_BUILDER_H
+#define CURVE_BUILDER_H
+
+#include <ql/handle.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace QuantLib;
+
+/*
+ * Each curve is registered with the curves it depends on (e.g. a forecast
+ * curve discounting its swap helpers on the OIS curve), a constructor and
+ * the handles it has to be linked to. build() only constructs the curves
+ * reachable from the required ones and bootstraps them level by level:
+ * curves in the same level do not depend on each other and are
+ * bootstrapped concurrently.
+ *
+ * Construction and handle linking touch the observer graph and always run
+ * on the calling thread; only the bootstrap itself runs on workers.
+ * QuantLib's observer registration is not thread-safe, so a level whose
+ * curves share a dependency (e.g. several forecast curves discounting on
+ * the same OIS handle) is bootstrapped serially; otherwise curves in a
+ * level must not share rate helpers, quotes or indexes.  A dependency is
+ * always complete before its dependants start.
+ */
+class CurveBuilder {
+public:
+    typedef std::function<ext::shared_ptr<YieldTermStructure>()> Constructor;
+
+    explicit CurveBuilder(Size maxThreads = 0);
+
+    void addCurve(const std::string &name,
+                  const std::vector<std::string> &dependencies,
+                  const Constructor &constructor,
+                  const std::vector<RelinkableHandle<YieldTermStructure> >
+                        &handles = std::vector<RelinkableHandle<YieldTermStructure> >());
+    void require(const std::string &name);
+
+    // construct, link and bootstrap the required curves
+    std::map<std::string, ext::shared_ptr<YieldTermStructure> > build();
+
+private:
+    struct CurveNode {
+        std::vector<std::string> dependencies;
+        Constructor constructor;
+        std::vector<RelinkableHandle<YieldTermStructure> > handles;
+    };
+
+    void collect(const std::string &name, std::set<std::string> &needed,
+                 std::set<std::string> &visiting) const;
+    void bootstrap(const std::vector<ext::shared_ptr<YieldTermStructure> >
+                        &curves, bool concurrent) const;
+
+    Size maxThreads_;
+    std::map<std::string, CurveNode> nodes_;
+    std::vector<std::string> required_;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Bootstrapped curves as their nodes, for storing and rebuilding them.
+ */
+
+#include <ql/math/interpolations/linearinterpolation.hpp>
+#include <ql/termstructures/yield/zerocurve.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <ql/time/daycounters/thirty360.hpp>
+
+#include "model/curveNodes.h"
+
+bool curveNodes(const ext::shared_ptr<YieldTermStructure> &curve,
+                CurveNodes &nodes) {
+    ext::shared_ptr<InterpolatedZeroCurve<Linear> > zero =
+            ext::dynamic_pointer_cast<InterpolatedZeroCurve<Linear> >(curve);
+    if (!zero || dayCounterCode(zero->dayCounter()) == 0)
+        return false;
+
+    // bootstraps a piecewise curve before its nodes are read
+    zero->discount(0.0);
+    nodes.dayCounter = zero->dayCounter();
+    nodes.dates = zero->dates();
+    nodes.zeroRates = zero->zeroRates();
+    return true;
+}
+
+ext::shared_ptr<YieldTermStructure> nodesCurve(const CurveNodes &nodes) {
+    ext::shared_ptr<YieldTermStructure> curve(
+            new InterpolatedZeroCurve<Linear>(nodes.dates, nodes.zeroRates,
+                                              nodes.dayCounter));
+    curve->enableExtrapolation();
+    return curve;
+}
+
+int dayCounterCode(const DayCounter &dayCounter) {
+    if (dayCounter == Actual360())
+        return 1;
+    if (dayCounter == Actual365Fixed())
+        return 2;
+    if (dayCounter == Thirty360())
+        return 3;
+    return 0;
+}
+
+DayCounter codeDayCounter(int code) {
+    switch (code) {
+      case 1: return Actual360();
+      case 2: return Actual365Fixed();
+      case 3: return Thirty360();
+      default: QL_FAIL("unknown day counter code " << code);
+    }
+}
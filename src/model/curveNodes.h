@@ -0,0 +1,34 @@
+/*
+ * Bootstrapped curves as their nodes, for storing and rebuilding them.
+ */
+
+#ifndef CURVE_NODES_H
+#define CURVE_NODES_H
+
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <vector>
+
+using namespace QuantLib;
+
+// nodes of a linearly interpolated zero curve
+struct CurveNodes {
+    DayCounter dayCounter;
+    std::vector<Date> dates;
+    // continuously compounded
+    std::vector<Rate> zeroRates;
+};
+
+// false for curves that are not linear zero curves, such as the
+// bootstrapped ZeroYield curves, or not on a day counter with a code
+bool curveNodes(const ext::shared_ptr<YieldTermStructure> &curve,
+                CurveNodes &nodes);
+
+// an InterpolatedZeroCurve<Linear> on the nodes, extrapolating
+ext::shared_ptr<YieldTermStructure> nodesCurve(const CurveNodes &nodes);
+
+// the day counters the curves are built on as stored, 0 for others
+int dayCounterCode(const DayCounter &dayCounter);
+DayCounter codeDayCounter(int code);
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Per-thread QuantLib evaluation contexts.
+ */
+
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/math/randomnumbers/seedgenerator.hpp>
+#include <ql/patterns/observable.hpp>
+#include <ql/settings.hpp>
+
+#include "model/evaluationContext.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    thread_local Integer currentSession = 0;
+
+    std::mutex poolMutex;
+    std::vector<Integer> freeSessions;
+    Integer lastSession = 0;
+
+    // first access creates the singletons of the current session
+    void touchSingletons() {
+        Settings::instance();
+        ObservableSettings::instance();
+        IndexManager::instance();
+        SeedGenerator::instance();
+    }
+
+    Integer newSession() {
+        Integer session = ++lastSession;
+        Integer previous = currentSession;
+        currentSession = session;
+        touchSingletons();
+        currentSession = previous;
+        return session;
+    }
+
+}
+
+#if defined(QL_ENABLE_SESSIONS)
+namespace QuantLib {
+    Integer sessionId() { return currentSession; }
+}
+#endif
+
+EvaluationContext::EvaluationContext()
+: previous_(currentSession), owned_(true) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (freeSessions.empty()) {
+        currentSession = newSession();
+    } else {
+        currentSession = freeSessions.back();
+        freeSessions.pop_back();
+    }
+}
+
+EvaluationContext::EvaluationContext(Integer session)
+: previous_(currentSession), owned_(false) {
+    currentSession = session;
+}
+
+EvaluationContext::~EvaluationContext() {
+    if (owned_) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        freeSessions.push_back(currentSession);
+    }
+    currentSession = previous_;
+}
+
+Integer EvaluationContext::current() {
+    return currentSession;
+}
+
+bool EvaluationContext::isolated() {
+    #if defined(QL_ENABLE_SESSIONS)
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+void EvaluationContext::prepare(Size n) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    while (freeSessions.size() < n)
+        freeSessions.insert(freeSessions.begin(), newSession());
+}
+
+Size EvaluationContext::threads(Size maxThreads) {
+    if (!isolated())
+        return 1;
+    if (maxThreads == 0)
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    return maxThreads;
+}
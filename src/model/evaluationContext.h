@@ -0,0 +1,54 @@
+/*
+ * Per-thread QuantLib evaluation contexts.
+ */
+
+#ifndef EVALUATION_CONTEXT_H
+#define EVALUATION_CONTEXT_H
+
+#include <ql/types.hpp>
+
+using namespace QuantLib;
+
+/*
+ * QuantLib keeps the evaluation date, index fixings and observer
+ * settings in singletons.  Built with QL_ENABLE_SESSIONS (the QuantLib
+ * library as well), there is one set of singletons per sessionId(), and
+ * here a session is bound to a thread by an EvaluationContext; threads
+ * outside any context share session 0.  Objects built inside a context
+ * must not be shared with other contexts.
+ *
+ * Sessions are recycled and keep the settings of their last user, so a
+ * context sets its evaluation date before building anything.  The
+ * singleton table itself is not thread-safe: prepare() creates the
+ * sessions of a parallel run up front, before the workers start.
+ *
+ * Without sessions there is one process-wide context, and parallel runs
+ * fall back to a single worker.
+ */
+class EvaluationContext {
+public:
+    // binds the calling thread to a session of its own for the scope
+    EvaluationContext();
+    // binds the calling thread to the given session, e.g. a helper
+    // thread working for the thread owning it
+    explicit EvaluationContext(Integer session);
+    ~EvaluationContext();
+
+    static Integer current();
+    static bool isolated();
+    // creates sessions for n concurrent contexts; call with no worker
+    // running
+    static void prepare(Size n);
+    // workers a parallel run may use: maxThreads (0 for the hardware
+    // concurrency) with isolated contexts, one otherwise
+    static Size threads(Size maxThreads);
+
+private:
+    EvaluationContext(const EvaluationContext &);
+    EvaluationContext &operator=(const EvaluationContext &);
+
+    Integer previous_;
+    bool owned_;
+};
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * OIS rate helper with a fast par-rate evaluation.
+ */
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/settings.hpp>
+
+#include "model/fastOisRateHelper.h"
+
+FastOISRateHelper::FastOISRateHelper(Natural settlementDays,
+            const Period &tenor,
+            const Handle<Quote> &fixedRate,
+            const ext::shared_ptr<OvernightIndex> &overnightIndex,
+            const Handle<YieldTermStructure> &discountingCurve,
+            bool telescopicValueDates,
+            Natural paymentLag,
+            BusinessDayConvention paymentConvention,
+            Frequency paymentFrequency,
+            const Calendar &paymentCalendar,
+            const Period &forwardStart,
+            const Spread overnightSpread)
+    : OISRateHelper(settlementDays, tenor, fixedRate, overnightIndex,
+                    discountingCurve, telescopicValueDates, paymentLag,
+                    paymentConvention, paymentFrequency, paymentCalendar,
+                    forwardStart, overnightSpread) {
+    // the base constructor only ran its own initializeDates()
+    cacheSchedule();
+}
+
+void FastOISRateHelper::initializeDates() {
+    OISRateHelper::initializeDates();
+    cacheSchedule();
+}
+
+void FastOISRateHelper::cacheSchedule() {
+    overnightCoupons_.clear();
+    const Leg &overnightLeg = swap_->overnightLeg();
+    for (Size i = 0; i < overnightLeg.size(); i++) {
+        ext::shared_ptr<OvernightIndexedCoupon> coupon =
+                ext::dynamic_pointer_cast<OvernightIndexedCoupon>(
+                        overnightLeg[i]);
+        QL_REQUIRE(coupon, "overnight leg holds a non-overnight coupon");
+        overnightCoupons_.push_back(coupon);
+    }
+
+    fixedPaymentDates_.clear();
+    fixedAccruals_.clear();
+    const Leg &fixedLeg = swap_->fixedLeg();
+    for (Size i = 0; i < fixedLeg.size(); i++) {
+        ext::shared_ptr<Coupon> coupon =
+                ext::dynamic_pointer_cast<Coupon>(fixedLeg[i]);
+        fixedPaymentDates_.push_back(coupon->date());
+        fixedAccruals_.push_back(coupon->nominal() * coupon->accrualPeriod());
+    }
+}
+
+Real FastOISRateHelper::compoundFactor(const OvernightIndexedCoupon &coupon,
+            const YieldTermStructure &forecast, const Date &today) const {
+    const std::vector<Date> &fixingDates = coupon.fixingDates();
+    const std::vector<Date> &valueDates = coupon.valueDates();
+    const std::vector<Time> &dt = coupon.dt();
+    Size n = dt.size(), i = 0;
+    Real compound = 1.0;
+
+    // already fixed part, compounded day by day
+    while (i < n && fixingDates[i] < today) {
+        Rate pastFixing = overnightIndex_->pastFixing(fixingDates[i]);
+        QL_REQUIRE(pastFixing != Null<Real>(),
+                   "Missing " << overnightIndex_->name() <<
+                   " fixing for " << fixingDates[i]);
+        compound *= 1.0 + pastFixing * dt[i];
+        ++i;
+    }
+    // today's fixing is used only if already published
+    if (i < n && fixingDates[i] == today) {
+        Rate pastFixing = overnightIndex_->pastFixing(fixingDates[i]);
+        if (pastFixing != Null<Real>()) {
+            compound *= 1.0 + pastFixing * dt[i];
+            ++i;
+        }
+    }
+    // projected part telescopes
+    if (i < n)
+        compound *= forecast.discount(valueDates[i]) /
+                    forecast.discount(valueDates[n]);
+
+    return compound;
+}
+
+Real FastOISRateHelper::impliedQuote() const {
+    QL_REQUIRE(termStructure_ != 0, "term structure not set");
+    const YieldTermStructure &forecast = *termStructure_;
+    const YieldTermStructure &discount = discountHandle_.empty() ?
+            *termStructure_ : *discountHandle_.currentLink();
+    Date today = Settings::instance().evaluationDate();
+    Date referenceDate = discount.referenceDate();
+
+    // amount = N * accrual * (gearing * rate + spread)
+    // with rate = (compound - 1) / accrual
+    Real overnightNPV = 0.0;
+    for (Size i = 0; i < overnightCoupons_.size(); i++) {
+        const OvernightIndexedCoupon &coupon = *overnightCoupons_[i];
+        if (coupon.hasOccurred(referenceDate))
+            continue;
+        Real amount = coupon.nominal() *
+            (coupon.gearing() * (compoundFactor(coupon, forecast, today) - 1.0)
+             + coupon.accrualPeriod() * coupon.spread());
+        overnightNPV += amount * discount.discount(coupon.date());
+    }
+
+    Real annuity = 0.0;
+    for (Size i = 0; i < fixedPaymentDates_.size(); i++) {
+        if (fixedPaymentDates_[i] <= referenceDate)
+            continue;
+        annuity += fixedAccruals_[i] * discount.discount(fixedPaymentDates_[i]);
+    }
+
+    return overnightNPV / annuity;
+}
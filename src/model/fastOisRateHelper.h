@@ -0,0 +1,55 @@
+/*
+ * OIS rate helper with a fast par-rate evaluation.
+ */
+
+#ifndef FAST_OIS_RATE_HELPER_H
+#define FAST_OIS_RATE_HELPER_H
+
+#include <ql/cashflows/overnightindexedcoupon.hpp>
+#include <ql/termstructures/yield/oisratehelper.hpp>
+
+#include <vector>
+
+using namespace QuantLib;
+
+/*
+ * Same instrument and quote as OISRateHelper, but impliedQuote() skips the
+ * swap / engine / coupon pricer round trip. The schedule is cached when the
+ * dates are initialized; each compounded coupon that is fully projected is
+ * evaluated telescopically as P(first value date) / P(last value date), and
+ * daily compounding with index fixings is only used for the part of a
+ * coupon that has already fixed.
+ */
+class FastOISRateHelper : public OISRateHelper {
+public:
+    FastOISRateHelper(Natural settlementDays,
+                      const Period &tenor,
+                      const Handle<Quote> &fixedRate,
+                      const ext::shared_ptr<OvernightIndex> &overnightIndex,
+                      const Handle<YieldTermStructure> &discountingCurve
+                                            = Handle<YieldTermStructure>(),
+                      bool telescopicValueDates = false,
+                      Natural paymentLag = 0,
+                      BusinessDayConvention paymentConvention = Following,
+                      Frequency paymentFrequency = Annual,
+                      const Calendar &paymentCalendar = Calendar(),
+                      const Period &forwardStart = 0 * Days,
+                      const Spread overnightSpread = 0.0);
+
+    Real impliedQuote() const;
+
+protected:
+    void initializeDates();
+
+private:
+    void cacheSchedule();
+    Real compoundFactor(const OvernightIndexedCoupon &coupon,
+                        const YieldTermStructure &forecast,
+                        const Date &today) const;
+
+    std::vector<ext::shared_ptr<OvernightIndexedCoupon> > overnightCoupons_;
+    std::vector<Date> fixedPaymentDates_;
+    std::vector<Real> fixedAccruals_;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Finite-difference G2 swaption engine that can price on another
+ * swaption's grid.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/methods/finitedifferences/meshers/fdmmeshercomposite.hpp>
+#include <ql/methods/finitedifferences/meshers/fdmsimpleprocess1dmesher.hpp>
+#include <ql/methods/finitedifferences/solvers/fdmg2solver.hpp>
+#include <ql/methods/finitedifferences/utilities/fdmaffinemodelswapinnervalue.hpp>
+#include <ql/processes/ornsteinuhlenbeckprocess.hpp>
+
+#include "model/fdG2GridSwaptionEngine.h"
+
+FdG2GridSwaptionEngine::FdG2GridSwaptionEngine(
+            const ext::shared_ptr<G2> &model, Size tGrid, Size xGrid,
+            Size yGrid, Size dampingSteps, Real invEps,
+            const FdmSchemeDesc &schemeDesc)
+    : GenericModelEngine<G2, Swaption::arguments, Swaption::results>(model),
+      tGrid_(tGrid), xGrid_(xGrid), yGrid_(yGrid),
+      dampingSteps_(dampingSteps), invEps_(invEps),
+      schemeDesc_(schemeDesc) {}
+
+void FdG2GridSwaptionEngine::calculate() const {
+    results_.value = gridValue(arguments_, arguments_);
+}
+
+Real FdG2GridSwaptionEngine::gridValue(const Swaption::arguments &swaption,
+                                       const Swaption::arguments &grid) const {
+    const Handle<YieldTermStructure> ts = model_->termStructure();
+    const DayCounter dc = ts->dayCounter();
+    const Date referenceDate = ts->referenceDate();
+
+    // mesh and time grid are laid out for the grid's exercise schedule
+    const std::map<Time, Date> t2d =
+            exerciseTimes(*grid.exercise, referenceDate, dc);
+    const std::map<Time, Date> exercise =
+            exerciseTimes(*swaption.exercise, referenceDate, dc);
+    const Time maturity = t2d.rbegin()->first;
+
+    const ext::shared_ptr<OrnsteinUhlenbeckProcess> process1(
+            new OrnsteinUhlenbeckProcess(model_->a(), model_->sigma()));
+    const ext::shared_ptr<OrnsteinUhlenbeckProcess> process2(
+            new OrnsteinUhlenbeckProcess(model_->b(), model_->eta()));
+    const ext::shared_ptr<FdmMesher> mesher(new FdmMesherComposite(
+            ext::make_shared<FdmSimpleProcess1dMesher>(
+                    xGrid_, process1, maturity, 1, invEps_),
+            ext::make_shared<FdmSimpleProcess1dMesher>(
+                    yGrid_, process2, maturity, 1, invEps_)));
+
+    Handle<YieldTermStructure> fwdTs =
+            swaption.swap->iborIndex()->forwardingTermStructure();
+    QL_REQUIRE(fwdTs->dayCounter() == ts->dayCounter(),
+               "day counter of forward and discount curve must match");
+    QL_REQUIRE(fwdTs->referenceDate() == ts->referenceDate(),
+               "reference date of forward and discount curve must match");
+    const ext::shared_ptr<G2> fwdModel(fwdTs == ts ? model_.currentLink() :
+            ext::make_shared<G2>(fwdTs, model_->a(), model_->sigma(),
+                                 model_->b(), model_->eta(), model_->rho()));
+    const ext::shared_ptr<FdmInnerValueCalculator> calculator(
+            new ExerciseInnerValue(
+                    ext::make_shared<FdmAffineModelSwapInnerValue<G2> >(
+                            model_.currentLink(), fwdModel, swaption.swap,
+                            exercise, mesher, 0),
+                    exercise));
+
+    const ext::shared_ptr<FdmStepConditionComposite> conditions =
+            gridStepConditions(exercise, t2d, std::vector<Time>(),
+                               referenceDate, dc, mesher, calculator);
+
+    const FdmBoundaryConditionSet boundaryConditions;
+    FdmSolverDesc solverDesc = { mesher, boundaryConditions, conditions,
+                                 calculator, maturity, tGrid_,
+                                 dampingSteps_ };
+    const ext::shared_ptr<FdmG2Solver> solver(
+            new FdmG2Solver(model_, solverDesc, schemeDesc_));
+
+    return solver->valueAt(0.0, 0.0);
+}
@@ -0,0 +1,42 @@
+/*
+ * Finite-difference G2 swaption engine that can price on another
+ * swaption's grid.
+ */
+
+#ifndef FD_G2_GRID_SWAPTION_ENGINE_H
+#define FD_G2_GRID_SWAPTION_ENGINE_H
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/methods/finitedifferences/solvers/fdmbackwardsolver.hpp>
+#include <ql/models/shortrate/twofactormodels/g2.hpp>
+#include <ql/pricingengines/genericmodelengine.hpp>
+
+#include "model/gridSwaptionEngine.h"
+
+using namespace QuantLib;
+
+/*
+ * FdG2SwaptionEngine, with the mesh, time grid and stopping times taken
+ * from the swaption given as grid in gridValue(); calculate() prices on
+ * the swaption's own grid, as FdG2SwaptionEngine does.
+ */
+class FdG2GridSwaptionEngine
+    : public GenericModelEngine<G2, Swaption::arguments, Swaption::results>,
+      public GridSwaptionEngine {
+public:
+    FdG2GridSwaptionEngine(
+            const ext::shared_ptr<G2> &model,
+            Size tGrid = 100, Size xGrid = 50, Size yGrid = 50,
+            Size dampingSteps = 0, Real invEps = 1e-5,
+            const FdmSchemeDesc &schemeDesc = FdmSchemeDesc::Hundsdorfer());
+    void calculate() const;
+    Real gridValue(const Swaption::arguments &swaption,
+                   const Swaption::arguments &grid) const;
+
+private:
+    const Size tGrid_, xGrid_, yGrid_, dampingSteps_;
+    const Real invEps_;
+    const FdmSchemeDesc schemeDesc_;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Finite-difference Hull-White swaption engine with an exercise-aware
+ * mesh.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/methods/finitedifferences/meshers/concentrating1dmesher.hpp>
+#include <ql/methods/finitedifferences/meshers/fdmmeshercomposite.hpp>
+#include <ql/methods/finitedifferences/solvers/fdmhullwhitesolver.hpp>
+#include <ql/methods/finitedifferences/stepconditions/fdmstepconditioncomposite.hpp>
+#include <ql/methods/finitedifferences/utilities/fdmaffinemodelswapinnervalue.hpp>
+
+#include "model/fdHullWhiteExerciseEngine.h"
+#include "model/hullWhiteKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+FdHullWhiteExerciseSwaptionEngine::FdHullWhiteExerciseSwaptionEngine(
+            const ext::shared_ptr<HullWhite> &model, Size tGrid, Size xGrid,
+            Real invEps, const FdmSchemeDesc &schemeDesc)
+    : GenericModelEngine<HullWhite, Swaption::arguments,
+                         Swaption::results>(model),
+      tGrid_(tGrid), xGrid_(xGrid), invEps_(invEps),
+      schemeDesc_(schemeDesc) {}
+
+void FdHullWhiteExerciseSwaptionEngine::calculate() const {
+    results_.value = gridValue(arguments_, arguments_);
+}
+
+Real FdHullWhiteExerciseSwaptionEngine::gridValue(
+            const Swaption::arguments &swaption,
+            const Swaption::arguments &grid) const {
+    QL_REQUIRE(swaption.nominal != Null<Real>() &&
+               grid.nominal != Null<Real>(),
+               "non-constant nominals are not supported yet");
+
+    const Handle<YieldTermStructure> ts = model_->termStructure();
+    const DayCounter dc = ts->dayCounter();
+    const Date referenceDate = ts->referenceDate();
+    const Real a = model_->a(), sigma = model_->sigma();
+
+    // mesh and time grid are laid out for the grid's exercise schedule
+    const std::map<Time, Date> t2d =
+            exerciseTimes(*grid.exercise, referenceDate, dc);
+    const std::map<Time, Date> exercise =
+            exerciseTimes(*swaption.exercise, referenceDate, dc);
+    const Time maturity = t2d.rbegin()->first;
+
+    // mesh range as FdmSimpleProcess1dMesher: the OU state is widest at
+    // the last exercise
+    Real variance = (a < std::sqrt(QL_EPSILON) ? sigma * sigma * maturity :
+            0.5 * sigma * sigma * (1.0 - std::exp(-2.0 * a * maturity)) / a);
+    Real xMax = InverseCumulativeNormal()(1.0 - invEps_) *
+                std::sqrt(variance);
+    Real density = 0.05 * 2.0 * xMax;
+
+    // exercise boundary in the OU state x = r - alpha(t) per exercise date
+    std::vector<Real> boundaries;
+    for (std::map<Time, Date>::const_iterator it = t2d.begin();
+         it != t2d.end(); ++it) {
+        std::vector<Time> payTimes;
+        std::vector<Real> coupons;
+        for (Size i = 0; i < grid.fixedPayDates.size(); i++) {
+            if (grid.fixedResetDates[i] < it->second)
+                continue;
+            payTimes.push_back(
+                    dc.yearFraction(referenceDate, grid.fixedPayDates[i]));
+            coupons.push_back(grid.fixedCoupons[i] / grid.nominal);
+        }
+        if (payTimes.empty() || it->first <= 0.0)
+            continue;
+        coupons.back() += 1.0;
+
+        HullWhiteBondKernel kernel(ts, it->first, payTimes);
+        kernel.update(a, sigma);
+        Real temp = (a < std::sqrt(QL_EPSILON) ? sigma * it->first :
+                     sigma * (1.0 - std::exp(-a * it->first)) / a);
+        Rate alpha = ts->forwardRate(it->first, it->first, Continuous,
+                                     NoFrequency) + 0.5 * temp * temp;
+        Real x = kernel.criticalRate(coupons) - alpha;
+        if (std::fabs(x) < xMax)
+            boundaries.push_back(x);
+    }
+    std::sort(boundaries.begin(), boundaries.end());
+
+    // boundaries of neighbouring dates are usually close; keep the
+    // concentration points at least one density width apart
+    std::vector<Real> points(1, 0.0);
+    Real last = -QL_MAX_REAL;
+    for (Size i = 0; i < boundaries.size(); i++) {
+        if (std::fabs(boundaries[i]) > density &&
+            boundaries[i] - last > density) {
+            points.push_back(boundaries[i]);
+            last = boundaries[i];
+        }
+    }
+    std::sort(points.begin(), points.end());
+    std::vector<boost::tuple<Real, Real, bool> > cPoints;
+    for (Size i = 0; i < points.size(); i++)
+        cPoints.push_back(boost::make_tuple(points[i], density,
+                                            points[i] == 0.0));
+    const ext::shared_ptr<FdmMesher> mesher(new FdmMesherComposite(
+            ext::make_shared<Concentrating1dMesher>(-xMax, xMax, xGrid_,
+                                                    cPoints)));
+
+    const Handle<YieldTermStructure> fwdTs =
+            swaption.swap->iborIndex()->forwardingTermStructure();
+    QL_REQUIRE(fwdTs->dayCounter() == ts->dayCounter(),
+               "day counter of forward and discount curve must match");
+    QL_REQUIRE(fwdTs->referenceDate() == ts->referenceDate(),
+               "reference date of forward and discount curve must match");
+    const ext::shared_ptr<HullWhite> fwdModel(new HullWhite(fwdTs, a, sigma));
+    const ext::shared_ptr<FdmInnerValueCalculator> calculator(
+            new ExerciseInnerValue(
+                    ext::make_shared<FdmAffineModelSwapInnerValue<HullWhite> >(
+                            model_.currentLink(), fwdModel, swaption.swap,
+                            exercise, mesher, 0),
+                    exercise));
+
+    // time steps per exercise interval; the solver is run with a single
+    // step and splits it at every stopping time
+    std::vector<Time> gridTimes;
+    Time from = 0.0;
+    for (std::map<Time, Date>::const_iterator it = t2d.begin();
+         it != t2d.end(); ++it) {
+        Time to = it->first;
+        Size steps = std::max<Size>(1, Size(tGrid_ * (to - from) / maturity
+                                            + 0.5));
+        for (Size j = 1; j < steps; j++)
+            gridTimes.push_back(from + j * (to - from) / steps);
+        from = to;
+    }
+    const ext::shared_ptr<FdmStepConditionComposite> conditions =
+            gridStepConditions(exercise, t2d, gridTimes, referenceDate, dc,
+                               mesher, calculator);
+
+    const FdmBoundaryConditionSet boundaryConditions;
+    FdmSolverDesc solverDesc = { mesher, boundaryConditions, conditions,
+                                 calculator, maturity, 1, 0 };
+    const ext::shared_ptr<FdmHullWhiteSolver> solver(
+            new FdmHullWhiteSolver(model_, solverDesc, schemeDesc_));
+
+    return solver->valueAt(0.0);
+}
@@ -0,0 +1,49 @@
+/*
+ * Finite-difference Hull-White swaption engine with an exercise-aware
+ * mesh.
+ */
+
+#ifndef FD_HULL_WHITE_EXERCISE_ENGINE_H
+#define FD_HULL_WHITE_EXERCISE_ENGINE_H
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/methods/finitedifferences/solvers/fdmbackwardsolver.hpp>
+#include <ql/models/shortrate/onefactormodels/hullwhite.hpp>
+#include <ql/pricingengines/genericmodelengine.hpp>
+
+#include "model/gridSwaptionEngine.h"
+
+using namespace QuantLib;
+
+/*
+ * Same problem as FdHullWhiteSwaptionEngine, but
+ *   - the short-rate mesh is a Concentrating1dMesher clustered around
+ *     today's state and around the exercise boundary of every exercise
+ *     date, estimated by the Jamshidian critical rate of the swap left
+ *     at that date;
+ *   - the time steps are laid out per exercise interval, proportionally
+ *     to its length, so every exercise date is a grid point instead of
+ *     splitting a uniform step.
+ * The default 100 x 50 grid is held to half a basis point of a 1000 x
+ * 1000 uniform FdHullWhiteSwaptionEngine by test/hullWhiteExerciseGrid.
+ */
+class FdHullWhiteExerciseSwaptionEngine
+    : public GenericModelEngine<HullWhite, Swaption::arguments,
+                                Swaption::results>,
+      public GridSwaptionEngine {
+public:
+    FdHullWhiteExerciseSwaptionEngine(
+            const ext::shared_ptr<HullWhite> &model,
+            Size tGrid = 100, Size xGrid = 50, Real invEps = 1e-5,
+            const FdmSchemeDesc &schemeDesc = FdmSchemeDesc::Douglas());
+    void calculate() const;
+    Real gridValue(const Swaption::arguments &swaption,
+                   const Swaption::arguments &grid) const;
+
+private:
+    const Size tGrid_, xGrid_;
+    const Real invEps_;
+    const FdmSchemeDesc schemeDesc_;
+};
+
+#endif
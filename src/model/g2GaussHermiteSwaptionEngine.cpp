@@ -0,0 +1,187 @@
+/*
+ * G2++ European swaption engine on fixed Gauss-Hermite nodes.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/math/integrals/gaussianquadratures.hpp>
+#include <ql/math/solvers1d/brent.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+
+#include "model/g2GaussHermiteSwaptionEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+// G2::A() is protected; it carries the term-structure fitting.
+struct G2Affine : public G2 {
+    static Real of(const G2 &model, Time t, Time T) {
+        return (model.*(&G2Affine::A))(t, T);
+    }
+};
+
+// conditional swap value as a function of the second factor
+struct G2SolvingFunction {
+    G2SolvingFunction(const Real *lambda, Size stride,
+                      const std::vector<Real> &Bb)
+        : lambda_(lambda), stride_(stride), Bb_(Bb) {}
+    Real operator()(Real y) const {
+        Real value = 1.0;
+        for (Size i = 0; i < Bb_.size(); i++)
+            value -= lambda_[i * stride_] * std::exp(-Bb_[i] * y);
+        return value;
+    }
+    const Real *lambda_;
+    Size stride_;
+    const std::vector<Real> &Bb_;
+};
+
+G2GaussHermiteSwaptionEngine::G2GaussHermiteSwaptionEngine(
+            const ext::shared_ptr<G2> &model, Size integrationPoints)
+    : GenericModelEngine<G2, Swaption::arguments, Swaption::results>(model) {
+    GaussHermiteIntegration integration(integrationPoints);
+    nodes_ = integration.x();
+    // QuantLib divides the weights by exp(-x^2) so that they integrate
+    // f dx; the conditional values carry no density, so it goes back in
+    weights_ = integration.weights();
+    for (Size k = 0; k < weights_.size(); k++)
+        weights_[k] *= std::exp(-nodes_[k] * nodes_[k]);
+}
+
+void G2GaussHermiteSwaptionEngine::calculate() const {
+    QL_REQUIRE(arguments_.settlementType == Settlement::Physical,
+               "cash-settled swaptions not priced with G2 engine");
+    QL_REQUIRE(arguments_.exercise->type() == Exercise::European,
+               "G2 Gauss-Hermite engine only prices European swaptions");
+
+    // adjust the fixed rate for the floating spread, as G2SwaptionEngine
+    VanillaSwap swap = *arguments_.swap;
+    swap.setPricingEngine(ext::shared_ptr<PricingEngine>(
+              new DiscountingSwapEngine(model_->termStructure(), false)));
+    Spread correction = swap.spread() *
+        std::fabs(swap.floatingLegBPS() / swap.fixedLegBPS());
+    Rate fixedRate = swap.fixedRate() - correction;
+
+    results_.value = swaption(fixedRate);
+}
+
+Real G2GaussHermiteSwaptionEngine::swaption(Rate fixedRate) const {
+    const G2 &model = **model_;
+    Real a = model.a(), sigma = model.sigma();
+    Real b = model.b(), eta = model.eta(), rho = model.rho();
+
+    Date settlement = model.termStructure()->referenceDate();
+    DayCounter dayCounter = model.termStructure()->dayCounter();
+    Time T = dayCounter.yearFraction(settlement,
+                                     arguments_.floatingResetDates[0]);
+    Real w = (arguments_.type == VanillaSwap::Payer ? 1 : -1);
+
+    Size m = arguments_.fixedPayDates.size();
+    std::vector<Real> t(m), c(m), A(m), Ba(m), Bb(m);
+    for (Size i = 0; i < m; i++) {
+        t[i] = dayCounter.yearFraction(settlement, arguments_.fixedPayDates[i]);
+        Real tau = (i == 0 ? t[0] - T : t[i] - t[i - 1]);
+        c[i] = (i == m - 1 ? 1.0 + fixedRate * tau : fixedRate * tau);
+        A[i] = G2Affine::of(model, T, t[i]);
+        Ba[i] = (1.0 - std::exp(-a * (t[i] - T))) / a;
+        Bb[i] = (1.0 - std::exp(-b * (t[i] - T))) / b;
+    }
+
+    // factor moments under the T-forward measure
+    Real sigmax = sigma * std::sqrt(0.5 * (1.0 - std::exp(-2.0 * a * T)) / a);
+    Real sigmay = eta * std::sqrt(0.5 * (1.0 - std::exp(-2.0 * b * T)) / b);
+    Real rhoxy = rho * eta * sigma * (1.0 - std::exp(-(a + b) * T)) /
+                 ((a + b) * sigmax * sigmay);
+    Real temp = sigma * sigma / (a * a);
+    Real mux = -((temp + rho * sigma * eta / (a * b)) * (1.0 - std::exp(-a * T))
+                 - 0.5 * temp * (1.0 - std::exp(-2.0 * a * T))
+                 - rho * sigma * eta / (b * (a + b)) *
+                   (1.0 - std::exp(-(b + a) * T)));
+    temp = eta * eta / (b * b);
+    Real muy = -((temp + rho * sigma * eta / (a * b)) * (1.0 - std::exp(-b * T))
+                 - 0.5 * temp * (1.0 - std::exp(-2.0 * b * T))
+                 - rho * sigma * eta / (a * (a + b)) *
+                   (1.0 - std::exp(-(b + a) * T)));
+    Real txy = std::sqrt(1.0 - rhoxy * rhoxy);
+
+    // lambda[i][k] = c_i A_i exp(-Ba_i x_k), laid out by payment then node
+    Size n = nodes_.size();
+    x_.resize(n);
+    y_.assign(n, 0.0);
+    f_.resize(n);
+    df_.resize(n);
+    value_.resize(n);
+    lambda_.resize(m * n);
+    for (Size k = 0; k < n; k++)
+        x_[k] = mux + M_SQRT2 * sigmax * nodes_[k];
+    for (Size i = 0; i < m; i++) {
+        Real *lambda = &lambda_[i * n];
+        for (Size k = 0; k < n; k++)
+            lambda[k] = c[i] * A[i] * std::exp(-Ba[i] * x_[k]);
+    }
+
+    // Newton sweeps over all nodes for 1 - sum lambda exp(-Bb y) = 0
+    const Real accuracy = 1.0e-14;
+    const Size maxSweeps = 50;
+    std::vector<bool> converged(n, false);
+    for (Size sweep = 0; sweep < maxSweeps; sweep++) {
+        std::fill(f_.begin(), f_.end(), 1.0);
+        std::fill(df_.begin(), df_.end(), 0.0);
+        for (Size i = 0; i < m; i++) {
+            const Real *lambda = &lambda_[i * n];
+            for (Size k = 0; k < n; k++) {
+                Real e = lambda[k] * std::exp(-Bb[i] * y_[k]);
+                f_[k] -= e;
+                df_[k] += Bb[i] * e;
+            }
+        }
+        bool done = true;
+        for (Size k = 0; k < n; k++) {
+            Real step = f_[k] / df_[k];
+            converged[k] = std::fabs(step) <= accuracy * (1.0 + std::fabs(y_[k]));
+            if (std::isfinite(step) && std::fabs(step) < 100.0)
+                y_[k] -= step;
+            else
+                converged[k] = false;
+            done = done && converged[k];
+        }
+        if (done)
+            break;
+    }
+    for (Size k = 0; k < n; k++) {
+        if (converged[k])
+            continue;
+        // same search as G2::swaption() for the stragglers
+        Brent solver;
+        solver.setMaxEvaluations(1000);
+        y_[k] = solver.solve(G2SolvingFunction(&lambda_[k], n, Bb),
+                             1e-14, 0.0, -100.0, 100.0);
+    }
+
+    // conditional values; N(z) = erfc(-z / sqrt(2)) / 2
+    for (Size k = 0; k < n; k++) {
+        Real h1 = (y_[k] - muy) / (sigmay * txy) -
+                  rhoxy * (x_[k] - mux) / (sigmax * txy);
+        value_[k] = 0.5 * std::erfc(w * h1 * M_SQRT1_2);
+    }
+    for (Size i = 0; i < m; i++) {
+        const Real *lambda = &lambda_[i * n];
+        Real shift = Bb[i] * sigmay * txy;
+        Real kappa0 = -Bb[i] * (muy - 0.5 * txy * txy * sigmay * sigmay * Bb[i]);
+        Real kappa1 = -Bb[i] * rhoxy * sigmay / sigmax;
+        for (Size k = 0; k < n; k++) {
+            Real h1 = (y_[k] - muy) / (sigmay * txy) -
+                      rhoxy * (x_[k] - mux) / (sigmax * txy);
+            Real kappa = kappa0 + kappa1 * (x_[k] - mux);
+            value_[k] -= lambda[k] * std::exp(kappa) *
+                         0.5 * std::erfc(w * (h1 + shift) * M_SQRT1_2);
+        }
+    }
+
+    Real integral = 0.0;
+    for (Size k = 0; k < n; k++)
+        integral += weights_[k] * value_[k];
+    integral /= std::sqrt(M_PI);
+
+    return arguments_.nominal * w * model.termStructure()->discount(T) *
+           integral;
+}
@@ -0,0 +1,44 @@
+/*
+ * G2++ European swaption engine on fixed Gauss-Hermite nodes.
+ */
+
+#ifndef G2_GAUSS_HERMITE_SWAPTION_ENGINE_H
+#define G2_GAUSS_HERMITE_SWAPTION_ENGINE_H
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/math/array.hpp>
+#include <ql/models/shortrate/twofactormodels/g2.hpp>
+#include <ql/pricingengines/genericmodelengine.hpp>
+
+#include <vector>
+
+using namespace QuantLib;
+
+/*
+ * Same closed form as G2SwaptionEngine / G2::swaption(), i.e. the
+ * integral over the first factor of the conditional swaption value, but:
+ *   - the integral uses fixed Gauss-Hermite nodes instead of a segment
+ *     integral over +/- range standard deviations;
+ *   - the critical y of every node is found at once with Newton sweeps
+ *     over all nodes (the conditional swap value is monotone and concave
+ *     in y) instead of a Brent search per integration point, with a Brent
+ *     fallback for nodes that do not converge;
+ *   - the kernels work on flat arrays over the nodes so that the
+ *     exponentials and cumulative normals vectorize.
+ */
+class G2GaussHermiteSwaptionEngine
+    : public GenericModelEngine<G2, Swaption::arguments, Swaption::results> {
+public:
+    G2GaussHermiteSwaptionEngine(const ext::shared_ptr<G2> &model,
+                                 Size integrationPoints = 64);
+    void calculate() const;
+
+private:
+    Real swaption(Rate fixedRate) const;
+
+    Array nodes_, weights_;
+    // per-node workspaces
+    mutable std::vector<Real> x_, y_, f_, df_, value_, lambda_;
+};
+
+#endif
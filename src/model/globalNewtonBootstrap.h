@@ -0,0 +1,527 @@
+/*
+ * Global Newton bootstrap for piecewise zero-yield curves.
+ *
+ * Drop-in replacement for QuantLib's IterativeBootstrap, e.g.
+ *     PiecewiseYieldCurve<ZeroYield, Linear, GlobalNewtonBootstrap>
+ * Instead of a Brent search per pillar (repeated in an outer loop when a
+ * helper spans several pillars) all zero rates are solved at once with
+ * Newton steps. The Jacobian of the helper quotes with respect to the
+ * curve nodes is built analytically:
+ *   - deposits / futures / FRAs: the implied quote is affine in the
+ *     forward ratio P(start) / P(end); the slope is identified once when
+ *     the curve is (re)initialized.
+ *   - SwapRateHelper: par rate from the fixed annuity and the projected
+ *     Ibor coupons, with own or exogenous discounting; an exogenous
+ *     handle linked to the curve being solved counts as own.
+ *   - OISRateHelper: par rate from the fixed annuity and the telescoped
+ *     compounded overnight coupons.
+ * Any other helper falls back to a bumped Jacobian row.
+ *
+ * Residuals always come from the helpers' own impliedQuote(), so the
+ * solution is identical to the iterative bootstrap; the analytic Jacobian
+ * only drives the step. Node weights are derived from the interpolator,
+ * so interpolations must be linear in the node values (Linear, Cubic).
+ */
+
+#ifndef GLOBAL_NEWTON_BOOTSTRAP_H
+#define GLOBAL_NEWTON_BOOTSTRAP_H
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/overnightindexedcoupon.hpp>
+#include <ql/math/array.hpp>
+#include <ql/math/interpolation.hpp>
+#include <ql/math/matrix.hpp>
+#include <ql/math/matrixutilities/qrdecomposition.hpp>
+#include <ql/settings.hpp>
+#include <ql/termstructures/bootstraphelper.hpp>
+#include <ql/termstructures/yield/bootstraptraits.hpp>
+#include <ql/termstructures/yield/oisratehelper.hpp>
+#include <ql/termstructures/yield/ratehelpers.hpp>
+#include <ql/utilities/dataformatters.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace QuantLib;
+
+// The exogenous discounting handles are protected in the rate helpers.
+struct SwapRateHelperDiscount : public SwapRateHelper {
+    static Handle<YieldTermStructure> of(const SwapRateHelper &helper) {
+        return helper.*(&SwapRateHelperDiscount::discountHandle_);
+    }
+};
+
+struct OISRateHelperDiscount : public OISRateHelper {
+    static Handle<YieldTermStructure> of(const OISRateHelper &helper) {
+        return helper.*(&OISRateHelperDiscount::discountHandle_);
+    }
+};
+
+template <class Curve>
+class GlobalNewtonBootstrap {
+    typedef typename Curve::traits_type Traits;
+    typedef typename Curve::interpolator_type Interpolator;
+    static_assert(std::is_same<Traits, ZeroYield>::value,
+                  "GlobalNewtonBootstrap works on zero-yield curves");
+  public:
+    GlobalNewtonBootstrap();
+    void setup(Curve* ts);
+    void calculate() const;
+  private:
+    enum HelperKind { MoneyMarket, IborSwap, OvernightSwap, Other };
+    // d(quote) / d(log discount) at the given curve time
+    typedef std::vector<std::pair<Time, Real> > Sensitivities;
+
+    void initialize() const;
+    void identifyMoneyMarketSlopes() const;
+    void setNodes(const Array &x) const;
+    Real residuals(Array &r) const;
+    void jacobian(Matrix &jac) const;
+    void sensitivities(Size j, Sensitivities &s) const;
+    void annuity(const Leg &fixedLeg, const Handle<YieldTermStructure> &disc,
+                 Real &value, Sensitivities &s, Real scale) const;
+    bool ownDiscounting(const Handle<YieldTermStructure> &disc) const;
+    DiscountFactor discount(const Handle<YieldTermStructure> &disc,
+                            const Date &d) const;
+    void addNodeWeights(Time t, Real dQ, Matrix &jac, Size row) const;
+    const ext::shared_ptr<typename Traits::helper> &helper(Size j) const {
+        return ts_->instruments_[firstAliveHelper_ + j];
+    }
+
+    Curve* ts_;
+    Size n_;
+    mutable bool initialized_, validCurve_, slopesIdentified_;
+    mutable Size firstAliveHelper_, alive_;
+    mutable std::vector<HelperKind> kinds_;
+    mutable std::vector<Real> slopes_;
+    mutable std::vector<std::vector<Real> > unitData_;
+    mutable std::vector<Interpolation> unitInterpolations_;
+};
+
+
+// template definitions
+
+template <class Curve>
+GlobalNewtonBootstrap<Curve>::GlobalNewtonBootstrap()
+    : ts_(0), n_(0), initialized_(false), validCurve_(false),
+      slopesIdentified_(false), firstAliveHelper_(0), alive_(0) {}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::setup(Curve* ts) {
+    ts_ = ts;
+    n_ = ts_->instruments_.size();
+    QL_REQUIRE(n_ > 0, "no bootstrap helpers given");
+    for (Size j = 0; j < n_; ++j)
+        ts_->registerWith(ts_->instruments_[j]);
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::initialize() const {
+    std::sort(ts_->instruments_.begin(), ts_->instruments_.end(),
+              detail::BootstrapHelperSorter());
+    // skip expired helpers
+    Date firstDate = Traits::initialDate(ts_);
+    QL_REQUIRE(ts_->instruments_[n_ - 1]->pillarDate() > firstDate,
+               "all instruments expired");
+    firstAliveHelper_ = 0;
+    while (ts_->instruments_[firstAliveHelper_]->pillarDate() <= firstDate)
+        ++firstAliveHelper_;
+    alive_ = n_ - firstAliveHelper_;
+    QL_REQUIRE(alive_ + 1 >= Interpolator::requiredPoints,
+               "not enough alive instruments: " << alive_ <<
+               " provided, " << Interpolator::requiredPoints - 1 <<
+               " required");
+
+    std::vector<Date> &dates = ts_->dates_;
+    std::vector<Time> &times = ts_->times_;
+    dates.resize(alive_ + 1);
+    times.resize(alive_ + 1);
+    dates[0] = firstDate;
+    times[0] = ts_->timeFromReference(dates[0]);
+
+    kinds_.resize(alive_);
+    Date maxDate = firstDate;
+    for (Size i = 1; i <= alive_; ++i) {
+        const ext::shared_ptr<typename Traits::helper> &h = helper(i - 1);
+        dates[i] = h->pillarDate();
+        times[i] = ts_->timeFromReference(dates[i]);
+        QL_REQUIRE(dates[i - 1] != dates[i],
+                   "more than one instrument with pillar " << dates[i]);
+        QL_REQUIRE(h->latestRelevantDate() > maxDate,
+                   io::ordinal(i) << " alive instrument (pillar: " <<
+                   dates[i] << ") has latestRelevantDate before or equal "
+                   "to previous instrument's latestRelevantDate");
+        maxDate = h->latestRelevantDate();
+
+        if (ext::dynamic_pointer_cast<SwapRateHelper>(h))
+            kinds_[i - 1] = IborSwap;
+        else if (ext::dynamic_pointer_cast<OISRateHelper>(h))
+            kinds_[i - 1] = OvernightSwap;
+        else if (ext::dynamic_pointer_cast<DepositRateHelper>(h) ||
+                 ext::dynamic_pointer_cast<FuturesRateHelper>(h) ||
+                 ext::dynamic_pointer_cast<FraRateHelper>(h))
+            kinds_[i - 1] = MoneyMarket;
+        else
+            kinds_[i - 1] = Other;
+    }
+    ts_->maxDate_ = maxDate;
+
+    if (!validCurve_ || ts_->data_.size() != alive_ + 1)
+        ts_->data_ = std::vector<Real>(alive_ + 1, Traits::initialValue(ts_));
+    ts_->interpolation_ = ts_->interpolator_.interpolate(
+                times.begin(), times.end(), ts_->data_.begin());
+    ts_->interpolation_.update();
+
+    // the interpolation is linear in the node values, so the weight of
+    // node k at time t is the interpolation of the k-th unit vector.
+    unitData_.assign(alive_ + 1, std::vector<Real>(alive_ + 1, 0.0));
+    unitInterpolations_.resize(alive_ + 1);
+    for (Size k = 0; k <= alive_; ++k) {
+        unitData_[k][k] = 1.0;
+        unitInterpolations_[k] = ts_->interpolator_.interpolate(
+                times.begin(), times.end(), unitData_[k].begin());
+        unitInterpolations_[k].update();
+    }
+
+    slopesIdentified_ = false;
+    initialized_ = true;
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::identifyMoneyMarketSlopes() const {
+    // quote = a + b * P(start) / P(end); b is identified from two flat
+    // curves and stays valid as long as the helper dates do not move.
+    std::vector<Real> saved = ts_->data_;
+    const Real levels[] = { 0.01, 0.03 };
+    std::vector<Real> quotes[2], ratios[2];
+    for (Size l = 0; l < 2; ++l) {
+        std::fill(ts_->data_.begin(), ts_->data_.end(), levels[l]);
+        ts_->interpolation_.update();
+        for (Size j = 0; j < alive_; ++j) {
+            if (kinds_[j] != MoneyMarket)
+                continue;
+            const ext::shared_ptr<typename Traits::helper> &h = helper(j);
+            quotes[l].push_back(h->impliedQuote());
+            ratios[l].push_back(ts_->discount(h->earliestDate()) /
+                                ts_->discount(h->maturityDate()));
+        }
+    }
+    slopes_.assign(alive_, 0.0);
+    for (Size j = 0, m = 0; j < alive_; ++j) {
+        if (kinds_[j] != MoneyMarket)
+            continue;
+        slopes_[j] = (quotes[1][m] - quotes[0][m]) /
+                     (ratios[1][m] - ratios[0][m]);
+        ++m;
+    }
+    ts_->data_ = saved;
+    ts_->interpolation_.update();
+    slopesIdentified_ = true;
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::setNodes(const Array &x) const {
+    for (Size i = 0; i < alive_; ++i)
+        Traits::updateGuess(ts_->data_, x[i], i + 1);
+    ts_->interpolation_.update();
+}
+
+template <class Curve>
+Real GlobalNewtonBootstrap<Curve>::residuals(Array &r) const {
+    Real maxError = 0.0;
+    for (Size j = 0; j < alive_; ++j) {
+        r[j] = -helper(j)->quoteError();
+        maxError = std::max(maxError, std::fabs(r[j]));
+    }
+    return maxError;
+}
+
+template <class Curve>
+bool GlobalNewtonBootstrap<Curve>::ownDiscounting(
+            const Handle<YieldTermStructure> &disc) const {
+    // in single-curve mode the exogenous handle is linked to this very
+    // curve, and its discount factors move with the nodes
+    return disc.empty() || disc.currentLink().get() == ts_;
+}
+
+template <class Curve>
+DiscountFactor GlobalNewtonBootstrap<Curve>::discount(
+            const Handle<YieldTermStructure> &disc, const Date &d) const {
+    return ownDiscounting(disc) ? ts_->discount(d) : disc->discount(d);
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::annuity(const Leg &fixedLeg,
+            const Handle<YieldTermStructure> &disc,
+            Real &value, Sensitivities &s, Real scale) const {
+    // fixed leg annuity; when discounting on this curve, its sensitivity
+    // (times scale) is appended to s.
+    Date today = ts_->referenceDate();
+    value = 0.0;
+    for (Size i = 0; i < fixedLeg.size(); ++i) {
+        ext::shared_ptr<Coupon> c =
+                ext::dynamic_pointer_cast<Coupon>(fixedLeg[i]);
+        if (!c || c->hasOccurred(today))
+            continue;
+        Real pv = c->nominal() * c->accrualPeriod() * discount(disc, c->date());
+        value += pv;
+        if (ownDiscounting(disc))
+            s.push_back(std::make_pair(
+                        ts_->timeFromReference(c->date()), scale * pv));
+    }
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::sensitivities(Size j,
+            Sensitivities &s) const {
+    const ext::shared_ptr<typename Traits::helper> &h = helper(j);
+    Date today = Settings::instance().evaluationDate();
+    Date refDate = ts_->referenceDate();
+    s.clear();
+
+    if (kinds_[j] == MoneyMarket) {
+        Real ratio = ts_->discount(h->earliestDate()) /
+                     ts_->discount(h->maturityDate());
+        s.push_back(std::make_pair(
+                    ts_->timeFromReference(h->earliestDate()),
+                    slopes_[j] * ratio));
+        s.push_back(std::make_pair(
+                    ts_->timeFromReference(h->maturityDate()),
+                    -slopes_[j] * ratio));
+    } else if (kinds_[j] == IborSwap) {
+        ext::shared_ptr<SwapRateHelper> sh =
+                ext::dynamic_pointer_cast<SwapRateHelper>(h);
+        ext::shared_ptr<VanillaSwap> swap = sh->swap();
+        Handle<YieldTermStructure> disc = SwapRateHelperDiscount::of(*sh);
+        Spread spread = sh->spread();
+
+        // floating leg value and its forecasting sensitivities
+        Real floating = 0.0;
+        Sensitivities floatingS;
+        const Leg &leg = swap->floatingLeg();
+        for (Size i = 0; i < leg.size(); ++i) {
+            ext::shared_ptr<IborCoupon> c =
+                    ext::dynamic_pointer_cast<IborCoupon>(leg[i]);
+            if (!c || c->hasOccurred(refDate))
+                continue;
+            DiscountFactor pd = discount(disc, c->date());
+            Real nominalAccrual = c->nominal() * c->accrualPeriod();
+            Real amount;
+            if (c->fixingDate() >= today) {
+                const ext::shared_ptr<IborIndex> &index = c->iborIndex();
+                Date start = index->valueDate(c->fixingDate());
+                Date end = c->fixingEndDate();
+                Time span = index->dayCounter().yearFraction(start, end);
+                Real ratio = ts_->discount(start) / ts_->discount(end);
+                Real dF = nominalAccrual * c->gearing() * ratio / span * pd;
+                amount = nominalAccrual *
+                    (c->gearing() * (ratio - 1.0) / span + c->spread());
+                floatingS.push_back(std::make_pair(
+                            ts_->timeFromReference(start), dF));
+                floatingS.push_back(std::make_pair(
+                            ts_->timeFromReference(end), -dF));
+            } else {
+                amount = c->amount();
+            }
+            Real pv = (amount + nominalAccrual * spread) * pd;
+            floating += pv;
+            if (ownDiscounting(disc))
+                floatingS.push_back(std::make_pair(
+                            ts_->timeFromReference(c->date()), pv));
+        }
+
+        Real a;
+        Sensitivities annuityS;
+        annuity(swap->fixedLeg(), disc, a, annuityS, 1.0);
+        Real rate = floating / a;
+        for (Size i = 0; i < floatingS.size(); ++i)
+            s.push_back(std::make_pair(floatingS[i].first,
+                                       floatingS[i].second / a));
+        for (Size i = 0; i < annuityS.size(); ++i)
+            s.push_back(std::make_pair(annuityS[i].first,
+                                       -rate * annuityS[i].second / a));
+    } else if (kinds_[j] == OvernightSwap) {
+        ext::shared_ptr<OISRateHelper> oh =
+                ext::dynamic_pointer_cast<OISRateHelper>(h);
+        ext::shared_ptr<OvernightIndexedSwap> swap = oh->swap();
+        Handle<YieldTermStructure> disc = OISRateHelperDiscount::of(*oh);
+
+        // compounded coupons telescope to P(first value) / P(last value)
+        Real floating = 0.0;
+        Sensitivities floatingS;
+        const Leg &leg = swap->overnightLeg();
+        for (Size i = 0; i < leg.size(); ++i) {
+            ext::shared_ptr<OvernightIndexedCoupon> c =
+                    ext::dynamic_pointer_cast<OvernightIndexedCoupon>(leg[i]);
+            if (!c || c->hasOccurred(refDate))
+                continue;
+            DiscountFactor pd = discount(disc, c->date());
+            Real amount;
+            if (c->fixingDates().front() >= today) {
+                const std::vector<Date> &values = c->valueDates();
+                Real ratio = ts_->discount(values.front()) /
+                             ts_->discount(values.back());
+                Real dF = c->nominal() * c->gearing() * ratio * pd;
+                amount = c->nominal() * (c->gearing() * (ratio - 1.0) +
+                                         c->accrualPeriod() * c->spread());
+                floatingS.push_back(std::make_pair(
+                            ts_->timeFromReference(values.front()), dF));
+                floatingS.push_back(std::make_pair(
+                            ts_->timeFromReference(values.back()), -dF));
+            } else {
+                amount = c->amount();
+            }
+            floating += amount * pd;
+            if (ownDiscounting(disc))
+                floatingS.push_back(std::make_pair(
+                            ts_->timeFromReference(c->date()), amount * pd));
+        }
+
+        Real a;
+        Sensitivities annuityS;
+        annuity(swap->fixedLeg(), disc, a, annuityS, 1.0);
+        Real rate = floating / a;
+        for (Size i = 0; i < floatingS.size(); ++i)
+            s.push_back(std::make_pair(floatingS[i].first,
+                                       floatingS[i].second / a));
+        for (Size i = 0; i < annuityS.size(); ++i)
+            s.push_back(std::make_pair(annuityS[i].first,
+                                       -rate * annuityS[i].second / a));
+    }
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::addNodeWeights(Time t, Real dQ,
+            Matrix &jac, Size row) const {
+    // log P(t) = -z(t) t, z being linear in the nodes; node 0 is tied to
+    // node 1 by the ZeroYield traits.
+    if (t <= 0.0)
+        return;
+    Time tMax = ts_->times_.back();
+    for (Size k = 0; k <= alive_; ++k) {
+        Real w;
+        if (t <= tMax) {
+            w = unitInterpolations_[k](t, true);
+        } else {
+            // flat forward extrapolation of InterpolatedZeroCurve
+            w = (unitData_[k][alive_] * t + tMax * (t - tMax) *
+                 unitInterpolations_[k].derivative(tMax, true)) / t;
+        }
+        if (w != 0.0)
+            jac[row][k == 0 ? 0 : k - 1] -= dQ * t * w;
+    }
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::jacobian(Matrix &jac) const {
+    std::fill(jac.begin(), jac.end(), 0.0);
+    bool bumpRequired = false;
+    Sensitivities s;
+    for (Size j = 0; j < alive_; ++j) {
+        if (kinds_[j] == Other) {
+            bumpRequired = true;
+            continue;
+        }
+        sensitivities(j, s);
+        for (Size i = 0; i < s.size(); ++i)
+            addNodeWeights(s[i].first, s[i].second, jac, j);
+    }
+
+    if (bumpRequired) {
+        const Real bump = 1.0e-6;
+        std::vector<Real> base(alive_);
+        for (Size j = 0; j < alive_; ++j)
+            if (kinds_[j] == Other)
+                base[j] = helper(j)->impliedQuote();
+        for (Size k = 0; k < alive_; ++k) {
+            Real z = ts_->data_[k + 1];
+            Traits::updateGuess(ts_->data_, z + bump, k + 1);
+            ts_->interpolation_.update();
+            for (Size j = 0; j < alive_; ++j)
+                if (kinds_[j] == Other)
+                    jac[j][k] = (helper(j)->impliedQuote() - base[j]) / bump;
+            Traits::updateGuess(ts_->data_, z, k + 1);
+            ts_->interpolation_.update();
+        }
+    }
+}
+
+template <class Curve>
+void GlobalNewtonBootstrap<Curve>::calculate() const {
+    if (!initialized_ || ts_->moving_)
+        initialize();
+
+    for (Size j = 0; j < alive_; ++j) {
+        const ext::shared_ptr<typename Traits::helper> &h = helper(j);
+        QL_REQUIRE(h->quote()->isValid(),
+                   io::ordinal(firstAliveHelper_ + j + 1) <<
+                   " instrument (maturity: " << h->maturityDate() <<
+                   ", pillar: " << h->pillarDate() <<
+                   ") has an invalid quote");
+        h->setTermStructure(const_cast<Curve*>(ts_));
+    }
+    if (!slopesIdentified_)
+        identifyMoneyMarketSlopes();
+
+    Real accuracy = ts_->accuracy_;
+    Size maxIterations = Traits::maxIterations();
+
+    Array x(alive_), r(alive_), trialR(alive_);
+    for (Size i = 0; i < alive_; ++i)
+        x[i] = ts_->data_[i + 1];
+    setNodes(x);
+    Matrix jac(alive_, alive_);
+
+    try {
+        Real error = residuals(r);
+        for (Size iteration = 0; error > accuracy; ++iteration) {
+            QL_REQUIRE(iteration < maxIterations,
+                       "convergence not reached after " << iteration <<
+                       " Newton iterations; last error " << error <<
+                       ", required accuracy " << accuracy);
+
+            jacobian(jac);
+            Array step = qrSolve(jac, -r);
+
+            // halve the step until the residuals decrease
+            Real lambda = 1.0, trialError = error;
+            Array trial(alive_);
+            for (Size halvings = 0; halvings < 20; ++halvings) {
+                trial = x + lambda * step;
+                setNodes(trial);
+                trialError = residuals(trialR);
+                if (trialError < error)
+                    break;
+                lambda *= 0.5;
+            }
+            QL_REQUIRE(trialError < error,
+                       io::ordinal(iteration + 1) << " Newton iteration: "
+                       "no descent direction, error " << error);
+
+            Real change = 0.0;
+            for (Size i = 0; i < alive_; ++i)
+                change = std::max(change, std::fabs(trial[i] - x[i]));
+            x = trial;
+            r = trialR;
+            error = trialError;
+            if (change <= accuracy)
+                break;
+        }
+    } catch (std::exception &e) {
+        if (validCurve_) {
+            // the previous curve state might have been a bad guess
+            validCurve_ = initialized_ = false;
+            calculate();
+            return;
+        }
+        QL_FAIL("global Newton bootstrap failed, reference date " <<
+                ts_->dates_[0] << ": " << e.what());
+    }
+    validCurve_ = true;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Finite-difference swaption engines that can price on another
+ * swaption's grid.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/methods/finitedifferences/stepconditions/fdmbermudanstepcondition.hpp>
+
+#include "model/gridSwaptionEngine.h"
+
+std::map<Time, Date> exerciseTimes(const Exercise &exercise,
+                                   const Date &referenceDate,
+                                   const DayCounter &dayCounter) {
+    std::map<Time, Date> t2d;
+    const std::vector<Date> &dates = exercise.dates();
+    for (Size i = 0; i < dates.size(); i++) {
+        const Time t = dayCounter.yearFraction(referenceDate, dates[i]);
+        QL_REQUIRE(t >= 0, "exercise dates must not contain past date");
+        t2d[t] = dates[i];
+    }
+    return t2d;
+}
+
+ext::shared_ptr<FdmStepConditionComposite> gridStepConditions(
+        const std::map<Time, Date> &exercise,
+        const std::map<Time, Date> &gridExercise,
+        const std::vector<Time> &gridTimes,
+        const Date &referenceDate, const DayCounter &dayCounter,
+        const ext::shared_ptr<FdmMesher> &mesher,
+        const ext::shared_ptr<FdmInnerValueCalculator> &calculator) {
+    std::vector<Date> dates;
+    for (std::map<Time, Date>::const_iterator it = exercise.begin();
+         it != exercise.end(); ++it) {
+        QL_REQUIRE(gridExercise.count(it->first),
+                   "exercise on " << it->second << " is not on the grid");
+        dates.push_back(it->second);
+    }
+    std::vector<Time> stops;
+    for (std::map<Time, Date>::const_iterator it = gridExercise.begin();
+         it != gridExercise.end(); ++it)
+        stops.push_back(it->first);
+
+    // a Bermudan condition on a single date exercises a European early
+    std::list<std::vector<Time> > stoppingTimes;
+    stoppingTimes.push_back(stops);
+    stoppingTimes.push_back(gridTimes);
+    FdmStepConditionComposite::Conditions conditions;
+    conditions.push_back(ext::make_shared<FdmBermudanStepCondition>(
+                dates, referenceDate, dayCounter, mesher, calculator));
+    return ext::make_shared<FdmStepConditionComposite>(stoppingTimes,
+                                                       conditions);
+}
@@ -0,0 +1,75 @@
+/*
+ * Finite-difference swaption engines that can price on another
+ * swaption's grid.
+ */
+
+#ifndef GRID_SWAPTION_ENGINE_H
+#define GRID_SWAPTION_ENGINE_H
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/methods/finitedifferences/meshers/fdmmesher.hpp>
+#include <ql/methods/finitedifferences/stepconditions/fdmstepconditioncomposite.hpp>
+#include <ql/methods/finitedifferences/utilities/fdminnervaluecalculator.hpp>
+
+#include <map>
+
+using namespace QuantLib;
+
+/*
+ * The mesh and time grid of an FD engine follow the exercise schedule
+ * it is given: a European alone ends its grid at its expiry and has
+ * none of the Bermudan's stopping times.  gridValue() prices a swaption
+ * on the grid laid out for another one, so that a co-terminal European
+ * and its Bermudan carry the same discretization error.  The exercise
+ * dates of swaption must be among those of grid.
+ */
+class GridSwaptionEngine {
+public:
+    virtual ~GridSwaptionEngine() {}
+    virtual Real gridValue(const Swaption::arguments &swaption,
+                           const Swaption::arguments &grid) const = 0;
+};
+
+// exercise times of the schedule, as the FD step conditions see them
+std::map<Time, Date> exerciseTimes(const Exercise &exercise,
+                                   const Date &referenceDate,
+                                   const DayCounter &dayCounter);
+
+/*
+ * Exercise conditions of the swaption priced on the grid; calculator
+ * gives its inner value at its exercise times.  The rollback stops at
+ * every exercise time of the grid and at the extra grid times.
+ */
+ext::shared_ptr<FdmStepConditionComposite> gridStepConditions(
+        const std::map<Time, Date> &exercise,
+        const std::map<Time, Date> &gridExercise,
+        const std::vector<Time> &gridTimes,
+        const Date &referenceDate, const DayCounter &dayCounter,
+        const ext::shared_ptr<FdmMesher> &mesher,
+        const ext::shared_ptr<FdmInnerValueCalculator> &calculator);
+
+/*
+ * The swap's inner value at the swaption's exercise times and zero at
+ * any other time, i.e. at the grid's maturity when the swaption expires
+ * before it.  FdmAffineModelSwapInnerValue is only defined at the
+ * exercise times it is given.
+ */
+class ExerciseInnerValue : public FdmInnerValueCalculator {
+public:
+    ExerciseInnerValue(const ext::shared_ptr<FdmInnerValueCalculator> &swap,
+                       const std::map<Time, Date> &exercise)
+    : swap_(swap), exercise_(exercise) {}
+
+    Real innerValue(const FdmLinearOpIterator &iter, Time t) {
+        return exercise_.count(t) ? swap_->innerValue(iter, t) : 0.0;
+    }
+    Real avgInnerValue(const FdmLinearOpIterator &iter, Time t) {
+        return exercise_.count(t) ? swap_->avgInnerValue(iter, t) : 0.0;
+    }
+
+private:
+    ext::shared_ptr<FdmInnerValueCalculator> swap_;
+    std::map<Time, Date> exercise_;
+};
+
+#endif
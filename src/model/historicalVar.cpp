@@ -0,0 +1,133 @@
+/*
+ * Historical-scenario VaR of a Bermudan swaption book.
+ */
+
+#include <ql/instruments/swaption.hpp>
+
+#include "model/calibrationCache.h"
+#include "model/evaluationContext.h"
+#include "model/historicalVar.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+VarResult historicalVar(const ScenarioBook &book,
+                        const std::vector<MarketShock> &scenarios,
+                        bool recalibrate, Real confidence,
+                        const std::string &pnlFile, Size maxThreads) {
+    QL_REQUIRE(!scenarios.empty(), "no scenarios given");
+    QL_REQUIRE(confidence > 0.0 && confidence < 1.0,
+               "confidence " << confidence << " out of (0, 1)");
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+
+    Size nDeals = book.deals.size();
+    Size nThreads = std::min(EvaluationContext::threads(maxThreads),
+                             scenarios.size());
+    EvaluationContext::prepare(nThreads);
+
+    std::ofstream output;
+    if (!pnlFile.empty()) {
+        output.open(pnlFile.c_str());
+        QL_REQUIRE(output, "cannot open " << pnlFile);
+        output << "scenario";
+        for (Size j = 0; j < nDeals; j++)
+            output << ",deal " << j + 1;
+        output << ",total\n";
+    }
+    std::mutex outputMutex;
+
+    VarResult result;
+    result.pnl.resize(scenarios.size());
+    std::atomic<Size> next(0);
+    std::vector<std::exception_ptr> errors(nThreads);
+    std::vector<std::vector<Real> > basePrices(nThreads);
+
+    auto work = [&](Size worker) {
+        try {
+            EvaluationContext context;
+            CalibrationCache::ReadOnly readOnly;
+
+            // this worker's clone of the market and the book
+            ext::shared_ptr<SwaptionMarket> market = book.market();
+            QuoteValues base = quoteValues(market->quotes);
+            std::vector<SwaptionDeal> deals;
+            std::vector<ext::shared_ptr<Swaption> > swaptions;
+            for (Size j = 0; j < nDeals; j++) {
+                deals.push_back(book.deals[j](*market));
+                swaptions.push_back(ext::make_shared<Swaption>(
+                            deals[j].swap, deals[j].exercise));
+                swaptions[j]->setPricingEngine(
+                            book.engine(*market, deals[j], 1.0));
+                basePrices[worker].push_back(swaptions[j]->NPV());
+            }
+
+            std::vector<Real> pnl(nDeals);
+            for (Size k = next++; k < scenarios.size(); k = next++) {
+                applyShock(market->quotes, base, scenarios[k]);
+                Real total = 0.0;
+                for (Size j = 0; j < nDeals; j++) {
+                    if (recalibrate)
+                        swaptions[j]->setPricingEngine(
+                                    book.engine(*market, deals[j], 1.0));
+                    pnl[j] = swaptions[j]->NPV() - basePrices[worker][j];
+                    total += pnl[j];
+                }
+                result.pnl[k] = total;
+
+                if (output.is_open()) {
+                    std::ostringstream line;
+                    line << std::setprecision(
+                                std::numeric_limits<double>::digits10 + 2)
+                         << k;
+                    for (Size j = 0; j < nDeals; j++)
+                        line << "," << pnl[j];
+                    line << "," << total << "\n";
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    output << line.str();
+                }
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (Size t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (Size t = 0; t < errors.size(); t++)
+        if (errors[t])
+            std::rethrow_exception(errors[t]);
+
+    // historical quantile of the losses, and the mean beyond it
+    result.basePrices = basePrices[0];
+    std::vector<Real> sorted(result.pnl);
+    std::sort(sorted.begin(), sorted.end());
+    Size tail = std::min<Size>(
+            Size((1.0 - confidence) * sorted.size()), sorted.size() - 1);
+    result.valueAtRisk = -sorted[tail];
+    Real tailSum = 0.0;
+    for (Size k = 0; k <= tail; k++)
+        tailSum += sorted[k];
+    result.expectedShortfall = -tailSum / (tail + 1);
+
+    std::cout << scenarios.size() << " scenarios on " << nThreads
+              << " workers in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start).count()
+              << " ms, VaR " << result.valueAtRisk
+              << ", ES " << result.expectedShortfall << std::endl;
+    return result;
+}
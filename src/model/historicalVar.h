@@ -0,0 +1,45 @@
+/*
+ * Historical-scenario VaR of a Bermudan swaption book.
+ */
+
+#ifndef HISTORICAL_VAR_H
+#define HISTORICAL_VAR_H
+
+#include "model/scenarioBook.h"
+
+#include <string>
+#include <vector>
+
+using namespace QuantLib;
+
+struct VarResult {
+    std::vector<Real> basePrices;
+    // book P&L per scenario, in scenario order
+    std::vector<Real> pnl;
+    // as positive losses at the confidence level
+    Real valueAtRisk, expectedShortfall;
+};
+
+/*
+ * Revalues the book under each scenario.  Every worker builds one clone
+ * of the market and the book, then loops over scenarios, shocking the
+ * quotes in place: the curves rebootstrap lazily on the next price.
+ * Unless recalibrate is set, the models keep the parameters calibrated
+ * on the base market and only refit the curve, so vol shocks only move
+ * prices when recalibrating.  Recalibrations start from the cached
+ * parameters but never store into the cache.
+ *
+ * If pnlFile is given, one line "scenario,deal 1,...,deal n,total" per
+ * scenario is appended as it finishes, in completion order.
+ *
+ * Workers run concurrently only with isolated evaluation contexts (see
+ * EvaluationContext); otherwise the run is serial.
+ */
+VarResult historicalVar(const ScenarioBook &book,
+                        const std::vector<MarketShock> &scenarios,
+                        bool recalibrate = false,
+                        Real confidence = 0.99,
+                        const std::string &pnlFile = std::string(),
+                        Size maxThreads = 0);
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * Batched Hull-White zero-bond kernels and a Jamshidian swaption engine
+ * built on them.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/math/solvers1d/brent.hpp>
+
+#include "model/hullWhiteKernels.h"
+
+#include <cmath>
+
+namespace {
+
+    // B(x, tau) = (1 - exp(-x tau)) / x with the x -> 0 limit
+    inline Real hwB(Real x, Time tau) {
+        if (x < std::sqrt(QL_EPSILON))
+            return tau;
+        return (1.0 - std::exp(-x * tau)) / x;
+    }
+
+    // sum_i c_i P(t, T_i; r) - 1, monotone decreasing and convex in r
+    struct CouponBondFunction {
+        CouponBondFunction(const HullWhiteBondKernel &kernel,
+                           const std::vector<Real> &coupons,
+                           std::vector<Real> &bonds)
+            : kernel_(kernel), coupons_(coupons), bonds_(bonds) {}
+        Real operator()(Rate r) const {
+            kernel_.discountBonds(r, bonds_);
+            Real value = -1.0;
+            for (Size i = 0; i < bonds_.size(); i++)
+                value += coupons_[i] * bonds_[i];
+            return value;
+        }
+        const HullWhiteBondKernel &kernel_;
+        const std::vector<Real> &coupons_;
+        std::vector<Real> &bonds_;
+    };
+
+}
+
+HullWhiteBondKernel::HullWhiteBondKernel(
+            const Handle<YieldTermStructure> &termStructure,
+            Time t, const std::vector<Time> &maturities)
+    : t_(t), maturities_(maturities), discounts_(maturities.size()),
+      sigmaP_(0.0), A_(maturities.size()), B_(maturities.size()) {
+    discountT_ = termStructure->discount(t);
+    forward_ = termStructure->forwardRate(t, t, Continuous, NoFrequency);
+    for (Size i = 0; i < maturities_.size(); i++)
+        discounts_[i] = termStructure->discount(maturities_[i]);
+}
+
+void HullWhiteBondKernel::update(Real a, Real sigma) {
+    // same expressions as HullWhite::A(), B() and discountBondOption()
+    Real b2t = hwB(a, 2.0 * t_);
+    for (Size i = 0; i < maturities_.size(); i++)
+        B_[i] = hwB(a, maturities_[i] - t_);
+    for (Size i = 0; i < maturities_.size(); i++)
+        A_[i] = discounts_[i] / discountT_ *
+                std::exp(B_[i] * forward_ -
+                         0.25 * sigma * sigma * B_[i] * B_[i] * b2t);
+    sigmaP_ = sigma * std::sqrt(0.5 * b2t);
+}
+
+void HullWhiteBondKernel::discountBonds(Rate r,
+                                        std::vector<Real> &bonds) const {
+    bonds.resize(maturities_.size());
+    for (Size i = 0; i < maturities_.size(); i++)
+        bonds[i] = A_[i] * std::exp(-B_[i] * r);
+}
+
+void HullWhiteBondKernel::discountBondOptions(Option::Type type,
+                                              const std::vector<Real> &strikes,
+                                              std::vector<Real> &values) const {
+    Real w = (type == Option::Call ? 1.0 : -1.0);
+    values.resize(maturities_.size());
+    for (Size i = 0; i < maturities_.size(); i++) {
+        Real f = discounts_[i];
+        Real k = discountT_ * strikes[i];
+        Real v = sigmaP_ * B_[i];
+        if (v > 0.0) {
+            Real d1 = std::log(f / k) / v + 0.5 * v;
+            Real d2 = d1 - v;
+            values[i] = w * (f * 0.5 * std::erfc(-w * d1 * M_SQRT1_2) -
+                             k * 0.5 * std::erfc(-w * d2 * M_SQRT1_2));
+        } else {
+            values[i] = std::max(w * (f - k), 0.0);
+        }
+    }
+}
+
+Rate HullWhiteBondKernel::criticalRate(
+            const std::vector<Real> &coupons) const {
+    // Newton on the convex decreasing coupon-bond value started at the
+    // forward short rate, where the bonds are close to their forwards;
+    // Brent as in JamshidianSwaptionEngine if it runs away
+    std::vector<Real> bonds;
+    CouponBondFunction f(*this, coupons, bonds);
+    Rate rStar = forward_;
+    for (Size iteration = 0; iteration < 50; iteration++) {
+        Real value = f(rStar);
+        Real derivative = 0.0;
+        for (Size i = 0; i < bonds.size(); i++)
+            derivative -= coupons[i] * B_[i] * bonds[i];
+        if (!(derivative < 0.0))
+            break;
+        Real step = value / derivative;
+        rStar -= step;
+        if (!std::isfinite(rStar) || std::fabs(rStar) > 10.0)
+            break;
+        if (std::fabs(step) < 1.0e-14)
+            return rStar;
+    }
+    Brent s1d;
+    s1d.setMaxEvaluations(10000);
+    s1d.setLowerBound(-10.0);
+    s1d.setUpperBound(10.0);
+    return s1d.solve(f, 1e-8, 0.05, -10.0, 10.0);
+}
+
+BatchedJamshidianSwaptionEngine::BatchedJamshidianSwaptionEngine(
+            const ext::shared_ptr<HullWhite> &model)
+    : GenericModelEngine<HullWhite, Swaption::arguments,
+                         Swaption::results>(model),
+      checkDiscount_(Null<Real>()) {}
+
+HullWhiteBondKernel &BatchedJamshidianSwaptionEngine::kernel() const {
+    const Handle<YieldTermStructure> &ts = model_->termStructure();
+    Date referenceDate = ts->referenceDate();
+    Date exerciseDate = arguments_.exercise->date(0);
+    // one curve lookup tells whether the cached discounts are stale
+    DiscountFactor check = ts->discount(arguments_.fixedPayDates.back());
+    if (!kernel_ || referenceDate != referenceDate_ ||
+        exerciseDate != exerciseDate_ ||
+        arguments_.fixedPayDates != payDates_ || check != checkDiscount_) {
+        DayCounter dayCounter = ts->dayCounter();
+        std::vector<Time> payTimes(arguments_.fixedPayDates.size());
+        for (Size i = 0; i < payTimes.size(); i++)
+            payTimes[i] = dayCounter.yearFraction(referenceDate,
+                                                  arguments_.fixedPayDates[i]);
+        kernel_ = ext::make_shared<HullWhiteBondKernel>(
+                ts, dayCounter.yearFraction(referenceDate, exerciseDate),
+                payTimes);
+        referenceDate_ = referenceDate;
+        exerciseDate_ = exerciseDate;
+        payDates_ = arguments_.fixedPayDates;
+        checkDiscount_ = check;
+    }
+    return *kernel_;
+}
+
+void BatchedJamshidianSwaptionEngine::calculate() const {
+    QL_REQUIRE(arguments_.settlementType == Settlement::Physical,
+               "cash-settled swaptions not priced by Jamshidian engine");
+    QL_REQUIRE(arguments_.exercise->type() == Exercise::European,
+               "cannot use the Jamshidian decomposition "
+               "on exotic swaptions");
+    QL_REQUIRE(arguments_.nominal != Null<Real>(),
+               "non-constant nominals are not supported yet");
+
+    HullWhiteBondKernel &k = kernel();
+    k.update(model_->a(), model_->sigma());
+
+    Size n = k.size();
+    std::vector<Real> coupons(n);
+    for (Size i = 0; i < n; i++)
+        coupons[i] = arguments_.fixedCoupons[i] / arguments_.nominal;
+    coupons.back() += 1.0;
+
+    Rate rStar = k.criticalRate(coupons);
+    k.discountBonds(rStar, strikes_);
+    Option::Type w = (arguments_.type == VanillaSwap::Payer ?
+                      Option::Put : Option::Call);
+    k.discountBondOptions(w, strikes_, values_);
+    Real value = 0.0;
+    for (Size i = 0; i < n; i++)
+        value += coupons[i] * values_[i];
+    results_.value = arguments_.nominal * value;
+}
@@ -0,0 +1,82 @@
+/*
+ * Batched Hull-White zero-bond kernels and a Jamshidian swaption engine
+ * built on them.
+ */
+
+#ifndef HULL_WHITE_KERNELS_H
+#define HULL_WHITE_KERNELS_H
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/models/shortrate/onefactormodels/hullwhite.hpp>
+#include <ql/option.hpp>
+#include <ql/pricingengines/genericmodelengine.hpp>
+
+#include <vector>
+
+using namespace QuantLib;
+
+/*
+ * Zero bonds P(t, T_i) of a Hull-White model for one observation time t
+ * and a fixed set of maturities T_i.  The term-structure discount
+ * factors and the forward at t are read once at construction; update()
+ * refreshes A(t, T_i) and B(t, T_i) for new model parameters and the
+ * bond and bond-option evaluations are flat loops over the maturities.
+ */
+class HullWhiteBondKernel {
+public:
+    HullWhiteBondKernel(const Handle<YieldTermStructure> &termStructure,
+                        Time t, const std::vector<Time> &maturities);
+
+    void update(Real a, Real sigma);
+
+    Size size() const { return maturities_.size(); }
+    Time time() const { return t_; }
+    const std::vector<Time> &maturities() const { return maturities_; }
+    const std::vector<Real> &A() const { return A_; }
+    const std::vector<Real> &B() const { return B_; }
+
+    // P(t, T_i) given the short rate at t
+    void discountBonds(Rate r, std::vector<Real> &bonds) const;
+    // short rate at t where sum_i coupons_i P(t, T_i) = 1
+    Rate criticalRate(const std::vector<Real> &coupons) const;
+    // options expiring at t on the bonds, with per-bond strikes
+    void discountBondOptions(Option::Type type,
+                             const std::vector<Real> &strikes,
+                             std::vector<Real> &values) const;
+
+private:
+    Time t_;
+    std::vector<Time> maturities_;
+    DiscountFactor discountT_;
+    std::vector<DiscountFactor> discounts_;
+    Rate forward_;
+    Real sigmaP_;
+    std::vector<Real> A_, B_;
+};
+
+/*
+ * JamshidianSwaptionEngine for HullWhite on HullWhiteBondKernel: the
+ * critical short rate is found by Newton steps on the batched bond sum
+ * and the kernel (with its discount factors) is kept between
+ * calculations as long as the swaption dates and the curve are the
+ * same, so calibration iterations never go back to the term structure.
+ */
+class BatchedJamshidianSwaptionEngine
+    : public GenericModelEngine<HullWhite, Swaption::arguments,
+                                Swaption::results> {
+public:
+    explicit BatchedJamshidianSwaptionEngine(
+                        const ext::shared_ptr<HullWhite> &model);
+    void calculate() const;
+
+private:
+    HullWhiteBondKernel &kernel() const;
+
+    mutable ext::shared_ptr<HullWhiteBondKernel> kernel_;
+    mutable Date referenceDate_, exerciseDate_;
+    mutable std::vector<Date> payDates_;
+    mutable DiscountFactor checkDiscount_;
+    mutable std::vector<Real> strikes_, values_;
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Direct Black / Bachelier implied volatility for swaption helpers.
+ */
+
+#include <ql/exercise.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/models/shortrate/calibrationhelpers/swaptionhelper.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include "model/impliedVolatility.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    const Real ONE_OVER_SQRT_TWO_PI = 0.3989422804014326779399461;
+    const Size maxHouseholderSteps = 32;
+
+    // out-of-the-money normalised Black call, x = ln(F/K) <= 0
+    Real normalisedBlack(Real x, Real s) {
+        if (s <= 0.0)
+            return 0.0;
+        Real d1 = x / s + 0.5 * s;
+        Real d2 = x / s - 0.5 * s;
+        return std::exp(0.5 * x) * 0.5 * std::erfc(-d1 * M_SQRT1_2) -
+               std::exp(-0.5 * x) * 0.5 * std::erfc(-d2 * M_SQRT1_2);
+    }
+
+    // out-of-the-money Bachelier value, x = -|F - K|
+    Real normalisedBachelier(Real x, Real s) {
+        if (s <= 0.0)
+            return 0.0;
+        Real u = x / s;
+        return s * ONE_OVER_SQRT_TWO_PI * std::exp(-0.5 * u * u) +
+               x * 0.5 * std::erfc(-u * M_SQRT1_2);
+    }
+
+    /*
+     * Householder iteration of order three on an increasing price
+     * function, falling back to bisection whenever a step leaves the
+     * current bracket.  hessianRatios(s, h2, h3) returns f''/f' and
+     * f'''/f'.
+     */
+    template <class Price, class Vega, class Ratios>
+    Real householder(Real target, Real guess, Real lower, Real upper,
+                     const Price &price, const Vega &vega,
+                     const Ratios &ratios) {
+        Real s = guess;
+        for (Size i = 0; i < maxHouseholderSteps; i++) {
+            Real f = price(s) - target;
+            if (f < 0.0)
+                lower = s;
+            else
+                upper = s;
+            if (f == 0.0)
+                break;
+            // an underflowing vega sends the step out of the bracket
+            Real h2, h3;
+            ratios(s, h2, h3);
+            Real nu = -f / vega(s);
+            Real step = nu * (1.0 + 0.5 * h2 * nu) /
+                        (1.0 + nu * (h2 + h3 * nu / 6.0));
+            if (!std::isfinite(step))
+                step = nu;
+            Real next = s + step;
+            if (!(next > lower && next < upper))
+                next = (upper < QL_MAX_REAL ? 0.5 * (lower + upper)
+                                            : 2.0 * s);
+            if (std::fabs(next - s) <= 4.0 * QL_EPSILON * next) {
+                s = next;
+                break;
+            }
+            s = next;
+        }
+        return s;
+    }
+
+    struct BlackPrice {
+        explicit BlackPrice(Real x) : x(x) {}
+        Real operator()(Real s) const { return normalisedBlack(x, s); }
+        Real x;
+    };
+    struct BlackVega {
+        explicit BlackVega(Real x) : x(x) {}
+        Real operator()(Real s) const {
+            return ONE_OVER_SQRT_TWO_PI *
+                   std::exp(-0.5 * x * x / (s * s) - 0.125 * s * s);
+        }
+        Real x;
+    };
+    struct BlackRatios {
+        explicit BlackRatios(Real x) : x(x) {}
+        void operator()(Real s, Real &h2, Real &h3) const {
+            Real x2 = x * x;
+            h2 = x2 / (s * s * s) - 0.25 * s;
+            h3 = h2 * h2 - 3.0 * x2 / (s * s * s * s) - 0.25;
+        }
+        Real x;
+    };
+
+    struct BachelierPrice {
+        explicit BachelierPrice(Real x) : x(x) {}
+        Real operator()(Real s) const { return normalisedBachelier(x, s); }
+        Real x;
+    };
+    struct BachelierVega {
+        explicit BachelierVega(Real x) : x(x) {}
+        Real operator()(Real s) const {
+            Real u = x / s;
+            return ONE_OVER_SQRT_TWO_PI * std::exp(-0.5 * u * u);
+        }
+        Real x;
+    };
+    struct BachelierRatios {
+        explicit BachelierRatios(Real x) : x(x) {}
+        void operator()(Real s, Real &h2, Real &h3) const {
+            Real x2 = x * x, s2 = s * s;
+            h2 = x2 / (s2 * s);
+            h3 = h2 * h2 - 3.0 * x2 / (s2 * s2);
+        }
+        Real x;
+    };
+
+    // SwaptionHelper keeps the displacement protected
+    struct BlackCalibrationHelperShift : public BlackCalibrationHelper {
+        static Real of(const BlackCalibrationHelper &helper) {
+            return helper.*(&BlackCalibrationHelperShift::shift_);
+        }
+    };
+
+}
+
+Real blackImpliedStdDev(Option::Type type, Real strike, Real forward,
+                        Real undiscountedPrice, Real displacement) {
+    Real f = forward + displacement, k = strike + displacement;
+    QL_REQUIRE(f > 0.0 && k > 0.0,
+               "displaced forward (" << f << ") and strike (" << k
+               << ") must be positive");
+    Real x = std::log(f / k);
+    Real beta = undiscountedPrice / std::sqrt(f * k);
+    // reduce to the out-of-the-money option
+    Real theta = (type == Option::Call ? 1.0 : -1.0);
+    if (theta * x > 0.0)
+        beta -= theta * (std::exp(0.5 * x) - std::exp(-0.5 * x));
+    x = -std::fabs(x);
+    QL_REQUIRE(beta < std::exp(0.5 * x),
+               "price " << undiscountedPrice << " above the Black maximum");
+    if (beta <= 0.0)
+        return 0.0;
+
+    Real guess;
+    if (x == 0.0) {
+        // at the money the inversion is exact
+        return 2.0 * InverseCumulativeNormal()(0.5 * (beta + 1.0));
+    } else {
+        // start from the inflection point, or the small-price asymptote
+        Real sc = std::sqrt(2.0 * std::fabs(x));
+        guess = sc;
+        if (beta < normalisedBlack(x, sc))
+            guess = std::min(sc, std::fabs(x) /
+                                 std::sqrt(-2.0 * std::log(beta)));
+    }
+    return householder(beta, guess, 0.0, QL_MAX_REAL, BlackPrice(x),
+                       BlackVega(x), BlackRatios(x));
+}
+
+Real bachelierImpliedStdDev(Option::Type type, Real strike, Real forward,
+                            Real undiscountedPrice) {
+    Real theta = (type == Option::Call ? 1.0 : -1.0);
+    Real x = forward - strike;
+    Real value = undiscountedPrice;
+    if (theta * x > 0.0)
+        value -= theta * x;
+    x = -std::fabs(x);
+    if (value <= 0.0)
+        return 0.0;
+    // the value never exceeds s / sqrt(2 pi), exact at the money
+    Real lower = value / ONE_OVER_SQRT_TWO_PI;
+    if (x == 0.0)
+        return lower;
+    // far out of the money the value decays like exp(-x^2 / 2s^2)
+    Real guess = lower;
+    if (value < -x)
+        guess = std::max(lower, -x / std::sqrt(-2.0 * std::log(value / -x)));
+    return householder(value, guess, 0.0, QL_MAX_REAL, BachelierPrice(x),
+                       BachelierVega(x), BachelierRatios(x));
+}
+
+Volatility swaptionImpliedVolatility(
+        const ext::shared_ptr<BlackCalibrationHelper> &helper,
+        Real targetValue, Real accuracy, Size maxEvaluations,
+        Volatility minVol, Volatility maxVol) {
+    ext::shared_ptr<SwaptionHelper> swaptionHelper =
+            ext::dynamic_pointer_cast<SwaptionHelper>(helper);
+    if (!swaptionHelper)
+        return helper->impliedVolatility(targetValue, accuracy,
+                maxEvaluations, minVol, maxVol);
+
+    // the quantities SwaptionHelper::blackPrice() feeds its engine
+    ext::shared_ptr<VanillaSwap> swap = swaptionHelper->underlyingSwap();
+    Date exerciseDate = swaptionHelper->swaption()->exercise()->date(0);
+    Time expiry = Actual365Fixed().yearFraction(
+            Settings::instance().evaluationDate(), exerciseDate);
+    Real annuity = std::fabs(swap->fixedLegBPS()) / 1.0e-4;
+    Rate forward = swap->fairRate();
+    Rate strike = swap->fixedRate();
+    Option::Type type = (swap->type() == VanillaSwap::Payer ?
+                         Option::Call : Option::Put);
+    if (expiry <= 0.0 || annuity <= 0.0)
+        return helper->impliedVolatility(targetValue, accuracy,
+                maxEvaluations, minVol, maxVol);
+
+    Real stdDev;
+    if (helper->volatilityType() == Normal)
+        stdDev = bachelierImpliedStdDev(type, strike, forward,
+                                        targetValue / annuity);
+    else
+        stdDev = blackImpliedStdDev(type, strike, forward,
+                                    targetValue / annuity,
+                                    BlackCalibrationHelperShift::of(*helper));
+    Volatility implied = stdDev / std::sqrt(expiry);
+    QL_REQUIRE(implied >= minVol && implied <= maxVol,
+               "implied volatility " << implied << " outside ["
+               << minVol << ", " << maxVol << "]");
+    return implied;
+}
@@ -0,0 +1,37 @@
+/*
+ * Direct Black / Bachelier implied volatility for swaption helpers.
+ */
+
+#ifndef IMPLIED_VOLATILITY_H
+#define IMPLIED_VOLATILITY_H
+
+#include <ql/models/calibrationhelper.hpp>
+#include <ql/option.hpp>
+
+using namespace QuantLib;
+
+/*
+ * Implied total standard deviations from undiscounted prices
+ * (price / annuity).  The price is reduced to the out-of-the-money time
+ * value, started from a closed-form guess and polished with third-order
+ * Householder steps kept inside a bracket, so a handful of formula
+ * evaluations reach machine precision instead of a full repricing per
+ * solver iteration.
+ */
+Real blackImpliedStdDev(Option::Type type, Real strike, Real forward,
+                        Real undiscountedPrice, Real displacement = 0.0);
+Real bachelierImpliedStdDev(Option::Type type, Real strike, Real forward,
+                            Real undiscountedPrice);
+
+/*
+ * Same contract as BlackCalibrationHelper::impliedVolatility().  For
+ * SwaptionHelper the annuity, forward, strike and expiry used by its
+ * Black/Bachelier engine are read off the underlying swap and the value
+ * is inverted directly; other helpers fall back to the helper's solver.
+ */
+Volatility swaptionImpliedVolatility(
+        const ext::shared_ptr<BlackCalibrationHelper> &helper,
+        Real targetValue, Real accuracy, Size maxEvaluations,
+        Volatility minVol, Volatility maxVol);
+
+#endif
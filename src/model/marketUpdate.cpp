@@ -0,0 +1,39 @@
+/*
+ * Market-update transactions: quote snapshots with one notification
+ * per observer.
+ */
+
+#include <ql/patterns/observable.hpp>
+
+#include "model/marketUpdate.h"
+
+#include <iostream>
+
+MarketUpdate::MarketUpdate()
+: outer_(ObservableSettings::instance().updatesEnabled()),
+  committed_(false) {
+    if (outer_)
+        ObservableSettings::instance().disableUpdates(true);
+}
+
+MarketUpdate::~MarketUpdate() {
+    try {
+        commit();
+    } catch (std::exception &e) {
+        std::cout << "Market update: " << e.what() << std::endl;
+    }
+}
+
+void MarketUpdate::set(const ext::shared_ptr<SimpleQuote> &quote,
+                       Real value) {
+    QL_REQUIRE(!committed_, "market update already committed");
+    quote->setValue(value);
+}
+
+void MarketUpdate::commit() {
+    if (committed_)
+        return;
+    committed_ = true;
+    if (outer_)
+        ObservableSettings::instance().enableUpdates();
+}
@@ -0,0 +1,44 @@
+/*
+ * Market-update transactions: quote snapshots with one notification
+ * per observer.
+ */
+
+#ifndef MARKET_UPDATE_H
+#define MARKET_UPDATE_H
+
+#include <ql/quotes/simplequote.hpp>
+
+using namespace QuantLib;
+
+/*
+ * Setting quotes one by one notifies their observers once per quote,
+ * and each notification runs down rate helpers, curves, handles,
+ * indexes and instruments.  Within a MarketUpdate the notifications are
+ * held back by ObservableSettings::disableUpdates(true) and commit()
+ * sends one to each observer that any of the changed quotes has,
+ * however many of its quotes changed.
+ *
+ * Nothing observing the quotes is up to date until the commit, so
+ * nothing is priced inside a transaction.  A transaction opened inside
+ * another leaves the commit to the outer one.  The evaluation context
+ * holds one set of settings, so a transaction covers the quotes of its
+ * own context only.
+ */
+class MarketUpdate {
+public:
+    MarketUpdate();
+    // commits if commit() was not called, without throwing
+    ~MarketUpdate();
+
+    void set(const ext::shared_ptr<SimpleQuote> &quote, Real value);
+    // throws if an observer fails its update; the others are updated
+    void commit();
+
+private:
+    MarketUpdate(const MarketUpdate &);
+    MarketUpdate &operator=(const MarketUpdate &);
+
+    bool outer_, committed_;
+};
+
+#endif
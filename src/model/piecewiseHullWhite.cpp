@@ -0,0 +1,149 @@
+/*
+ * Piecewise-volatility Hull-White models: GHW on a tree and Gsr.
+ */
+
+#include <ql/math/optimization/endcriteria.hpp>
+#include <ql/math/optimization/levenbergmarquardt.hpp>
+#include <ql/math/solvers1d/bisection.hpp>
+#include <ql/math/solvers1d/brent.hpp>
+#include <ql/models/shortrate/calibrationhelpers/swaptionhelper.hpp>
+#include <ql/settings.hpp>
+
+#include "model/impliedVolatility.h"
+#include "model/piecewiseHullWhite.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+    // functor for equation solver
+    struct ghwBlackSolverImpl {
+        ghwBlackSolverImpl(ext::shared_ptr<GeneralizedHullWhite> &model,
+                ext::shared_ptr<BlackCalibrationHelper> &helper,
+                Size index, bool fillUncalibrated):model_(model),
+                    helper_(helper), index_(index),
+                    size_(model_->FixedReversion().size() / 2),
+                    fillUncalibrated_(fillUncalibrated), evaluations_(0) {
+        }
+
+        Real operator()(Real vol) const {
+            evaluations_++;
+            // size of the model
+            Disposable<Array> params = model_->params();
+            if (fillUncalibrated_) {
+                for (Size i = index_; i < size_; i++)
+                    params[size_ + i] = vol;
+            } else {
+                params[size_ + index_] = vol;
+            }
+            model_->setParams(params);
+            Real npv = helper_->modelValue();
+            Volatility implied = swaptionImpliedVolatility(helper_, npv, 1e-6,
+                        1000, 1e-5, 1000);
+            std::cout << "Implied vol: " << implied
+                      << " black vol: " << helper_->volatility()->value()
+                      << " spot vol: " << vol
+                      << std::endl;
+            return implied - helper_->volatility()->value();
+        }
+
+    private:
+        ext::shared_ptr<GeneralizedHullWhite> &model_;
+        ext::shared_ptr<BlackCalibrationHelper> &helper_;
+        Size index_;
+        Size size_;
+        bool fillUncalibrated_;
+
+    public:
+        Size evaluations() const { return evaluations_; }
+
+    private:
+        mutable Size evaluations_;
+    };
+
+}
+
+ext::shared_ptr<GeneralizedHullWhite> buildGhw(
+            const Handle<YieldTermStructure> &yt,
+            const std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers,
+            Real speed) {
+    // one volatility piece per calibration helper: the first node on the
+    // evaluation date, then every helper expiry but the last, so that
+    // calibrateGhw solves piece i against helper i
+    std::vector<Date> dates(1, Settings::instance().evaluationDate());
+    for (Size i = 0; i + 1 < helpers.size() || dates.size() < 2; i++) {
+        ext::shared_ptr<SwaptionHelper> helper =
+                ext::dynamic_pointer_cast<SwaptionHelper>(helpers[i]);
+        dates.push_back(helper->swaption()->exercise()->date(0));
+    }
+    std::vector<Real> vols(dates.size(), 0.0073);
+    std::vector<Real> speeds(dates.size(), speed);
+    return ext::make_shared<GeneralizedHullWhite>(yt, dates, dates,
+                                                  speeds, vols);
+}
+
+ext::shared_ptr<Gsr> buildGsr(const Handle<YieldTermStructure> &yt,
+            const std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers,
+            Real speed) {
+    // one volatility step per calibration helper expiry
+    std::vector<Date> stepDates;
+    for (Size i = 0; i + 1 < helpers.size(); i++) {
+        ext::shared_ptr<SwaptionHelper> helper =
+                ext::dynamic_pointer_cast<SwaptionHelper>(helpers[i]);
+        stepDates.push_back(helper->swaption()->exercise()->date(0));
+    }
+    std::vector<Real> vols(stepDates.size() + 1, 0.0073);
+    return ext::make_shared<Gsr>(yt, stepDates, vols, speed);
+}
+
+Size calibrateGhw( ext::shared_ptr<GeneralizedHullWhite> &model,
+        std::vector<ext::shared_ptr<BlackCalibrationHelper> >& helpers,
+        bool fillUncalibrated, bool warmStart) {
+    // need to build a series of calibration helper.
+    // when calibrate the spot vol, the european swaption is assumed.
+    std::cout << "In calibrateGhw" << std::endl;
+
+    Size size = model->FixedReversion().size() / 2;
+    Size evaluations = 0;
+    for (Size i = 0; i < helpers.size(); i++) {
+        ghwBlackSolverImpl solver(model, helpers[i], i, fillUncalibrated);
+        std::cout << "solve " << i << std::endl;
+        if (warmStart) {
+            // previous solution as guess, tightened bracket around it
+            Real guess = model->params()[size + i];
+            try {
+                Brent wsolver;
+                wsolver.solve(solver, 1e-5, guess,
+                              std::max(0.001, 0.9 * guess),
+                              std::min(0.02, 1.1 * guess));
+                evaluations += solver.evaluations();
+                continue;
+            } catch (std::exception &e) {
+                std::cout << "Warm bracket failed, full bracket: "
+                          << e.what() << std::endl;
+            }
+        }
+        Bisection bsolver;
+        bsolver.solve(solver, 1e-5, 0.0015, 0.001, 0.02);
+        evaluations += solver.evaluations();
+    }
+
+    std::cout << "GHW calibrated." << std::endl;
+    return evaluations;
+}
+
+Size calibrateGsr(ext::shared_ptr<Gsr> &model,
+        std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers) {
+    // Gsr::calibrateVolatilitiesIterative(), counting
+    Size evaluations = 0;
+    LevenbergMarquardt om;
+    for (Size i = 0; i < helpers.size(); i++) {
+        std::vector<ext::shared_ptr<CalibrationHelperBase> > h(1, helpers[i]);
+        model->calibrate(h, om, EndCriteria(400, 100, 1.0e-8, 1.0e-8, 1.0e-8),
+                         Constraint(), std::vector<Real>(),
+                         model->MoveVolatility(i));
+        evaluations += model->functionEvaluation();
+    }
+    return evaluations;
+}
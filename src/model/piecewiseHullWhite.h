@@ -0,0 +1,44 @@
+/*
+ * Piecewise-volatility Hull-White models: GHW on a tree and Gsr.
+ */
+
+#ifndef PIECEWISE_HULL_WHITE_H
+#define PIECEWISE_HULL_WHITE_H
+
+#include <ql/experimental/shortrate/generalizedhullwhite.hpp>
+#include <ql/models/calibrationhelper.hpp>
+#include <ql/models/shortrate/onefactormodels/gsr.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+#include <vector>
+
+using namespace QuantLib;
+
+// one volatility piece per co-terminal helper, the first from the
+// evaluation date, with constant reversion speed
+ext::shared_ptr<GeneralizedHullWhite> buildGhw(
+            const Handle<YieldTermStructure> &yt,
+            const std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers,
+            Real speed);
+ext::shared_ptr<Gsr> buildGsr(const Handle<YieldTermStructure> &yt,
+            const std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers,
+            Real speed);
+
+/*
+ * Solves piece i of the GHW volatility against helper i in turn, on the
+ * helpers' engines.  With fillUncalibrated the later pieces take each
+ * solved value too; with warmStart the current parameters are tried as
+ * a guess in a narrow bracket first.  Returns the number of model
+ * evaluations.
+ */
+Size calibrateGhw(ext::shared_ptr<GeneralizedHullWhite> &model,
+        std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers,
+        bool fillUncalibrated, bool warmStart = false);
+
+// the Gsr volatility steps fitted one helper at a time, as
+// Gsr::calibrateVolatilitiesIterative(); returns the cost function
+// evaluations
+Size calibrateGsr(ext::shared_ptr<Gsr> &model,
+        std::vector<ext::shared_ptr<BlackCalibrationHelper> > &helpers);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Swaption engine refining a lattice engine until its price converges.
+ */
+
+#include "model/richardsonSwaptionEngine.h"
+
+#include <cmath>
+#include <iostream>
+
+RichardsonSwaptionEngine::RichardsonSwaptionEngine(
+            const Factory &factory, Size initialGrid, Size maxGrid,
+            Real tolerance, Real order)
+    : factory_(factory), initialGrid_(initialGrid), maxGrid_(maxGrid),
+      tolerance_(tolerance), order_(order) {
+    QL_REQUIRE(initialGrid_ > 0 && maxGrid_ >= 4 * initialGrid_,
+               "need room for at least three grids between "
+               << initialGrid_ << " and " << maxGrid_);
+    QL_REQUIRE(tolerance_ > 0.0, "non-positive tolerance given");
+}
+
+Real RichardsonSwaptionEngine::price(Size grid) const {
+    ext::shared_ptr<PricingEngine> &engine = engines_[grid];
+    if (!engine)
+        engine = factory_(grid);
+
+    Swaption::arguments *arguments =
+            dynamic_cast<Swaption::arguments *>(engine->getArguments());
+    QL_REQUIRE(arguments, "wrapped engine does not price swaptions");
+    *arguments = arguments_;
+    engine->reset();
+    engine->calculate();
+
+    const Swaption::results *results =
+            dynamic_cast<const Swaption::results *>(engine->getResults());
+    QL_REQUIRE(results && results->value != Null<Real>(),
+               "wrapped engine returned no value");
+    return results->value;
+}
+
+void RichardsonSwaptionEngine::calculate() const {
+    Real factor = std::pow(2.0, order_) - 1.0;
+
+    Size grid = initialGrid_;
+    Real coarse = price(grid);
+    Real extrapolated = Null<Real>(), change = Null<Real>();
+    while (2 * grid <= maxGrid_) {
+        grid *= 2;
+        Real fine = price(grid);
+        Real estimate = fine + (fine - coarse) / factor;
+        if (extrapolated != Null<Real>())
+            change = std::fabs(estimate - extrapolated);
+        extrapolated = estimate;
+        coarse = fine;
+        if (change != Null<Real>() && change < tolerance_)
+            break;
+    }
+
+    if (change == Null<Real>() || change >= tolerance_)
+        std::cout << "Grid not converged within " << tolerance_
+                  << " at size " << grid << std::endl;
+    else
+        std::cout << "Grid converged at size " << grid
+                  << " (change " << change << ")" << std::endl;
+
+    results_.value = extrapolated;
+    results_.additionalResults["gridSize"] = grid;
+    results_.additionalResults["extrapolationError"] = change;
+}
@@ -0,0 +1,46 @@
+/*
+ * Swaption engine refining a lattice engine until its price converges.
+ */
+
+#ifndef RICHARDSON_SWAPTION_ENGINE_H
+#define RICHARDSON_SWAPTION_ENGINE_H
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/pricingengine.hpp>
+
+#include <functional>
+#include <map>
+
+using namespace QuantLib;
+
+/*
+ * Prices with the wrapped tree or finite-difference engine at grid sizes
+ * n, 2n, 4n, ... and Richardson-extrapolates each consecutive pair
+ * assuming an error of order n^-order.  Refinement stops as soon as two
+ * consecutive extrapolated prices agree within the tolerance, or the
+ * maximum grid is reached, so deals that converge early never pay for
+ * the fine grids.
+ *
+ * The chosen grid size and the last extrapolation change are reported in
+ * the "gridSize" and "extrapolationError" additional results.
+ */
+class RichardsonSwaptionEngine
+    : public GenericEngine<Swaption::arguments, Swaption::results> {
+public:
+    typedef std::function<ext::shared_ptr<PricingEngine>(Size)> Factory;
+
+    RichardsonSwaptionEngine(const Factory &factory, Size initialGrid,
+                             Size maxGrid, Real tolerance,
+                             Real order = 1.0);
+    void calculate() const;
+
+private:
+    Real price(Size grid) const;
+
+    Factory factory_;
+    Size initialGrid_, maxGrid_;
+    Real tolerance_, order_;
+    mutable std::map<Size, ext::shared_ptr<PricingEngine> > engines_;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * Roll-down profile of a Bermudan swaption book over future dates.
+ */
+
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/settings.hpp>
+#include <ql/termstructures/yield/impliedtermstructure.hpp>
+
+#include "model/calibrationCache.h"
+#include "model/evaluationContext.h"
+#include "model/rollDown.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <thread>
+
+namespace {
+
+    // puts back the fixings of the indexes it saved on leaving the scope
+    class SavedFixings {
+    public:
+        ~SavedFixings() {
+            for (std::map<std::string, TimeSeries<Real> >::const_iterator
+                     it = saved_.begin(); it != saved_.end(); ++it)
+                IndexManager::instance().setHistory(it->first, it->second);
+        }
+        void save(const std::string &name) {
+            if (!saved_.count(name))
+                saved_[name] = IndexManager::instance().getHistory(name);
+        }
+    private:
+        std::map<std::string, TimeSeries<Real> > saved_;
+    };
+
+    // bootstraps the curve behind the handle and stops it following its
+    // helpers, which move with the evaluation date
+    Handle<YieldTermStructure> freeze(
+            const RelinkableHandle<YieldTermStructure> &curve) {
+        ext::shared_ptr<YieldTermStructure> base = curve.currentLink();
+        base->discount(0.0);
+        ext::shared_ptr<LazyObject> lazy =
+                ext::dynamic_pointer_cast<LazyObject>(base);
+        if (lazy)
+            lazy->freeze();
+        return Handle<YieldTermStructure>(base);
+    }
+
+}
+
+std::vector<Date> rollDownDates(const Date &from, const Date &to,
+                                const Period &step,
+                                const Calendar &calendar) {
+    QL_REQUIRE(from <= to, "roll-down from " << from << " after " << to);
+    QL_REQUIRE(step.length() > 0, "roll-down step " << step
+               << " not positive");
+    std::vector<Date> dates;
+    for (Integer n = 0; ; n++) {
+        Date d = calendar.adjust(from + n * step);
+        if (d > to)
+            break;
+        if (dates.empty() || d > dates.back())
+            dates.push_back(d);
+    }
+    return dates;
+}
+
+RollDownProfile rollDown(const ScenarioBook &book,
+                         const std::vector<Date> &dates,
+                         Size maxThreads) {
+    QL_REQUIRE(!dates.empty(), "no roll-down dates given");
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+
+    Size nDeals = book.deals.size();
+    Date last = *std::max_element(dates.begin(), dates.end());
+    Size nThreads = std::min(EvaluationContext::threads(maxThreads),
+                             dates.size());
+    EvaluationContext::prepare(nThreads);
+
+    RollDownProfile profile;
+    profile.dates = dates;
+    profile.prices.resize(dates.size());
+    std::atomic<Size> next(0);
+    std::vector<std::exception_ptr> errors(nThreads);
+
+    auto work = [&](Size worker) {
+        try {
+            EvaluationContext context;
+            CalibrationCache::ReadOnly readOnly;
+            // evaluation date and fixings as the context found them
+            SavedSettings savedSettings;
+            SavedFixings savedFixings;
+
+            // this worker's clone of the market and the book
+            ext::shared_ptr<SwaptionMarket> market = book.market();
+            std::vector<SwaptionDeal> deals;
+            for (Size j = 0; j < nDeals; j++)
+                deals.push_back(book.deals[j](*market));
+
+            // fixings up to the last date, off the base forwards
+            for (Size j = 0; j < nDeals; j++) {
+                const Leg &leg = deals[j].swap->floatingLeg();
+                for (Size i = 0; i < leg.size(); i++) {
+                    ext::shared_ptr<IborCoupon> coupon =
+                            ext::dynamic_pointer_cast<IborCoupon>(leg[i]);
+                    if (!coupon || coupon->fixingDate() < market->today ||
+                        coupon->fixingDate() >= last)
+                        continue;
+                    ext::shared_ptr<InterestRateIndex> index =
+                            coupon->index();
+                    savedFixings.save(index->name());
+                    index->addFixing(coupon->fixingDate(),
+                                     index->forecastFixing(
+                                             coupon->fixingDate()), true);
+                }
+            }
+
+            Handle<YieldTermStructure> baseDiscount =
+                    freeze(market->discountTermStructure);
+            Handle<YieldTermStructure> baseForecast =
+                    freeze(market->forecastTermStructure);
+
+            for (Size k = next++; k < dates.size(); k = next++) {
+                QL_REQUIRE(dates[k] >= market->today,
+                           "roll-down date " << dates[k]
+                           << " before the market date " << market->today);
+                Settings::instance().evaluationDate() = dates[k];
+                // anchored where the market's own curves are, two
+                // business days after the pricing date
+                Date settlement = market->calendar.advance(dates[k], 2, Days);
+                market->discountTermStructure.linkTo(
+                            ext::make_shared<ImpliedTermStructure>(
+                                        baseDiscount, settlement));
+                market->forecastTermStructure.linkTo(
+                            ext::make_shared<ImpliedTermStructure>(
+                                        baseForecast, settlement));
+
+                // the exercise dates still ahead; on the market date
+                // this leaves out only an exercise falling on it
+                auto value = [&]() {
+                    Real total = 0.0;
+                    for (Size j = 0; j < nDeals; j++) {
+                        std::vector<Date> ahead;
+                        const std::vector<Date> &exerciseDates =
+                                deals[j].exercise->dates();
+                        for (Size i = 0; i < exerciseDates.size(); i++)
+                            if (exerciseDates[i] > dates[k])
+                                ahead.push_back(exerciseDates[i]);
+                        if (ahead.empty())
+                            continue;
+
+                        SwaptionDeal rolled = deals[j];
+                        rolled.exercise.reset(new BermudanExercise(ahead));
+                        Swaption swaption(rolled.swap, rolled.exercise);
+                        swaption.setPricingEngine(
+                                    book.engine(*market, rolled, 1.0));
+                        total += swaption.NPV();
+                    }
+                    return total;
+                };
+                Real total = value();
+
+                // on the market date the rolled curves are the base
+                // ones, so the book must price as it does unrolled
+                if (dates[k] == market->today) {
+                    market->discountTermStructure.linkTo(
+                                baseDiscount.currentLink());
+                    market->forecastTermStructure.linkTo(
+                                baseForecast.currentLink());
+                    Real base = value();
+                    QL_ENSURE(std::fabs(total - base) <=
+                                  1.0e-6 * std::max(1.0, std::fabs(base)),
+                              "roll-down value " << total
+                              << " on the market date differs from the "
+                              << "base price " << base);
+                }
+                profile.prices[k] = total;
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (Size t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (Size t = 0; t < errors.size(); t++)
+        if (errors[t])
+            std::rethrow_exception(errors[t]);
+
+    std::cout << dates.size() << " roll-down dates on " << nThreads
+              << " workers in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+    return profile;
+}
@@ -0,0 +1,48 @@
+/*
+ * Roll-down profile of a Bermudan swaption book over future dates.
+ */
+
+#ifndef ROLL_DOWN_H
+#define ROLL_DOWN_H
+
+#include <ql/time/calendars/target.hpp>
+
+#include "model/scenarioBook.h"
+
+#include <vector>
+
+using namespace QuantLib;
+
+struct RollDownProfile {
+    std::vector<Date> dates;
+    // book value on each date, zero once every exercise date has passed
+    std::vector<Real> prices;
+};
+
+// from, from + step, from + 2 step, ... up to to, on business days
+std::vector<Date> rollDownDates(const Date &from, const Date &to,
+                                const Period &step = Period(1, Days),
+                                const Calendar &calendar = TARGET());
+
+/*
+ * Values the book on each date with the market rolled forward: the
+ * curves are bootstrapped once on the market date and frozen, and each
+ * date reads them through an ImpliedTermStructure anchored two
+ * business days after it, as the market's own curves are, so rates roll
+ * down the base forwards.  Vols are kept in expiry and tenor.  Floating
+ * fixings falling between the market date and a pricing date are taken
+ * off the base forward curve.  The models are recalibrated on each date
+ * to the exercise dates still ahead.
+ *
+ * A value on the market date is checked against the book priced on the
+ * base curves.
+ *
+ * Every date must be on or after the market date.  Workers run
+ * concurrently only with isolated evaluation contexts (see
+ * EvaluationContext); otherwise the run is serial.
+ */
+RollDownProfile rollDown(const ScenarioBook &book,
+                         const std::vector<Date> &dates,
+                         Size maxThreads = 0);
+
+#endif
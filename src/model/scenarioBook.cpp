@@ -0,0 +1,80 @@
+/*
+ * Market shocks and books shared by the scenario engines.
+ */
+
+#include "model/marketUpdate.h"
+#include "model/scenarioBook.h"
+
+namespace {
+
+    std::vector<Real> values(
+            const std::vector<ext::shared_ptr<SimpleQuote> > &quotes) {
+        std::vector<Real> v(quotes.size());
+        for (Size i = 0; i < quotes.size(); i++)
+            v[i] = quotes[i]->value();
+        return v;
+    }
+
+    void shift(MarketUpdate &update,
+               const std::vector<ext::shared_ptr<SimpleQuote> > &quotes,
+               const std::vector<Real> &base,
+               const std::vector<Real> &shifts, const char *group) {
+        if (shifts.empty())
+            return;
+        QL_REQUIRE(shifts.size() == quotes.size(),
+                   shifts.size() << " " << group << " shifts given for "
+                   << quotes.size() << " quotes");
+        for (Size i = 0; i < quotes.size(); i++)
+            update.set(quotes[i], base[i] + shifts[i]);
+    }
+
+}
+
+QuoteValues quoteValues(const MarketQuotes &quotes) {
+    QuoteValues v;
+    v.ois = values(quotes.ois);
+    v.deposits = values(quotes.deposits);
+    v.futures = values(quotes.futures);
+    v.swaps = values(quotes.swaps);
+    for (Size i = 0; i < quotes.vols.size(); i++)
+        v.vols.push_back(values(quotes.vols[i]));
+    return v;
+}
+
+void applyShock(const MarketQuotes &quotes, const QuoteValues &base,
+                const MarketShock &shock) {
+    MarketUpdate update;
+    shift(update, quotes.ois, base.ois, shock.ois, "OIS");
+    shift(update, quotes.deposits, base.deposits, shock.deposits, "deposit");
+    shift(update, quotes.futures, base.futures, shock.futures, "futures");
+    shift(update, quotes.swaps, base.swaps, shock.swaps, "swap");
+    if (!shock.vols.empty()) {
+        QL_REQUIRE(shock.vols.size() == quotes.vols.size(),
+                   shock.vols.size() << " vol shift rows given for "
+                   << quotes.vols.size() << " expiries");
+        for (Size i = 0; i < quotes.vols.size(); i++)
+            shift(update, quotes.vols[i], base.vols[i], shock.vols[i], "vol");
+    }
+    update.commit();
+}
+
+void applyQuotes(const MarketQuotes &quotes, const QuoteValues &values) {
+    MarketShock none;
+    none.ois.assign(values.ois.size(), 0.0);
+    none.deposits.assign(values.deposits.size(), 0.0);
+    none.futures.assign(values.futures.size(), 0.0);
+    none.swaps.assign(values.swaps.size(), 0.0);
+    for (Size i = 0; i < values.vols.size(); i++)
+        none.vols.push_back(std::vector<Real>(values.vols[i].size(), 0.0));
+    applyShock(quotes, values, none);
+}
+
+MarketShock rateShock(const MarketQuotes &quotes, Real shift) {
+    MarketShock shock;
+    shock.ois.assign(quotes.ois.size(), shift);
+    shock.deposits.assign(quotes.deposits.size(), shift);
+    // 100 minus the rate in percent
+    shock.futures.assign(quotes.futures.size(), -100.0 * shift);
+    shock.swaps.assign(quotes.swaps.size(), shift);
+    return shock;
+}
@@ -0,0 +1,55 @@
+/*
+ * Market shocks and books shared by the scenario engines.
+ */
+
+#ifndef SCENARIO_BOOK_H
+#define SCENARIO_BOOK_H
+
+#include <ql/pricingengine.hpp>
+
+#include "model/bermudanSwaption.h"
+
+#include <functional>
+#include <vector>
+
+using namespace QuantLib;
+
+// one value per quote of MarketQuotes, in quote units: rates and vols
+// decimal, futures in price points
+struct QuoteValues {
+    std::vector<Real> ois, deposits, futures, swaps;
+    std::vector<std::vector<Real> > vols;
+};
+
+// additive shifts; an empty vector leaves that group of quotes alone
+typedef QuoteValues MarketShock;
+
+QuoteValues quoteValues(const MarketQuotes &quotes);
+
+// sets every quote to its base value plus its shift, in one
+// MarketUpdate
+void applyShock(const MarketQuotes &quotes, const QuoteValues &base,
+                const MarketShock &shock);
+
+// sets the quotes to a snapshot, in one MarketUpdate; an empty vector
+// leaves that group of quotes alone
+void applyQuotes(const MarketQuotes &quotes, const QuoteValues &values);
+
+// parallel shift of every rate quote; futures prices move the other way
+MarketShock rateShock(const MarketQuotes &quotes, Real shift);
+
+/*
+ * A book as factories, so that every worker of a scenario run can build
+ * its own clone of the market, the deals and the engines in its own
+ * evaluation context.  The engine factory calibrates the model for a
+ * deal with the basket vols scaled by volScale, e.g.
+ * calibrateSwaptionEngine() with fixed model settings.
+ */
+struct ScenarioBook {
+    std::function<ext::shared_ptr<SwaptionMarket>()> market;
+    std::vector<std::function<SwaptionDeal(const SwaptionMarket &)> > deals;
+    std::function<ext::shared_ptr<PricingEngine>(
+            SwaptionMarket &, const SwaptionDeal &, Real volScale)> engine;
+};
+
+#endif
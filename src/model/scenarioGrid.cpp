@@ -0,0 +1,122 @@
+/*
+ * Rate shift by vol multiplier P&L grid of a Bermudan swaption book.
+ */
+
+#include <ql/instruments/swaption.hpp>
+
+#include "model/calibrationCache.h"
+#include "model/evaluationContext.h"
+#include "model/scenarioGrid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+std::vector<std::vector<Real> > scenarioGrid(
+        const ScenarioBook &book,
+        const std::vector<Real> &rateShifts,
+        const std::vector<Real> &volMultipliers,
+        bool recalibrate, const ScenarioCellCallback &onCell,
+        Size maxThreads) {
+    QL_REQUIRE(!rateShifts.empty(), "no rate shifts given");
+    QL_REQUIRE(!volMultipliers.empty(), "no vol multipliers given");
+    for (Size j = 0; j < volMultipliers.size(); j++)
+        QL_REQUIRE(volMultipliers[j] > 0.0,
+                   "vol multiplier " << volMultipliers[j] << " not positive");
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+
+    Size nRows = rateShifts.size(), nColumns = volMultipliers.size();
+    Size nDeals = book.deals.size();
+    Size nItems = recalibrate ? nRows : nColumns;
+    Size nThreads = std::min(EvaluationContext::threads(maxThreads), nItems);
+    EvaluationContext::prepare(nThreads);
+
+    std::vector<std::vector<Real> > grid(nRows,
+                                         std::vector<Real>(nColumns, 0.0));
+    std::mutex cellMutex;
+    std::atomic<Size> next(0);
+    std::vector<std::exception_ptr> errors(nThreads);
+
+    auto work = [&](Size worker) {
+        try {
+            EvaluationContext context;
+            CalibrationCache::ReadOnly readOnly;
+
+            // this worker's clone of the market and the book
+            ext::shared_ptr<SwaptionMarket> market = book.market();
+            QuoteValues base = quoteValues(market->quotes);
+            std::vector<SwaptionDeal> deals;
+            std::vector<ext::shared_ptr<Swaption> > swaptions;
+            Real baseTotal = 0.0;
+            for (Size j = 0; j < nDeals; j++) {
+                deals.push_back(book.deals[j](*market));
+                swaptions.push_back(ext::make_shared<Swaption>(
+                            deals[j].swap, deals[j].exercise));
+                swaptions[j]->setPricingEngine(
+                            book.engine(*market, deals[j], 1.0));
+                baseTotal += swaptions[j]->NPV();
+            }
+
+            auto setEngines = [&](Real volScale) {
+                for (Size j = 0; j < nDeals; j++)
+                    swaptions[j]->setPricingEngine(
+                                book.engine(*market, deals[j], volScale));
+            };
+            auto finish = [&](Size row, Size column) {
+                Real total = 0.0;
+                for (Size j = 0; j < nDeals; j++)
+                    total += swaptions[j]->NPV();
+                grid[row][column] = total - baseTotal;
+                if (onCell) {
+                    std::lock_guard<std::mutex> lock(cellMutex);
+                    onCell(row, column, grid[row][column]);
+                }
+            };
+
+            for (Size k = next++; k < nItems; k = next++) {
+                if (recalibrate) {
+                    applyShock(market->quotes, base,
+                               rateShock(market->quotes, rateShifts[k]));
+                    for (Size c = 0; c < nColumns; c++) {
+                        setEngines(volMultipliers[c]);
+                        finish(k, c);
+                    }
+                } else {
+                    // calibrated on the base curves
+                    applyShock(market->quotes, base,
+                               rateShock(market->quotes, 0.0));
+                    setEngines(volMultipliers[k]);
+                    for (Size r = 0; r < nRows; r++) {
+                        applyShock(market->quotes, base,
+                                   rateShock(market->quotes, rateShifts[r]));
+                        finish(r, k);
+                    }
+                }
+            }
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (Size t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (Size t = 0; t < errors.size(); t++)
+        if (errors[t])
+            std::rethrow_exception(errors[t]);
+
+    std::cout << nRows << "x" << nColumns << " scenario grid on " << nThreads
+              << " workers in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+    return grid;
+}
@@ -0,0 +1,41 @@
+/*
+ * Rate shift by vol multiplier P&L grid of a Bermudan swaption book.
+ */
+
+#ifndef SCENARIO_GRID_H
+#define SCENARIO_GRID_H
+
+#include "model/scenarioBook.h"
+
+#include <functional>
+#include <vector>
+
+using namespace QuantLib;
+
+// row, column and P&L of a finished cell
+typedef std::function<void(Size, Size, Real)> ScenarioCellCallback;
+
+/*
+ * Book P&L against the base market for every parallel rate shift (rows,
+ * decimal) and multiplier of the calibration basket vols (columns).
+ *
+ * With recalibrate set, a work item is a row: the curves rebootstrap
+ * once for the shift and the model is recalibrated for each multiplier.
+ * Otherwise a work item is a column: the model is calibrated once on the
+ * base curves with the scaled vols and keeps its parameters while the
+ * rates are shifted under it.
+ *
+ * onCell is called as each cell finishes, from the worker that priced
+ * it, one call at a time.  Workers run concurrently only with isolated
+ * evaluation contexts (see EvaluationContext); otherwise the run is
+ * serial.
+ */
+std::vector<std::vector<Real> > scenarioGrid(
+        const ScenarioBook &book,
+        const std::vector<Real> &rateShifts,
+        const std::vector<Real> &volMultipliers,
+        bool recalibrate = false,
+        const ScenarioCellCallback &onCell = ScenarioCellCallback(),
+        Size maxThreads = 0);
+
+#endif
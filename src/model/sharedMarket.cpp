@@ -0,0 +1,313 @@
+/*
+ * Host-wide publication of bootstrapped curves and calibrated model
+ * parameters in POSIX shared memory.
+ */
+
+#include <ql/errors.hpp>
+
+#include "model/curveNodes.h"
+#include "model/sharedMarket.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHARED_MARKET_MAGIC    0x52534d4bu
+#define SHARED_MARKET_VERSION  2
+#define SHARED_MARKET_KEY      128
+#define SHARED_MARKET_CURVES   16
+#define SHARED_MARKET_NODES    128
+#define SHARED_MARKET_MODELS   32
+#define SHARED_MARKET_PARAMS   64
+// seqlock retries before a reader gives up and bootstraps locally
+#define SHARED_MARKET_READ_TRIES 1000
+
+namespace {
+
+    enum SharedInterpolation {
+        SharedLinear = 1
+    };
+
+    struct SharedCurve {
+        char key[SHARED_MARKET_KEY];
+        std::uint64_t stamp;
+        std::int32_t referenceDate;
+        // dayCounterCode()
+        std::uint8_t dayCounter, interpolation;
+        std::uint32_t size;
+        std::int32_t dates[SHARED_MARKET_NODES];
+        double rates[SHARED_MARKET_NODES];
+    };
+
+    struct SharedParameters {
+        char key[SHARED_MARKET_KEY];
+        std::uint64_t stamp;
+        std::int32_t date;
+        std::uint32_t size;
+        double params[SHARED_MARKET_PARAMS];
+    };
+
+}
+
+struct SharedMarketSegment {
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t version;
+    // publishers' spin lock: the pid of the holder, 0 when free
+    std::atomic<std::uint32_t> writer;
+    // odd while a publisher writes
+    std::atomic<std::uint64_t> sequence;
+    std::uint64_t stamp;
+    SharedCurve curves[SHARED_MARKET_CURVES];
+    SharedParameters models[SHARED_MARKET_MODELS];
+};
+
+namespace {
+
+    // the segment's atomics have to work across processes
+    static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+                  "shared market needs lock-free atomics");
+
+    bool keyFits(const std::string &key) {
+        return key.size() < SHARED_MARKET_KEY;
+    }
+
+    // the slot holding key, else an empty one, else the stalest
+    template <class Slot>
+    Slot &slotFor(Slot *slots, Size n, const std::string &key) {
+        Slot *stalest = &slots[0];
+        for (Size i = 0; i < n; i++) {
+            if (key == slots[i].key)
+                return slots[i];
+            if (slots[i].stamp < stalest->stamp)
+                stalest = &slots[i];
+        }
+        return *stalest;
+    }
+
+    template <class Slot>
+    const Slot *find(const Slot *slots, Size n, const std::string &key) {
+        for (Size i = 0; i < n; i++)
+            if (slots[i].stamp != 0 &&
+                std::strncmp(slots[i].key, key.c_str(),
+                             SHARED_MARKET_KEY) == 0)
+                return &slots[i];
+        return NULL;
+    }
+
+    class Publication {
+    public:
+        explicit Publication(SharedMarketSegment *segment)
+        : segment_(segment) {
+            std::uint32_t self = std::uint32_t(::getpid());
+            std::uint32_t owner = 0;
+            while (!segment_->writer.compare_exchange_weak(owner, self,
+                        std::memory_order_acquire)) {
+                // a publisher that died holding the lock never frees it
+                if (owner != 0 && ::kill(pid_t(owner), 0) != 0 &&
+                    errno == ESRCH &&
+                    segment_->writer.compare_exchange_strong(owner, self,
+                        std::memory_order_acquire)) {
+                    recover(owner);
+                    break;
+                }
+                owner = 0;
+                std::this_thread::yield();
+            }
+            segment_->sequence.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            ++segment_->stamp;
+        }
+        ~Publication() {
+            segment_->sequence.fetch_add(1, std::memory_order_release);
+            segment_->writer.store(0, std::memory_order_release);
+        }
+    private:
+        // the dead publisher may have left a slot half written: drop
+        // every entry, which the readers rebuild, and end its write
+        void recover(std::uint32_t owner) {
+            if (segment_->sequence.load(std::memory_order_relaxed) % 2 == 0)
+                return;
+            std::memset(segment_->curves, 0, sizeof(segment_->curves));
+            std::memset(segment_->models, 0, sizeof(segment_->models));
+            segment_->sequence.fetch_add(1, std::memory_order_release);
+            std::cout << "Shared market cleared after publisher " << owner
+                      << " died writing" << std::endl;
+        }
+
+        SharedMarketSegment *segment_;
+    };
+
+    // copies slot out of the segment under the seqlock; false if absent,
+    // or if a publisher keeps writing (or died writing) meanwhile
+    template <class Slot>
+    bool readSlot(const SharedMarketSegment *segment, const Slot *slots,
+                  Size n, const std::string &key, Slot &copy) {
+        for (Size tries = 0; tries < SHARED_MARKET_READ_TRIES; tries++) {
+            std::uint64_t before =
+                    segment->sequence.load(std::memory_order_acquire);
+            if (before % 2 == 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const Slot *slot = find(slots, n, key);
+            if (slot)
+                std::memcpy(&copy, slot, sizeof(Slot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (segment->sequence.load(std::memory_order_relaxed) == before)
+                return slot != NULL;
+        }
+        return false;
+    }
+
+}
+
+SharedMarket *SharedMarket::host() {
+    static std::once_flag opened;
+    static SharedMarket *market = NULL;
+    std::call_once(opened, []() {
+        const char *name = std::getenv("RATES_SHARED_MARKET");
+        if (!name)
+            return;
+        try {
+            market = new SharedMarket(name);
+        } catch (std::exception &e) {
+            std::cout << "Shared market unavailable: " << e.what()
+                      << std::endl;
+        }
+    });
+    return market;
+}
+
+SharedMarket::SharedMarket(const std::string &name)
+: name_(name[0] == '/' ? name : "/" + name), segment_(NULL) {
+    bool created = true;
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        created = false;
+        fd = ::shm_open(name_.c_str(), O_RDWR, 0600);
+    }
+    QL_REQUIRE(fd >= 0, "cannot open shared market " << name_ << ": "
+               << std::strerror(errno));
+
+    if (created) {
+        QL_REQUIRE(::ftruncate(fd, sizeof(SharedMarketSegment)) == 0,
+                   "cannot size shared market " << name_ << ": "
+                   << std::strerror(errno));
+    } else {
+        // the creator may still be sizing it
+        struct stat status;
+        for (int i = 0; i < 100; i++) {
+            if (::fstat(fd, &status) == 0 &&
+                Size(status.st_size) >= sizeof(SharedMarketSegment))
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        QL_REQUIRE(Size(status.st_size) == sizeof(SharedMarketSegment),
+                   "shared market " << name_ << " has an unknown layout");
+    }
+
+    void *p = ::mmap(NULL, sizeof(SharedMarketSegment),
+                     PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    QL_REQUIRE(p != MAP_FAILED, "cannot map shared market " << name_
+               << ": " << std::strerror(errno));
+    segment_ = static_cast<SharedMarketSegment *>(p);
+
+    // a fresh segment is zero-filled; the magic number goes in last
+    if (created) {
+        segment_->version = SHARED_MARKET_VERSION;
+        segment_->magic.store(SHARED_MARKET_MAGIC, std::memory_order_release);
+    } else {
+        for (int i = 0; i < 100 && segment_->magic.load(
+                     std::memory_order_acquire) != SHARED_MARKET_MAGIC; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (segment_->magic.load(std::memory_order_acquire) !=
+                SHARED_MARKET_MAGIC ||
+            segment_->version != SHARED_MARKET_VERSION) {
+            ::munmap(segment_, sizeof(SharedMarketSegment));
+            QL_FAIL("shared market " << name_ << " has an unknown layout");
+        }
+    }
+    std::cout << (created ? "Created" : "Attached to") << " shared market "
+              << name_ << std::endl;
+}
+
+SharedMarket::~SharedMarket() {
+    ::munmap(segment_, sizeof(SharedMarketSegment));
+}
+
+bool SharedMarket::publishCurve(const std::string &key,
+                   const ext::shared_ptr<YieldTermStructure> &curve) {
+    CurveNodes nodes;
+    if (!keyFits(key) || !curveNodes(curve, nodes) ||
+        nodes.dates.size() > SHARED_MARKET_NODES)
+        return false;
+
+    Publication publication(segment_);
+    SharedCurve &slot = slotFor(segment_->curves, SHARED_MARKET_CURVES, key);
+    std::strncpy(slot.key, key.c_str(), SHARED_MARKET_KEY);
+    slot.stamp = segment_->stamp;
+    slot.referenceDate = std::int32_t(nodes.dates[0].serialNumber());
+    slot.dayCounter = std::uint8_t(dayCounterCode(nodes.dayCounter));
+    slot.interpolation = SharedLinear;
+    slot.size = std::uint32_t(nodes.dates.size());
+    for (Size i = 0; i < nodes.dates.size(); i++) {
+        slot.dates[i] = std::int32_t(nodes.dates[i].serialNumber());
+        slot.rates[i] = nodes.zeroRates[i];
+    }
+    return true;
+}
+
+ext::shared_ptr<YieldTermStructure> SharedMarket::readCurve(
+        const std::string &key) const {
+    SharedCurve copy;
+    if (!keyFits(key) ||
+        !readSlot(segment_, segment_->curves, SHARED_MARKET_CURVES, key, copy))
+        return ext::shared_ptr<YieldTermStructure>();
+    QL_REQUIRE(copy.interpolation == SharedLinear,
+               "unknown interpolation in shared curve " << key);
+
+    CurveNodes nodes;
+    nodes.dayCounter = codeDayCounter(copy.dayCounter);
+    nodes.zeroRates.assign(copy.rates, copy.rates + copy.size);
+    for (Size i = 0; i < copy.size; i++)
+        nodes.dates.push_back(Date(BigInteger(copy.dates[i])));
+    return nodesCurve(nodes);
+}
+
+void SharedMarket::publishParameters(const std::string &key,
+                                     const Date &date, const Array &params) {
+    if (!keyFits(key) || params.size() > SHARED_MARKET_PARAMS)
+        return;
+    Publication publication(segment_);
+    SharedParameters &slot =
+            slotFor(segment_->models, SHARED_MARKET_MODELS, key);
+    std::strncpy(slot.key, key.c_str(), SHARED_MARKET_KEY);
+    slot.stamp = segment_->stamp;
+    slot.date = std::int32_t(date.serialNumber());
+    slot.size = std::uint32_t(params.size());
+    std::copy(params.begin(), params.end(), slot.params);
+}
+
+bool SharedMarket::readParameters(const std::string &key, Date &date,
+                                  Array &params) const {
+    SharedParameters copy;
+    if (!keyFits(key) ||
+        !readSlot(segment_, segment_->models, SHARED_MARKET_MODELS, key, copy))
+        return false;
+    date = Date(BigInteger(copy.date));
+    params = Array(copy.params, copy.params + copy.size);
+    return true;
+}
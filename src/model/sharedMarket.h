@@ -0,0 +1,74 @@
+/*
+ * Host-wide publication of bootstrapped curves and calibrated model
+ * parameters in POSIX shared memory.
+ */
+
+#ifndef SHARED_MARKET_H
+#define SHARED_MARKET_H
+
+#include <ql/math/array.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+#include <ql/time/date.hpp>
+
+#include <string>
+
+using namespace QuantLib;
+
+struct SharedMarketSegment;
+
+/*
+ * One shared-memory segment per host, named by RATES_SHARED_MARKET, in
+ * which any pricing process publishes what it bootstrapped or
+ * calibrated and from which the others read it instead of redoing it.
+ *
+ * Curves are stored as their nodes: reference date, day counter,
+ * interpolation, and the node dates and continuous zero rates of the
+ * bootstrapped ZeroYield curve, rebuilt by readers as an
+ * InterpolatedZeroCurve.  Model parameters are stored per calibration
+ * cache key with their calibration date.
+ *
+ * Publishers take a spin lock in the segment among themselves and bump
+ * a sequence counter around each write, odd while writing.  Readers
+ * never lock: they copy what they need and retry if the counter moved
+ * or was odd meanwhile (a seqlock).  The copy is a few kilobytes; the
+ * objects rebuilt from it own their data, since the segment may change
+ * under them.  When the slots are full the least recently published
+ * entry is replaced.
+ *
+ * A publisher dying mid-write must not hang the host.  Readers give up
+ * after a bounded number of retries and the caller bootstraps or
+ * calibrates locally.  The lock holds the publisher's pid: the next
+ * publisher takes over the lock of a dead process, clears the slots it
+ * may have torn and closes its write.  (Robust process-shared mutexes
+ * would do this too, but are not available on macOS.)
+ */
+class SharedMarket {
+public:
+    // the host segment, or NULL without RATES_SHARED_MARKET; opened and
+    // created on first use
+    static SharedMarket *host();
+
+    explicit SharedMarket(const std::string &name);
+    ~SharedMarket();
+
+    // false, publishing nothing, for curves that are not linear zero
+    // curves on a known day counter
+    bool publishCurve(const std::string &key,
+                      const ext::shared_ptr<YieldTermStructure> &curve);
+    ext::shared_ptr<YieldTermStructure> readCurve(
+                      const std::string &key) const;
+
+    void publishParameters(const std::string &key, const Date &date,
+                           const Array &params);
+    bool readParameters(const std::string &key, Date &date,
+                        Array &params) const;
+
+private:
+    SharedMarket(const SharedMarket &);
+    SharedMarket &operator=(const SharedMarket &);
+
+    std::string name_;
+    SharedMarketSegment *segment_;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Imported swaption volatility surface.
+ */
+
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include "model/swaptionVolSurface.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+Period parseVolTenor(const std::string &label) {
+    std::string::size_type i = 0;
+    while (i < label.size() && std::isspace(label[i]))
+        i++;
+    std::string::size_type start = i;
+    while (i < label.size() && std::isdigit(label[i]))
+        i++;
+    QL_REQUIRE(i > start, "no length in tenor '" << label << "'");
+    Integer length = std::atoi(label.substr(start, i - start).c_str());
+    while (i < label.size() && std::isspace(label[i]))
+        i++;
+    QL_REQUIRE(i < label.size(), "no unit in tenor '" << label << "'");
+
+    switch (std::toupper(label[i])) {
+      case 'D':
+        return Period(length, Days);
+      case 'W':
+        return Period(length, Weeks);
+      case 'M':
+        return Period(length, Months);
+      case 'Y':
+        return Period(length, Years);
+      default:
+        QL_FAIL("unknown unit in tenor '" << label << "'");
+    }
+}
+
+ext::shared_ptr<SwaptionVolatilityMatrix> buildSwaptionVolMatrix(
+        const std::vector<std::string> &expiries,
+        const std::vector<std::string> &tenors,
+        const std::vector<std::vector<double> > &volSurface,
+        const Calendar &calendar,
+        std::vector<std::vector<ext::shared_ptr<SimpleQuote> > > *quotes) {
+    QL_REQUIRE(volSurface.size() == expiries.size(),
+               "vol surface has " << volSurface.size() << " rows, "
+               << expiries.size() << " expiries given");
+
+    std::vector<Period> optionTenors, swapTenors;
+    for (Size i = 0; i < expiries.size(); i++)
+        optionTenors.push_back(parseVolTenor(expiries[i]));
+    for (Size j = 0; j < tenors.size(); j++)
+        swapTenors.push_back(parseVolTenor(tenors[j]));
+
+    std::vector<std::vector<Handle<Quote> > > vols(expiries.size());
+    if (quotes)
+        quotes->assign(expiries.size(),
+                       std::vector<ext::shared_ptr<SimpleQuote> >());
+    for (Size i = 0; i < expiries.size(); i++) {
+        QL_REQUIRE(volSurface[i].size() == tenors.size(),
+                   "vol surface row " << i << " has " << volSurface[i].size()
+                   << " columns, " << tenors.size() << " tenors given");
+        for (Size j = 0; j < tenors.size(); j++) {
+            ext::shared_ptr<SimpleQuote> vol(
+                        new SimpleQuote(volSurface[i][j] / 100));
+            vols[i].push_back(Handle<Quote>(vol));
+            if (quotes)
+                (*quotes)[i].push_back(vol);
+        }
+    }
+
+    return ext::make_shared<SwaptionVolatilityMatrix>(
+            calendar, ModifiedFollowing, optionTenors, swapTenors, vols,
+            Actual365Fixed(), true);
+}
+
+SwaptionVolGrid::SwaptionVolGrid(
+            const ext::shared_ptr<SwaptionVolatilityMatrix> &matrix)
+    : matrix_(matrix), optionTimes_(matrix->optionTimes()),
+      swapLengths_(matrix->swapLengths()) {
+    // node values as the matrix itself interpolates them
+    Size m = optionTimes_.size(), n = swapLengths_.size();
+    std::vector<Real> nodes(m * n);
+    for (Size i = 0; i < m; i++)
+        for (Size j = 0; j < n; j++)
+            nodes[i * n + j] = matrix->volatility(optionTimes_[i],
+                                                  swapLengths_[j], 0.0, true);
+
+    // a single node on an axis degenerates to flat in that direction
+    Size rows = std::max<Size>(m - 1, 1), cols = std::max<Size>(n - 1, 1);
+    coefficients_.resize(4 * rows * cols);
+    for (Size i = 0; i < rows; i++) {
+        Size i1 = std::min(i + 1, m - 1);
+        Time t0 = optionTimes_[i], t1 = optionTimes_[i1];
+        for (Size j = 0; j < cols; j++) {
+            Size j1 = std::min(j + 1, n - 1);
+            Time s0 = swapLengths_[j], s1 = swapLengths_[j1];
+            Real v00 = nodes[i * n + j], v01 = nodes[i * n + j1];
+            Real v10 = nodes[i1 * n + j], v11 = nodes[i1 * n + j1];
+            Real ds = (s1 > s0 ? s1 - s0 : 1.0);
+            Real dt = (t1 > t0 ? t1 - t0 : 1.0);
+            // v = v00 + a (s - s0) + b (t - t0) + c (s - s0)(t - t0)
+            Real a = (v01 - v00) / ds, b = (v10 - v00) / dt;
+            Real c = (v11 - v10 - v01 + v00) / (ds * dt);
+            Real *k = &coefficients_[4 * (i * cols + j)];
+            k[0] = v00 - a * s0 - b * t0 + c * s0 * t0;
+            k[1] = a - c * t0;
+            k[2] = b - c * s0;
+            k[3] = c;
+        }
+    }
+}
+
+Size SwaptionVolGrid::locate(const std::vector<Time> &nodes, Real x) const {
+    if (nodes.size() < 2 || x <= nodes.front())
+        return 0;
+    if (x >= nodes.back())
+        return nodes.size() - 2;
+    return std::upper_bound(nodes.begin(), nodes.end(), x) - nodes.begin() - 1;
+}
+
+Volatility SwaptionVolGrid::volatility(Time optionTime,
+                                       Time swapLength) const {
+    // flat extrapolation
+    Time t = std::min(std::max(optionTime, optionTimes_.front()),
+                      optionTimes_.back());
+    Time s = std::min(std::max(swapLength, swapLengths_.front()),
+                      swapLengths_.back());
+    Size cols = std::max<Size>(swapLengths_.size() - 1, 1);
+    const Real *k = &coefficients_[4 * (locate(optionTimes_, t) * cols +
+                                        locate(swapLengths_, s))];
+    return k[0] + k[1] * s + k[2] * t + k[3] * s * t;
+}
+
+Volatility SwaptionVolGrid::volatility(const Period &optionTenor,
+                                       const Period &swapTenor) const {
+    return volatility(optionTime(optionTenor), swapLength(swapTenor));
+}
+
+void SwaptionVolGrid::volatilities(const std::vector<Time> &optionTimes,
+                                   const std::vector<Time> &swapLengths,
+                                   std::vector<Volatility> &vols) const {
+    QL_REQUIRE(optionTimes.size() == swapLengths.size(),
+               "option times and swap lengths differ in size");
+    vols.resize(optionTimes.size());
+    for (Size i = 0; i < optionTimes.size(); i++)
+        vols[i] = volatility(optionTimes[i], swapLengths[i]);
+}
+
+Time SwaptionVolGrid::optionTime(const Date &optionDate) const {
+    return matrix_->timeFromReference(optionDate);
+}
+
+Time SwaptionVolGrid::optionTime(const Period &optionTenor) const {
+    return matrix_->timeFromReference(
+            matrix_->optionDateFromTenor(optionTenor));
+}
+
+Time SwaptionVolGrid::swapLength(const Period &swapTenor) const {
+    return matrix_->swapLength(swapTenor);
+}
+
+Time SwaptionVolGrid::swapLength(const Date &start, const Date &end) const {
+    return matrix_->swapLength(start, end);
+}
@@ -0,0 +1,71 @@
+/*
+ * Imported swaption volatility surface.
+ */
+
+#ifndef SWAPTION_VOL_SURFACE_H
+#define SWAPTION_VOL_SURFACE_H
+
+#include <ql/quotes/simplequote.hpp>
+#include <ql/termstructures/volatility/swaption/swaptionvolmatrix.hpp>
+#include <ql/time/calendar.hpp>
+#include <ql/time/period.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace QuantLib;
+
+// "1 MO", "2 YR", "3M", "10Y", ... as in the VolSurface sheet headers
+Period parseVolTenor(const std::string &label);
+
+/*
+ * Lognormal swaption volatility matrix from the VolSurface sheet: rows
+ * are option expiries, columns swap tenors, values in percent.  The
+ * reference date floats with the evaluation date and the matrix is
+ * extrapolated flat.  The vols are quotes, returned in quotes if given,
+ * so that the surface can be shocked in place.
+ */
+ext::shared_ptr<SwaptionVolatilityMatrix> buildSwaptionVolMatrix(
+        const std::vector<std::string> &expiries,
+        const std::vector<std::string> &tenors,
+        const std::vector<std::vector<double> > &volSurface,
+        const Calendar &calendar,
+        std::vector<std::vector<ext::shared_ptr<SimpleQuote> > > *quotes
+                = NULL);
+
+/*
+ * The same bilinear, flat-extrapolated surface as a
+ * SwaptionVolatilityMatrix, but with the interpolation coefficients of
+ * every cell precomputed in one contiguous row-major table, so a lookup
+ * is a bucket search on each axis and four multiply-adds, without going
+ * through the term-structure machinery.  Only valid for the reference
+ * date the matrix had when the grid was built.
+ */
+class SwaptionVolGrid {
+public:
+    explicit SwaptionVolGrid(
+            const ext::shared_ptr<SwaptionVolatilityMatrix> &matrix);
+
+    Volatility volatility(Time optionTime, Time swapLength) const;
+    Volatility volatility(const Period &optionTenor,
+                          const Period &swapTenor) const;
+    // one volatility per (optionTimes[i], swapLengths[i])
+    void volatilities(const std::vector<Time> &optionTimes,
+                      const std::vector<Time> &swapLengths,
+                      std::vector<Volatility> &vols) const;
+
+    Time optionTime(const Date &optionDate) const;
+    Time optionTime(const Period &optionTenor) const;
+    Time swapLength(const Period &swapTenor) const;
+    Time swapLength(const Date &start, const Date &end) const;
+
+private:
+    Size locate(const std::vector<Time> &nodes, Real x) const;
+
+    ext::shared_ptr<SwaptionVolatilityMatrix> matrix_;
+    std::vector<Time> optionTimes_, swapLengths_;
+    // per cell: v = c0 + c1 s + c2 t + c3 s t, cell (i, j) at 4 (i n + j)
+    std::vector<Real> coefficients_;
+};
+
+#endif
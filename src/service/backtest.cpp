@@ -0,0 +1,231 @@
+/*
+ * Calibration backtest of reference deals over the market history.
+ */
+
+#include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/instruments/swaption.hpp>
+
+#include <QString>
+
+#include "model/calibrationCache.h"
+#include "model/evaluationContext.h"
+#include "service/backtest.h"
+#include "service/marketFeed.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+    QString fromUtf8(const std::string &s) {
+        return QString::fromUtf8(s.c_str());
+    }
+
+    std::string resultLine(const BacktestResult &result) {
+        std::ostringstream line;
+        line << std::setprecision(std::numeric_limits<double>::digits10 + 2)
+             << io::iso_date(result.date) << ',' << result.test << ',';
+        if (!result.ok) {
+            std::string error = result.error;
+            std::replace(error.begin(), error.end(), ',', ';');
+            std::replace(error.begin(), error.end(), '\n', ' ');
+            line << ",,,,,,,," << error << '\n';
+            return line.str();
+        }
+
+        const CalibrationReport &report = result.report;
+        Real sumSquares = 0.0, maxError = 0.0;
+        Size fitted = 0;
+        std::ostringstream errors;
+        errors << std::setprecision(6);
+        for (Size i = 0; i < report.modelVols.size(); i++) {
+            if (i > 0)
+                errors << ' ';
+            if (report.modelVols[i] == Null<Volatility>()) {
+                errors << "nan";
+                continue;
+            }
+            Real error = report.modelVols[i] - report.marketVols[i];
+            errors << error;
+            sumSquares += error * error;
+            maxError = std::max(maxError, std::fabs(error));
+            fitted++;
+        }
+
+        line << result.price << ',' << report.evaluations << ','
+             << report.milliseconds << ',' << result.milliseconds << ','
+             << (fitted > 0 ? std::sqrt(sumSquares / fitted) : 0.0) << ','
+             << maxError << ',';
+        for (Size i = 0; i < result.params.size(); i++)
+            line << (i > 0 ? " " : "") << result.params[i];
+        line << ',' << errors.str() << ",\n";
+        return line.str();
+    }
+
+}
+
+std::vector<BacktestResult> runBacktest(
+        const MarketHistory &history,
+        const std::vector<PricingRequest> &cases,
+        const Date &from, const Date &to,
+        const std::string &resultsFile, Size maxThreads) {
+    QL_REQUIRE(!cases.empty(), "no backtest cases given");
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+
+    std::vector<Date> dates;
+    std::vector<Date> all = history.dates();
+    for (Size i = 0; i < all.size(); i++)
+        if (all[i] >= from && all[i] <= to)
+            dates.push_back(all[i]);
+    QL_REQUIRE(!dates.empty(),
+               "no history between " << from << " and " << to);
+
+    // the 3M Libor fixes on the 3M deposit quote
+    std::vector<Date> fixingDates;
+    std::vector<double> fixings;
+    history.series(feedKey("DEPO", Period(3, Months)), Date::minDate(), to,
+                   fixingDates, fixings);
+
+    Size nThreads = std::min(EvaluationContext::threads(maxThreads),
+                             dates.size());
+    EvaluationContext::prepare(nThreads);
+
+    std::ofstream output;
+    if (!resultsFile.empty()) {
+        output.open(resultsFile.c_str());
+        QL_REQUIRE(output, "cannot open " << resultsFile);
+        output << "date,case,price,evaluations,calibration ms,total ms,"
+               << "rms vol error,max vol error,params,vol errors,error\n";
+    }
+    std::mutex outputMutex;
+
+    std::vector<BacktestResult> results(dates.size() * cases.size());
+    std::vector<std::exception_ptr> errors(nThreads);
+
+    auto work = [&](Size worker) {
+        try {
+            EvaluationContext context;
+            // built in the worker's context, not shared between contexts
+            USDLibor libor(Period(3, Months));
+            // the session's fixings, as its next user expects them
+            TimeSeries<Real> savedFixings =
+                    IndexManager::instance().getHistory(libor.name());
+            std::vector<CalibrationCache::Chain> chains(cases.size());
+            Size nextFixing = 0;
+
+            // one contiguous run of dates per worker
+            Size first = worker * dates.size() / nThreads;
+            Size last = (worker + 1) * dates.size() / nThreads;
+            for (Size d = first; d < last; d++) {
+                const Date &today = dates[d];
+                for (; nextFixing < fixingDates.size() &&
+                       fixingDates[nextFixing] < today; nextFixing++)
+                    if (libor.isValidFixingDate(fixingDates[nextFixing]))
+                        libor.addFixing(fixingDates[nextFixing],
+                                        fixings[nextFixing], true);
+
+                std::map<std::string, ext::shared_ptr<SwaptionMarket> >
+                        markets;
+                for (Size c = 0; c < cases.size(); c++) {
+                    std::chrono::steady_clock::time_point dealStart =
+                                std::chrono::steady_clock::now();
+                    BacktestResult &result = results[d * cases.size() + c];
+                    result.date = today;
+                    result.test = c;
+                    result.ok = false;
+                    result.price = 0.0;
+                    try {
+                        CalibrationCache::Chained chained(chains[c]);
+
+                        // buildSwaptionMarket() takes the quotes by
+                        // reference
+                        PricingRequest q = cases[c];
+                        history.snapshot(today, q);
+                        ext::shared_ptr<SwaptionMarket> &market =
+                                markets[marketKey(q)];
+                        if (!market)
+                            market = buildSwaptionMarket(q.today,
+                                    fromUtf8(q.curve), q.useExternalVolSurface,
+                                    q.volSurface, q.volExpiries, q.volTenors,
+                                    q.oisTenors, q.oisRates,
+                                    q.depositTenor, q.depositRate,
+                                    q.futuresMaturities, q.futuresPrices,
+                                    q.swapTenors, q.swapQuotes,
+                                    q.useGlobalBootstrap);
+                        Settings::instance().evaluationDate() = today;
+
+                        SwaptionDeal deal = buildSwaptionDeal(*market,
+                                    q.notional, q.effectiveDate,
+                                    q.maturityDate, q.changeFirstExerciseDate,
+                                    q.firstExerciseDate,
+                                    fromUtf8(q.fixedDirection), q.fixedCoupon,
+                                    fromUtf8(q.fixedPayFreq),
+                                    q.fixedDayCounter, fromUtf8(q.floatPayFreq),
+                                    fromUtf8(q.style));
+                        CalibrationState state;
+                        Swaption swaption(deal.swap, deal.exercise);
+                        swaption.setPricingEngine(calibrateSwaptionEngine(
+                                    *market, deal, fromUtf8(q.currency),
+                                    fromUtf8(q.model), fromUtf8(q.engine),
+                                    fromUtf8(q.complexity),
+                                    q.adaptiveGrid ? 1.0e-5 * q.notional : 0.0,
+                                    1.0, &state, &result.report));
+                        result.price = swaption.NPV();
+                        result.params = state.params;
+                        result.ok = true;
+                    } catch (std::exception &e) {
+                        result.error = e.what();
+                    }
+                    result.milliseconds =
+                            std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() -
+                                dealStart).count();
+
+                    if (output.is_open()) {
+                        std::string line = resultLine(result);
+                        std::lock_guard<std::mutex> lock(outputMutex);
+                        output << line;
+                    }
+                }
+            }
+
+            IndexManager::instance().setHistory(libor.name(), savedFixings);
+        } catch (...) {
+            errors[worker] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (Size t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (Size t = 0; t < errors.size(); t++)
+        if (errors[t])
+            std::rethrow_exception(errors[t]);
+
+    Size failed = 0;
+    for (Size i = 0; i < results.size(); i++)
+        if (!results[i].ok)
+            failed++;
+    std::cout << dates.size() << " dates x " << cases.size() << " cases on "
+              << nThreads << " workers in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start).count()
+              << " ms, " << failed << " failed" << std::endl;
+    return results;
+}
@@ -0,0 +1,63 @@
+/*
+ * Calibration backtest of reference deals over the market history.
+ */
+
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include "model/bermudanSwaption.h"
+#include "service/marketHistory.h"
+#include "service/pricingProtocol.h"
+
+#include <string>
+#include <vector>
+
+using namespace QuantLib;
+
+struct BacktestResult {
+    Date date;
+    // index of the case
+    Size test;
+    bool ok;
+    Real price;
+    Array params;
+    CalibrationReport report;
+    // deal set-up, calibration and NPV, and the bootstrap for the first
+    // case on a market
+    double milliseconds;
+    std::string error;
+};
+
+/*
+ * Reprices each case, a deal with its model and curve settings, on
+ * every date of the history in [from, to], recalibrating to the date's
+ * quotes; the quote fields of the cases are ignored.  Cases with the
+ * same curve settings share the date's market.
+ *
+ * The dates are split into one contiguous run per worker, walked in
+ * date order, so each case warm-starts from its parameters on the
+ * worker's previous date (see CalibrationCache::Chained); the first
+ * date of a run starts from the model defaults.  Libor fixings before
+ * each date are the history's 3M deposit quotes.
+ *
+ * If resultsFile is given, one line per date and case is appended as
+ * it finishes, in completion order:
+ *
+ *     date,case,price,evaluations,calibration ms,total ms,
+ *         rms vol error,max vol error,params,vol errors,error
+ *
+ * where params and the model minus market vol of each helper are
+ * space-separated; a failed date has only the error.  Results are
+ * returned by date, then case.
+ *
+ * Workers run concurrently only with isolated evaluation contexts (see
+ * EvaluationContext); otherwise the run is serial.
+ */
+std::vector<BacktestResult> runBacktest(
+        const MarketHistory &history,
+        const std::vector<PricingRequest> &cases,
+        const Date &from, const Date &to,
+        const std::string &resultsFile = std::string(),
+        Size maxThreads = 0);
+
+#endif
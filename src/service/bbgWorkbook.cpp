@@ -0,0 +1,178 @@
+/*
+ * Daily BBG workbooks: the vol surface, forward and OIS sheets.
+ */
+
+#include <OpenXLSX/OpenXLSX.h>
+
+#include <ql/errors.hpp>
+
+#include "service/bbgWorkbook.h"
+
+#include <cctype>
+#include <cstdlib>
+
+#define FORWARD_CURVE_TERM_IDX 0
+#define FORWARD_CURVE_UNIT_IDX 1
+#define FORWARD_CURVE_BID_IDX  8
+#define FORWARD_CURVE_ASK_IDX  9
+#define OIS_CURVE_TERM_IDX  0
+#define OIS_CURVE_UNIT_IDX  1
+#define OIS_CURVE_BID_IDX   3
+#define OIS_CURVE_ASK_IDX   4
+
+using namespace OpenXLSX;
+
+namespace {
+
+    template<typename T> void readColumn(
+            XLWorksheet &sheet, int columnIndex, int rowCount,
+            std::vector<T> &data) {
+        data.clear();
+        // skip header
+        for (int i = 1; i < rowCount; i++)
+            data.push_back(
+                    sheet.Cell(i + 1, columnIndex + 1).Value().Get<T>());
+    }
+
+    // the file name without its directory
+    std::string baseName(const std::string &filename) {
+        std::string::size_type slash = filename.find_last_of('/');
+        return filename.substr(slash == std::string::npos ? 0 : slash + 1);
+    }
+
+    bool bbgOisDiscounted(const std::string &filename) {
+        std::string name = baseName(filename);
+        for (Size i = 0; i < name.size(); i++)
+            name[i] = char(std::tolower(static_cast<unsigned char>(name[i])));
+        return name.find("oisblackvol") != std::string::npos;
+    }
+
+    double readNumber(XLWorksheet &sheet, int row, int column) {
+        try {
+            return sheet.Cell(row, column).Value().Get<double>();
+        } catch (XLException &) {
+            return sheet.Cell(row, column).Value().Get<int>();
+        }
+    }
+
+}
+
+BbgWorkbook readBbgWorkbook(const std::string &filename) {
+    XLDocument doc(filename);
+    XLWorkbook book = doc.Workbook();
+    BbgWorkbook workbook;
+    workbook.oisDiscounted = bbgOisDiscounted(filename);
+
+    // the first column is the row index and the first row is the col index
+    if (book.WorksheetExists("VolSurface")) {
+        XLWorksheet sheet = book.Worksheet("VolSurface");
+        int rowCount = sheet.RowCount();
+        int colCount = sheet.ColumnCount();
+        for (int j = 1; j < colCount; j++)
+            workbook.volTenors.push_back(
+                    sheet.Cell(1, j + 1).Value().Get<std::string>());
+        for (int i = 1; i < rowCount; i++) {
+            workbook.volExpiries.push_back(
+                    sheet.Cell(i + 1, 1).Value().Get<std::string>());
+            workbook.volSurface.push_back(std::vector<double>());
+            for (int j = 1; j < colCount; j++)
+                workbook.volSurface.back().push_back(
+                        readNumber(sheet, i + 1, j + 1));
+        }
+    }
+
+    if (book.WorksheetExists("Forward")) {
+        XLWorksheet forwards = book.Worksheet("Forward");
+        int rowCount = forwards.RowCount();
+        readColumn<int>(forwards, FORWARD_CURVE_TERM_IDX, rowCount,
+                        workbook.forwardTerm);
+        readColumn<std::string>(forwards, FORWARD_CURVE_UNIT_IDX, rowCount,
+                                workbook.forwardUnit);
+        readColumn<double>(forwards, FORWARD_CURVE_BID_IDX, rowCount,
+                           workbook.forwardBid);
+        readColumn<double>(forwards, FORWARD_CURVE_ASK_IDX, rowCount,
+                           workbook.forwardAsk);
+    }
+
+    if (book.WorksheetExists("OIS")) {
+        XLWorksheet ois = book.Worksheet("OIS");
+        int rowCount = ois.RowCount();
+        readColumn<int>(ois, OIS_CURVE_TERM_IDX, rowCount, workbook.oisTerm);
+        readColumn<std::string>(ois, OIS_CURVE_UNIT_IDX, rowCount,
+                                workbook.oisUnit);
+        readColumn<double>(ois, OIS_CURVE_BID_IDX, rowCount, workbook.oisBid);
+        readColumn<double>(ois, OIS_CURVE_ASK_IDX, rowCount, workbook.oisAsk);
+    }
+
+    doc.CloseDocument();
+    return workbook;
+}
+
+Date bbgWorkbookDate(const std::string &filename) {
+    // the last run of eight digits in the file name
+    std::string name = baseName(filename);
+    for (std::string::size_type end = name.size(); end >= 8; end--) {
+        std::string::size_type i = end - 8;
+        bool digits = true;
+        for (std::string::size_type k = i; k < end && digits; k++)
+            digits = std::isdigit(static_cast<unsigned char>(name[k])) != 0;
+        if (digits) {
+            int yyyymmdd = std::atoi(name.substr(i, 8).c_str());
+            return Date(Day(yyyymmdd % 100),
+                        Month((yyyymmdd % 10000) / 100),
+                        Year(yyyymmdd / 10000));
+        }
+    }
+    QL_FAIL("no yyyymmdd date in workbook name " << filename);
+}
+
+TimeUnit bbgTimeUnit(const std::string &unit) {
+    TimeUnit t = Years;
+    if (unit == "DY") {
+        t = Days;
+    } else if (unit == "WK") {
+        t = Weeks;
+    } else if (unit == "MO") {
+        t = Months;
+    }
+
+    return t;
+}
+
+void bbgOisQuotes(const BbgWorkbook &workbook,
+                  std::vector<Period> &oisTenors,
+                  std::vector<double> &oisRates) {
+    for (Size i = 0; i < workbook.oisTerm.size(); i++) {
+        oisTenors.push_back(Period(workbook.oisTerm[i],
+                                   bbgTimeUnit(workbook.oisUnit[i])));
+        oisRates.push_back(
+                0.5 * (workbook.oisBid[i] + workbook.oisAsk[i]) * 0.01);
+    }
+}
+
+void bbgForwardQuotes(const BbgWorkbook &workbook,
+                      Period &depositTenor, double &depositRate,
+                      std::vector<Date> &futuresMaturities,
+                      std::vector<double> &futuresPrices,
+                      std::vector<Period> &swapTenors,
+                      std::vector<double> &swapQuotes) {
+    for (Size i = 0; i < workbook.forwardTerm.size(); i++) {
+        double value =
+                0.5 * (workbook.forwardBid[i] + workbook.forwardAsk[i]) / 100;
+        if (i == 0) {
+            depositTenor = Period(workbook.forwardTerm[i],
+                                  bbgTimeUnit(workbook.forwardUnit[i]));
+            depositRate = value;
+        } else if (workbook.forwardUnit[i] == "ACTDATE") {
+            int dnum = workbook.forwardTerm[i];
+            futuresMaturities.push_back(Date(Day(dnum % 100),
+                                             Month((dnum % 10000) / 100),
+                                             Year(dnum / 10000)));
+            futuresPrices.push_back(100 - value * 100);
+        } else {
+            swapTenors.push_back(Period(workbook.forwardTerm[i],
+                                        bbgTimeUnit(workbook.forwardUnit[i])));
+            swapQuotes.push_back(value);
+        }
+    }
+}
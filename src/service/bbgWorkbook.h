@@ -0,0 +1,60 @@
+/*
+ * Daily BBG workbooks: the vol surface, forward and OIS sheets.
+ */
+
+#ifndef BBG_WORKBOOK_H
+#define BBG_WORKBOOK_H
+
+#include <ql/time/date.hpp>
+#include <ql/time/period.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace QuantLib;
+
+// the sheets as quoted, vols and rates in percent; a sheet the workbook
+// lacks is left empty
+struct BbgWorkbook {
+    // an OIS-discounted vol surface, swaption_oisBlackVol_*.xlsx
+    bool oisDiscounted;
+
+    // VolSurface: expiries down, tenors across
+    std::vector<std::string> volExpiries, volTenors;
+    std::vector<std::vector<double> > volSurface;
+
+    // Forward: the deposit, then futures (unit ACTDATE, term yyyymmdd)
+    // and swaps
+    std::vector<int> forwardTerm;
+    std::vector<std::string> forwardUnit;
+    std::vector<double> forwardBid, forwardAsk;
+
+    // OIS
+    std::vector<int> oisTerm;
+    std::vector<std::string> oisUnit;
+    std::vector<double> oisBid, oisAsk;
+};
+
+BbgWorkbook readBbgWorkbook(const std::string &filename);
+
+// the date in a workbook name such as swaption_BlackVol_BBIR_20190716.xlsx.
+// Templates such as DepoFutureSwap_BbgTmplt.xlsx carry no date and keep
+// their quotes on 'BBG Tmplt' and 'Consolid Data' sheets instead; they
+// are not daily workbooks and fail here.
+Date bbgWorkbookDate(const std::string &filename);
+
+// DY, WK, MO, anything else is years
+TimeUnit bbgTimeUnit(const std::string &unit);
+
+// mid quotes as bootstrapIrTermStructure() takes them
+void bbgOisQuotes(const BbgWorkbook &workbook,
+                  std::vector<Period> &oisTenors,
+                  std::vector<double> &oisRates);
+void bbgForwardQuotes(const BbgWorkbook &workbook,
+                      Period &depositTenor, double &depositRate,
+                      std::vector<Date> &futuresMaturities,
+                      std::vector<double> &futuresPrices,
+                      std::vector<Period> &swapTenors,
+                      std::vector<double> &swapQuotes);
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Live marks of a Bermudan swaption book driven by a quote feed.
+ */
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/patterns/observable.hpp>
+#include <ql/settings.hpp>
+
+#include "model/evaluationContext.h"
+#include "model/marketUpdate.h"
+#include "service/liveMarks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+    // set when anything it watches notifies
+    class DirtyFlag : public Observer {
+    public:
+        DirtyFlag() : dirty(false) {}
+        void update() { dirty = true; }
+        bool dirty;
+    };
+
+    void addQuotes(const std::vector<std::string> &keys,
+                   const std::vector<ext::shared_ptr<SimpleQuote> > &quotes,
+                   std::vector<std::string> &names,
+                   std::vector<ext::shared_ptr<SimpleQuote> > &table) {
+        // quotes of a curve not built for this market are missing
+        if (keys.size() != quotes.size())
+            return;
+        names.insert(names.end(), keys.begin(), keys.end());
+        table.insert(table.end(), quotes.begin(), quotes.end());
+    }
+
+}
+
+LiveMarks::LiveMarks(const ScenarioBook &book, const FeedKeys &keys,
+                     const std::string &feedPath, bool recalibrate)
+: book_(book), keys_(keys), recalibrate_(recalibrate), feed_(feedPath) {}
+
+void LiveMarks::stop() {
+    feed_.stop();
+}
+
+void LiveMarks::run(const MarkCallback &onMark) {
+    EvaluationContext context;
+
+    ext::shared_ptr<SwaptionMarket> market = book_.market();
+    // the feed names quotes by their index in this table
+    std::vector<std::string> names;
+    std::vector<ext::shared_ptr<SimpleQuote> > quotes;
+    addQuotes(keys_.ois, market->quotes.ois, names, quotes);
+    addQuotes(keys_.deposits, market->quotes.deposits, names, quotes);
+    addQuotes(keys_.futures, market->quotes.futures, names, quotes);
+    addQuotes(keys_.swaps, market->quotes.swaps, names, quotes);
+    if (keys_.vols.size() == market->quotes.vols.size())
+        for (Size i = 0; i < keys_.vols.size(); i++)
+            addQuotes(keys_.vols[i], market->quotes.vols[i], names, quotes);
+
+    DirtyFlag curves, vols;
+    curves.registerWith(market->discountTermStructure);
+    curves.registerWith(market->forecastTermStructure);
+    if (market->volMatrix)
+        vols.registerWith(market->volMatrix);
+
+    std::vector<SwaptionDeal> deals;
+    std::vector<ext::shared_ptr<Swaption> > swaptions;
+    for (Size j = 0; j < book_.deals.size(); j++) {
+        deals.push_back(book_.deals[j](*market));
+        swaptions.push_back(ext::make_shared<Swaption>(
+                    deals[j].swap, deals[j].exercise));
+        swaptions[j]->setPricingEngine(book_.engine(*market, deals[j], 1.0));
+        onMark(j, swaptions[j]->NPV());
+    }
+
+    feed_.start(names);
+    std::map<Size, QuoteTick> ticks;
+    while (feed_.next(ticks)) {
+        std::chrono::steady_clock::time_point start =
+                    std::chrono::steady_clock::now();
+
+        // the quotes only change here, between valuations
+        curves.dirty = vols.dirty = false;
+        std::int64_t oldest = ticks.begin()->second.timestamp;
+        MarketUpdate update;
+        for (std::map<Size, QuoteTick>::const_iterator it = ticks.begin();
+             it != ticks.end(); ++it) {
+            // notifies only if the value changes
+            update.set(quotes[it->first], it->second.value);
+            oldest = std::min(oldest, it->second.timestamp);
+        }
+        update.commit();
+        if (!curves.dirty && !vols.dirty)
+            continue;
+
+        // the vol surface floats with the evaluation date
+        Settings::instance().evaluationDate() = market->today;
+        bool recalibrate = vols.dirty || (curves.dirty && recalibrate_);
+        for (Size j = 0; j < swaptions.size(); j++) {
+            if (recalibrate)
+                swaptions[j]->setPricingEngine(
+                            book_.engine(*market, deals[j], 1.0));
+            onMark(j, swaptions[j]->NPV());
+        }
+
+        std::int64_t now =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        std::cout << ticks.size() << " quotes, "
+                  << (curves.dirty ? "curves " : "")
+                  << (vols.dirty ? "vols " : "")
+                  << (recalibrate ? "recalibrated" : "repriced") << " in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - start).count()
+                  << " ms, " << (now - oldest) / 1000000
+                  << " ms after the oldest tick" << std::endl;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Live marks of a Bermudan swaption book driven by a quote feed.
+ */
+
+#ifndef LIVE_MARKS_H
+#define LIVE_MARKS_H
+
+#include "model/scenarioBook.h"
+#include "service/marketFeed.h"
+
+#include <functional>
+#include <string>
+
+using namespace QuantLib;
+
+// deal and its new mark
+typedef std::function<void(Size, Real)> MarkCallback;
+
+/*
+ * Applies each coalesced burst of ticks from the feed to the quotes of
+ * one market and remarks the book.  The quotes are only set by the
+ * pricing thread between valuations, so every valuation sees one whole
+ * burst.  Only what moved is redone:
+ *
+ * - curves rebootstrap lazily when one of their own quotes moved, so an
+ *   OIS tick leaves a single-curve market alone and a vol tick leaves
+ *   the curves alone;
+ * - models are recalibrated when a vol moved, or when a curve moved and
+ *   recalibrate is set; otherwise they keep their parameters and only
+ *   the NPV is redone on the new curves;
+ * - a burst that moves no quote, e.g. repeated values or quotes not in
+ *   the market, marks nothing.
+ *
+ * Ticks arriving while the book is remarked are coalesced into the next
+ * burst, so marks lag the feed by the recomputation they need.
+ */
+class LiveMarks {
+public:
+    LiveMarks(const ScenarioBook &book, const FeedKeys &keys,
+              const std::string &feedPath, bool recalibrate = true);
+
+    // marks the book on the current quotes, then on every burst until
+    // stop() is called
+    void run(const MarkCallback &onMark);
+    void stop();
+
+private:
+    ScenarioBook book_;
+    FeedKeys keys_;
+    bool recalibrate_;
+    MarketFeed feed_;
+};
+
+#endif
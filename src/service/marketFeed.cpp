@@ -0,0 +1,245 @@
+/*
+ * Streaming quote feed: ticks read from a named pipe or a tailed file.
+ */
+
+#include <ql/errors.hpp>
+#include <ql/utilities/dataparsers.hpp>
+
+#include "service/marketFeed.h"
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+std::string feedKey(const std::string &group, const Period &tenor) {
+    std::ostringstream key;
+    key << group << ' ' << io::short_period(tenor);
+    return key.str();
+}
+
+std::string feedKey(const std::string &group, const Date &maturity) {
+    std::ostringstream key;
+    key << group << ' ' << maturity.year() << '/'
+        << std::setw(2) << std::setfill('0') << Integer(maturity.month())
+        << '/' << std::setw(2) << std::setfill('0') << maturity.dayOfMonth();
+    return key.str();
+}
+
+bool parseTick(const std::string &line, std::string &key, double &value) {
+    std::istringstream in(line);
+    std::string group;
+    if (!(in >> group) || group[0] == '#')
+        return false;
+    for (Size i = 0; i < group.size(); i++)
+        group[i] = char(std::toupper(group[i]));
+
+    try {
+        std::string first, second;
+        if (group == "OIS" || group == "DEPO" || group == "SWAP") {
+            if (!(in >> first >> value))
+                return false;
+            key = feedKey(group, PeriodParser::parse(first));
+        } else if (group == "FUT") {
+            if (!(in >> first >> value))
+                return false;
+            key = feedKey(group, DateParser::parseFormatted(first,
+                                                            "%Y/%m/%d"));
+        } else if (group == "VOL") {
+            if (!(in >> first >> second >> value))
+                return false;
+            key = group + ' ' + first + ' ' + second;
+        } else {
+            return false;
+        }
+    } catch (std::exception &) {
+        // unparsable tenor or date
+        return false;
+    }
+
+    std::string rest;
+    return !(in >> rest);
+}
+
+FeedKeys feedKeys(const PricingRequest &request) {
+    FeedKeys keys;
+    // the OIS curve is only bootstrapped for dual-curve pricing; its
+    // quotes are then missing from MarketQuotes and the keys go unused
+    for (Size i = 0; i < request.oisTenors.size(); i++)
+        keys.ois.push_back(feedKey("OIS", request.oisTenors[i]));
+    keys.deposits.push_back(feedKey("DEPO", request.depositTenor));
+    for (Size i = 0; i < request.futuresMaturities.size(); i++)
+        keys.futures.push_back(feedKey("FUT", request.futuresMaturities[i]));
+    for (Size i = 0; i < request.swapTenors.size(); i++)
+        keys.swaps.push_back(feedKey("SWAP", request.swapTenors[i]));
+    if (request.useExternalVolSurface) {
+        for (Size i = 0; i < request.volExpiries.size(); i++) {
+            keys.vols.push_back(std::vector<std::string>());
+            for (Size j = 0; j < request.volTenors.size(); j++)
+                keys.vols[i].push_back("VOL " + request.volExpiries[i] +
+                                       ' ' + request.volTenors[j]);
+        }
+    }
+    return keys;
+}
+
+MarketFeed::MarketFeed(const std::string &path, Size capacity)
+: path_(path), fd_(-1), stopping_(false), ring_(capacity), sleeping_(false) {
+    wakeFds_[0] = wakeFds_[1] = -1;
+}
+
+MarketFeed::~MarketFeed() {
+    stop();
+    if (reader_.joinable())
+        reader_.join();
+    if (fd_ >= 0)
+        ::close(fd_);
+    for (Size i = 0; i < 2; i++)
+        if (wakeFds_[i] >= 0)
+            ::close(wakeFds_[i]);
+}
+
+void MarketFeed::start(const std::vector<std::string> &keys) {
+    for (Size i = 0; i < keys.size(); i++)
+        quotes_[keys[i]] = i;
+    // non-blocking, so that opening a pipe does not wait for a writer
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_NONBLOCK);
+    QL_REQUIRE(fd_ >= 0, "cannot open feed " << path_ << ": "
+               << std::strerror(errno));
+    // both ends non-blocking: a full pipe already holds a wake
+    QL_REQUIRE(::pipe(wakeFds_) == 0, "cannot create the feed wake pipe: "
+               << std::strerror(errno));
+    for (Size i = 0; i < 2; i++)
+        ::fcntl(wakeFds_[i], F_SETFL,
+                ::fcntl(wakeFds_[i], F_GETFL) | O_NONBLOCK);
+    reader_ = std::thread([this]() { read(); });
+    std::cout << "Reading ticks from " << path_ << std::endl;
+}
+
+void MarketFeed::stop() {
+    stopping_ = true;
+    if (wakeFds_[1] >= 0) {
+        char byte = 0;
+        ssize_t written = ::write(wakeFds_[1], &byte, 1);
+        (void)written;
+    }
+}
+
+bool MarketFeed::next(std::map<Size, QuoteTick> &ticks) {
+    ticks.clear();
+    for (;;) {
+        QuoteTick tick;
+        while (ring_.pop(tick))
+            ticks[tick.quote] = tick;
+        if (!ticks.empty())
+            return true;
+        if (stopping_)
+            return false;
+
+        // raised before the last look at the ring, which pairs with the
+        // reader's push and look at the flag in notify()
+        sleeping_.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring_.empty() && !stopping_) {
+            pollfd p;
+            p.fd = wakeFds_[0];
+            p.events = POLLIN;
+            p.revents = 0;
+            ::poll(&p, 1, -1);
+            char bytes[64];
+            while (::read(wakeFds_[0], bytes, sizeof(bytes)) > 0)
+                ;
+        }
+        sleeping_.store(false, std::memory_order_seq_cst);
+    }
+}
+
+void MarketFeed::notify() {
+    // the push must be visible before the flag is read, or a consumer
+    // going to sleep could miss both
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_seq_cst)) {
+        char byte = 0;
+        ssize_t written = ::write(wakeFds_[1], &byte, 1);
+        (void)written;
+    }
+}
+
+void MarketFeed::read() {
+    std::string buffer;
+    char chunk[4096];
+    // ticks the full ring had no room for, latest per quote
+    std::map<Size, QuoteTick> held;
+    while (!stopping_) {
+        if (!held.empty()) {
+            while (!held.empty() && ring_.push(held.begin()->second))
+                held.erase(held.begin());
+            notify();
+        }
+
+        pollfd p;
+        p.fd = fd_;
+        p.events = POLLIN;
+        p.revents = 0;
+        ::poll(&p, 1, held.empty() ? 100 : 1);
+
+        ssize_t got = ::read(fd_, chunk, sizeof(chunk));
+        if (got < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (got < 0) {
+            std::cout << "Feed read failed: " << std::strerror(errno)
+                      << std::endl;
+            break;
+        }
+        if (got == 0) {
+            // end of the file or no writer on the pipe: wait for more
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                                                held.empty() ? 50 : 1));
+            continue;
+        }
+
+        std::int64_t now =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        buffer.append(chunk, std::size_t(got));
+        std::string::size_type end;
+        bool pushed = false;
+        while ((end = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            std::string key;
+            QuoteTick tick;
+            if (!parseTick(line, key, tick.value)) {
+                if (line.find_first_not_of(" \t\r") != std::string::npos &&
+                    line[line.find_first_not_of(" \t\r")] != '#')
+                    std::cout << "Skipping tick \"" << line << "\""
+                              << std::endl;
+                continue;
+            }
+            std::map<std::string, Size>::const_iterator quote =
+                    quotes_.find(key);
+            if (quote == quotes_.end()) {
+                std::cout << "No quote for tick " << key << std::endl;
+                continue;
+            }
+            tick.quote = quote->second;
+            tick.timestamp = now;
+            // a held value would be older, and must not overwrite this one
+            if (held.empty() && ring_.push(tick))
+                pushed = true;
+            else
+                held[tick.quote] = tick;
+        }
+        if (pushed)
+            notify();
+    }
+    stop();
+}
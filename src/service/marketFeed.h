@@ -0,0 +1,100 @@
+/*
+ * Streaming quote feed: ticks read from a named pipe or a tailed file.
+ */
+
+#ifndef MARKET_FEED_H
+#define MARKET_FEED_H
+
+#include <ql/time/date.hpp>
+#include <ql/time/period.hpp>
+
+#include "service/pricingProtocol.h"
+#include "service/quoteRing.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace QuantLib;
+
+/*
+ * A tick is one text line, with rates and vols decimal and futures in
+ * price points:
+ *
+ *     OIS  <tenor>      <rate>
+ *     DEPO <tenor>      <rate>
+ *     FUT  <yyyy/mm/dd> <price>
+ *     SWAP <tenor>      <rate>
+ *     VOL  <expiry> <tenor> <vol>
+ *
+ * where VOL takes the labels of the imported surface.  Blank lines and
+ * lines starting with '#' are skipped.
+ */
+
+// the key of a quote as a tick names it
+std::string feedKey(const std::string &group, const Period &tenor);
+std::string feedKey(const std::string &group, const Date &maturity);
+
+// false if the line is not a tick; key is set as by feedKey()
+bool parseTick(const std::string &line, std::string &key, double &value);
+
+// keys of the quotes of MarketQuotes built on the request's inputs, in
+// the same order; vols only with the imported surface
+struct FeedKeys {
+    std::vector<std::string> ois, deposits, futures, swaps;
+    std::vector<std::vector<std::string> > vols;
+};
+
+FeedKeys feedKeys(const PricingRequest &request);
+
+/*
+ * Reads ticks on a thread of its own and hands them to one consumer
+ * thread through a QuoteRing, so the reader never waits on the
+ * consumer: while the ring is full it keeps the latest value per quote
+ * aside and pushes it once there is room.  The consumer takes
+ * everything pending at once, latest value per quote, between its
+ * valuations.
+ *
+ * The source is opened non-blocking and polled, so a pipe without a
+ * writer or a file at its end is waited on rather than closed; whatever
+ * replaces the file later only has to write tick lines into it.
+ */
+class MarketFeed {
+public:
+    explicit MarketFeed(const std::string &path, Size capacity = 4096);
+    ~MarketFeed();
+
+    // opens the source and starts reading ticks for the given quote
+    // keys, by index; throws if the source cannot be opened
+    void start(const std::vector<std::string> &keys);
+    void stop();
+
+    // consumer side: waits for ticks and takes them, latest per quote;
+    // false once the feed is stopped
+    bool next(std::map<Size, QuoteTick> &ticks);
+
+private:
+    MarketFeed(const MarketFeed &);
+    MarketFeed &operator=(const MarketFeed &);
+
+    void read();
+    void notify();
+
+    std::string path_;
+    int fd_;
+    std::atomic<bool> stopping_;
+    std::map<std::string, Size> quotes_;
+
+    QuoteRing ring_;
+    // wakes the consumer without a lock: it raises sleeping_ before its
+    // last look at the ring and blocks on the pipe, and the reader
+    // writes a byte into the pipe after a push only while sleeping_ is
+    // up.  A byte written early stays in the pipe, so no wake is lost.
+    std::atomic<bool> sleeping_;
+    int wakeFds_[2];
+    std::thread reader_;
+};
+
+#endif
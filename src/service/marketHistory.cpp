@@ -0,0 +1,481 @@
+/*
+ * Append-only columnar history of daily market quotes.
+ */
+
+#include <ql/errors.hpp>
+#include <ql/utilities/dataparsers.hpp>
+#include <ql/utilities/null.hpp>
+
+#include "service/marketFeed.h"
+#include "service/marketHistory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+    struct BatchRecord {
+        std::int32_t date;
+        std::uint32_t count;
+        std::uint64_t first;
+    };
+
+    // request.curve for dual-curve pricing
+    const char *const DUAL_CURVE = "双重曲线";
+
+}
+
+// a file of fixed-width records, mapped read-only and appended to
+class MappedColumn {
+public:
+    MappedColumn(const std::string &path, Size width)
+    : path_(path), width_(width), data_(NULL), size_(0), mapped_(0) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        QL_REQUIRE(fd_ >= 0, "cannot open " << path << ": "
+                   << std::strerror(errno));
+        struct stat status;
+        QL_REQUIRE(::fstat(fd_, &status) == 0, "cannot stat " << path);
+        size_ = Size(status.st_size);
+        // a record cut short by an append that did not finish
+        truncate(rows());
+    }
+
+    ~MappedColumn() {
+        if (data_)
+            ::munmap(data_, size_);
+        ::close(fd_);
+    }
+
+    Size rows() const { return size_ / width_; }
+
+    template <class T> const T *data() const {
+        return reinterpret_cast<const T *>(data_);
+    }
+
+    void truncate(Size rows) {
+        if (rows * width_ != size_) {
+            QL_REQUIRE(::ftruncate(fd_, off_t(rows * width_)) == 0,
+                       "cannot truncate " << path_ << ": "
+                       << std::strerror(errno));
+            size_ = rows * width_;
+        }
+        map();
+    }
+
+    void append(const void *records, Size rows) {
+        const char *p = static_cast<const char *>(records);
+        Size n = rows * width_, written = 0;
+        while (written < n) {
+            ssize_t w = ::pwrite(fd_, p + written, n - written,
+                                 off_t(size_ + written));
+            if (w < 0 && errno == EINTR)
+                continue;
+            QL_REQUIRE(w > 0, "cannot append to " << path_ << ": "
+                       << std::strerror(errno));
+            written += Size(w);
+        }
+        size_ += n;
+        map();
+    }
+
+private:
+    void map() {
+        if (data_)
+            ::munmap(data_, mapped_);
+        data_ = NULL;
+        mapped_ = size_;
+        if (size_ == 0)
+            return;
+        void *p = ::mmap(NULL, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        QL_REQUIRE(p != MAP_FAILED, "cannot map " << path_ << ": "
+                   << std::strerror(errno));
+        data_ = static_cast<char *>(p);
+    }
+
+    std::string path_;
+    Size width_;
+    int fd_;
+    char *data_;
+    Size size_, mapped_;
+};
+
+MarketHistory::MarketHistory(const std::string &directory)
+: directory_(directory) {
+    QL_REQUIRE(::mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST,
+               "cannot create " << directory << ": " << std::strerror(errno));
+
+    // keys up to the last complete line
+    std::string keysPath = directory + "/instruments";
+    std::string keys;
+    {
+        std::ifstream input(keysPath.c_str(), std::ios::binary);
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        keys = contents.str();
+    }
+    std::string::size_type complete = keys.rfind('\n');
+    complete = (complete == std::string::npos) ? 0 : complete + 1;
+    if (complete != keys.size()) {
+        QL_REQUIRE(::truncate(keysPath.c_str(), off_t(complete)) == 0,
+                   "cannot truncate " << keysPath);
+        keys.resize(complete);
+    }
+    std::istringstream lines(keys);
+    std::string key;
+    while (std::getline(lines, key))
+        instrument(key);
+    keys_.open(keysPath.c_str(), std::ios::binary | std::ios::app);
+    QL_REQUIRE(keys_, "cannot open " << keysPath);
+
+    dates_.reset(new MappedColumn(directory + "/date.col",
+                                  sizeof(std::int32_t)));
+    instruments_.reset(new MappedColumn(directory + "/instrument.col",
+                                        sizeof(std::uint32_t)));
+    values_.reset(new MappedColumn(directory + "/value.col",
+                                   sizeof(double)));
+    batches_.reset(new MappedColumn(directory + "/batch.col",
+                                    sizeof(BatchRecord)));
+
+    // rows past the last batch belong to an append that did not finish
+    Size committed = 0;
+    const BatchRecord *batches = batches_->data<BatchRecord>();
+    for (Size b = 0; b < batches_->rows(); b++) {
+        QL_REQUIRE(batches[b].first == committed,
+                   "batch " << b << " of " << directory << " out of sequence");
+        committed += batches[b].count;
+        byDate_[Date(BigInteger(batches[b].date))].push_back(b);
+    }
+    QL_REQUIRE(dates_->rows() >= committed &&
+               instruments_->rows() >= committed &&
+               values_->rows() >= committed,
+               "columns of " << directory << " shorter than their batches");
+    dates_->truncate(committed);
+    instruments_->truncate(committed);
+    values_->truncate(committed);
+
+    const std::uint32_t *ids = instruments_->data<std::uint32_t>();
+    for (Size i = 0; i < committed; i++)
+        QL_REQUIRE(ids[i] < parsed_.size(),
+                   "unknown instrument id " << ids[i] << " in " << directory);
+}
+
+MarketHistory::~MarketHistory() {}
+
+Size MarketHistory::instrument(const std::string &key) {
+    std::map<std::string, Size>::const_iterator it = ids_.find(key);
+    if (it != ids_.end())
+        return it->second;
+
+    Instrument parsed;
+    std::istringstream in(key);
+    std::string group, first, second;
+    QL_REQUIRE(in >> group >> first, "malformed instrument " << key);
+    if (group == "OIS" || group == "DEPO" || group == "SWAP") {
+        parsed.group = group == "OIS" ? Ois : group == "DEPO" ? Deposit : Swap;
+        parsed.tenor = PeriodParser::parse(first);
+    } else if (group == "FUT") {
+        parsed.group = Future;
+        parsed.maturity = DateParser::parseFormatted(first, "%Y/%m/%d");
+    } else if (group == "VOL" || group == "OISVOL") {
+        QL_REQUIRE(in >> second, "malformed instrument " << key);
+        parsed.group = group == "VOL" ? Vol : OisVol;
+        parsed.volExpiry = first;
+        parsed.volTenor = second;
+    } else {
+        QL_FAIL("unknown instrument " << key);
+    }
+
+    // only new keys are written; while opening, keys_ is not open yet
+    if (keys_.is_open())
+        keys_ << key << '\n';
+    parsed_.push_back(parsed);
+    ids_[key] = parsed_.size() - 1;
+    return parsed_.size() - 1;
+}
+
+void MarketHistory::append(const Date &date, const HistoryQuotes &quotes) {
+    QL_REQUIRE(!quotes.empty(), "no quotes to append on " << date);
+    Size n = quotes.size();
+    std::vector<std::int32_t> dates(n, std::int32_t(date.serialNumber()));
+    std::vector<std::uint32_t> ids(n);
+    std::vector<double> values(n);
+    for (Size i = 0; i < n; i++) {
+        ids[i] = std::uint32_t(instrument(quotes[i].first));
+        values[i] = quotes[i].second;
+    }
+    keys_.flush();
+    QL_REQUIRE(keys_, "cannot write the instruments of " << directory_);
+
+    BatchRecord batch;
+    batch.date = dates[0];
+    batch.count = std::uint32_t(n);
+    batch.first = dates_->rows();
+    dates_->append(&dates[0], n);
+    instruments_->append(&ids[0], n);
+    values_->append(&values[0], n);
+    batches_->append(&batch, 1);
+    byDate_[date].push_back(batches_->rows() - 1);
+}
+
+std::vector<Date> MarketHistory::dates() const {
+    std::vector<Date> result;
+    for (std::map<Date, std::vector<Size> >::const_iterator it =
+             byDate_.begin(); it != byDate_.end(); ++it)
+        result.push_back(it->first);
+    return result;
+}
+
+bool MarketHistory::snapshot(const Date &date,
+                             PricingRequest &request) const {
+    std::map<Date, std::vector<Size> >::const_iterator it =
+            byDate_.find(date);
+    if (it == byDate_.end())
+        return false;
+
+    // latest value per instrument, in the order first appended
+    const BatchRecord *batches = batches_->data<BatchRecord>();
+    const std::uint32_t *ids = instruments_->data<std::uint32_t>();
+    const double *values = values_->data<double>();
+    std::vector<Size> order;
+    std::unordered_map<Size, double> latest;
+    for (Size b = 0; b < it->second.size(); b++) {
+        const BatchRecord &batch = batches[it->second[b]];
+        for (Size r = batch.first; r < batch.first + batch.count; r++) {
+            if (latest.insert(std::make_pair(ids[r], values[r])).second)
+                order.push_back(ids[r]);
+            else
+                latest[ids[r]] = values[r];
+        }
+    }
+
+    std::ostringstream today;
+    today << date.year() << '/'
+          << std::setw(2) << std::setfill('0') << Integer(date.month()) << '/'
+          << std::setw(2) << std::setfill('0') << date.dayOfMonth();
+    request.today = today.str();
+    request.oisTenors.clear();
+    request.oisRates.clear();
+    request.futuresMaturities.clear();
+    request.futuresPrices.clear();
+    request.swapTenors.clear();
+    request.swapQuotes.clear();
+    request.volExpiries.clear();
+    request.volTenors.clear();
+    request.volSurface.clear();
+
+    // dual-curve pricing takes the OIS-discounted surface if the date has
+    // one, as isDualCurve() reads the curve
+    Group volGroup = Vol;
+    if (request.curve == DUAL_CURVE) {
+        for (Size k = 0; k < order.size() && volGroup == Vol; k++)
+            if (parsed_[order[k]].group == OisVol)
+                volGroup = OisVol;
+    }
+
+    for (Size k = 0; k < order.size(); k++) {
+        const Instrument &instrument = parsed_[order[k]];
+        double value = latest[order[k]];
+        switch (instrument.group) {
+          case Ois:
+            request.oisTenors.push_back(instrument.tenor);
+            request.oisRates.push_back(value);
+            break;
+          case Deposit:
+            request.depositTenor = instrument.tenor;
+            request.depositRate = value;
+            break;
+          case Future:
+            request.futuresMaturities.push_back(instrument.maturity);
+            request.futuresPrices.push_back(value);
+            break;
+          case Swap:
+            request.swapTenors.push_back(instrument.tenor);
+            request.swapQuotes.push_back(value);
+            break;
+          case Vol:
+          case OisVol: {
+            if (instrument.group != volGroup)
+                break;
+            std::vector<std::string> &expiries = request.volExpiries;
+            std::vector<std::string> &tenors = request.volTenors;
+            Size i = std::find(expiries.begin(), expiries.end(),
+                               instrument.volExpiry) - expiries.begin();
+            if (i == expiries.size()) {
+                expiries.push_back(instrument.volExpiry);
+                request.volSurface.push_back(
+                        std::vector<double>(tenors.size(), Null<Real>()));
+            }
+            Size j = std::find(tenors.begin(), tenors.end(),
+                               instrument.volTenor) - tenors.begin();
+            if (j == tenors.size()) {
+                tenors.push_back(instrument.volTenor);
+                for (Size row = 0; row < request.volSurface.size(); row++)
+                    request.volSurface[row].push_back(Null<Real>());
+            }
+            // the surface is quoted in percent
+            request.volSurface[i][j] = value * 100;
+            break;
+          }
+        }
+    }
+
+    for (Size i = 0; i < request.volSurface.size(); i++)
+        for (Size j = 0; j < request.volTenors.size(); j++)
+            QL_REQUIRE(request.volSurface[i][j] != Null<Real>(),
+                       "no " << request.volExpiries[i] << " into "
+                       << request.volTenors[j] << " vol on " << date);
+    return true;
+}
+
+void MarketHistory::series(const std::string &key,
+                           const Date &from, const Date &to,
+                           std::vector<Date> &dates,
+                           std::vector<double> &values) const {
+    dates.clear();
+    values.clear();
+    std::map<std::string, Size>::const_iterator it = ids_.find(key);
+    if (it == ids_.end())
+        return;
+
+    // later appends of a date override earlier ones
+    std::map<Date, double> found;
+    std::uint32_t id = std::uint32_t(it->second);
+    const std::int32_t *rowDates = dates_->data<std::int32_t>();
+    const std::uint32_t *ids = instruments_->data<std::uint32_t>();
+    const double *rowValues = values_->data<double>();
+    std::int32_t first = std::int32_t(from.serialNumber());
+    std::int32_t last = std::int32_t(to.serialNumber());
+    for (Size r = 0; r < instruments_->rows(); r++)
+        if (ids[r] == id && rowDates[r] >= first && rowDates[r] <= last)
+            found[Date(BigInteger(rowDates[r]))] = rowValues[r];
+
+    for (std::map<Date, double>::const_iterator f = found.begin();
+         f != found.end(); ++f) {
+        dates.push_back(f->first);
+        values.push_back(f->second);
+    }
+}
+
+HistoryQuotes workbookQuotes(const BbgWorkbook &workbook) {
+    HistoryQuotes quotes;
+
+    std::vector<Period> oisTenors;
+    std::vector<double> oisRates;
+    bbgOisQuotes(workbook, oisTenors, oisRates);
+    for (Size i = 0; i < oisTenors.size(); i++)
+        quotes.push_back(std::make_pair(feedKey("OIS", oisTenors[i]),
+                                        oisRates[i]));
+
+    if (!workbook.forwardTerm.empty()) {
+        Period depositTenor;
+        double depositRate;
+        std::vector<Date> futuresMaturities;
+        std::vector<double> futuresPrices;
+        std::vector<Period> swapTenors;
+        std::vector<double> swapQuotes;
+        bbgForwardQuotes(workbook, depositTenor, depositRate,
+                         futuresMaturities, futuresPrices,
+                         swapTenors, swapQuotes);
+        quotes.push_back(std::make_pair(feedKey("DEPO", depositTenor),
+                                        depositRate));
+        for (Size i = 0; i < futuresMaturities.size(); i++)
+            quotes.push_back(std::make_pair(
+                    feedKey("FUT", futuresMaturities[i]), futuresPrices[i]));
+        for (Size i = 0; i < swapTenors.size(); i++)
+            quotes.push_back(std::make_pair(feedKey("SWAP", swapTenors[i]),
+                                            swapQuotes[i]));
+    }
+
+    // the two surfaces of a date are kept apart
+    std::string volGroup = workbook.oisDiscounted ? "OISVOL " : "VOL ";
+    for (Size i = 0; i < workbook.volExpiries.size(); i++)
+        for (Size j = 0; j < workbook.volTenors.size(); j++)
+            quotes.push_back(std::make_pair(
+                    volGroup + workbook.volExpiries[i] + ' ' +
+                    workbook.volTenors[j],
+                    workbook.volSurface[i][j] / 100));
+    return quotes;
+}
+
+Size ingestBbgWorkbooks(MarketHistory &history,
+                        const std::vector<std::string> &files,
+                        Size maxThreads) {
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+    Size nThreads = maxThreads;
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    nThreads = std::max<Size>(1, std::min(nThreads, files.size()));
+
+    // parsed out of order, appended in the sorted order of the names so
+    // that a date appended twice always ends up with the same quotes
+    std::vector<std::string> sorted(files);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<Date> dates(sorted.size());
+    std::vector<HistoryQuotes> parsed(sorted.size());
+    // 1 once parsed, 2 once skipped
+    std::vector<char> done(sorted.size(), 0);
+    Size appended = 0;
+
+    std::atomic<Size> next(0), ingested(0);
+    std::mutex historyMutex;
+    auto work = [&]() {
+        for (Size k = next++; k < sorted.size(); k = next++) {
+            char status = 1;
+            try {
+                dates[k] = bbgWorkbookDate(sorted[k]);
+                parsed[k] = workbookQuotes(readBbgWorkbook(sorted[k]));
+            } catch (std::exception &e) {
+                std::lock_guard<std::mutex> lock(historyMutex);
+                std::cout << "Skipped " << sorted[k] << ": " << e.what()
+                          << std::endl;
+                status = 2;
+            }
+
+            // append whatever is now ready in order
+            std::lock_guard<std::mutex> lock(historyMutex);
+            done[k] = status;
+            for (; appended < sorted.size() && done[appended]; appended++) {
+                if (done[appended] == 2)
+                    continue;
+                try {
+                    history.append(dates[appended], parsed[appended]);
+                    ingested++;
+                } catch (std::exception &e) {
+                    std::cout << "Skipped " << sorted[appended] << ": "
+                              << e.what() << std::endl;
+                }
+                HistoryQuotes().swap(parsed[appended]);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (Size t = 1; t < nThreads; t++)
+        workers.push_back(std::thread(work));
+    work();
+    for (Size t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    std::cout << ingested << " of " << files.size() << " workbooks on "
+              << nThreads << " threads in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+    return ingested;
+}
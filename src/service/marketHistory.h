@@ -0,0 +1,112 @@
+/*
+ * Append-only columnar history of daily market quotes.
+ */
+
+#ifndef MARKET_HISTORY_H
+#define MARKET_HISTORY_H
+
+#include <ql/time/date.hpp>
+#include <ql/time/period.hpp>
+
+#include "service/bbgWorkbook.h"
+#include "service/pricingProtocol.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace QuantLib;
+
+// quotes keyed as by feedKey(), in tick units: rates and vols decimal,
+// futures in price points
+typedef std::vector<std::pair<std::string, double> > HistoryQuotes;
+
+class MappedColumn;
+
+/*
+ * A directory of fixed-width column files with one row per quote and
+ * date:
+ *
+ *     date.col        int32 serial date
+ *     instrument.col  uint32 instrument id
+ *     value.col       float64 value
+ *
+ * plus instruments, the keys by id, one per line, and batch.col with
+ * one record per append: int32 date, uint32 row count, uint64 first row.
+ * The columns are memory-mapped; a date's rows are located through the
+ * batches, one instrument's history by a scan of its column alone.
+ *
+ * An append writes new keys, then the rows, then the batch record, so a
+ * batch only exists once all of it is on disk; rows or keys left behind
+ * by an append that did not finish are cut off when the store is next
+ * opened.  Appending a date again overrides its earlier quotes.
+ *
+ * Reads may run concurrently with each other, but not with an append.
+ */
+class MarketHistory {
+public:
+    // opens the store, creating the directory if needed
+    explicit MarketHistory(const std::string &directory);
+    ~MarketHistory();
+
+    void append(const Date &date, const HistoryQuotes &quotes);
+
+    std::vector<Date> dates() const;
+
+    /*
+     * Sets the request's date and its quote and vol surface inputs to
+     * the date's quotes, in the order first appended and in the units
+     * buildSwaptionMarket() takes; the deal and model fields are left
+     * alone.  The surface is the OISVOL one for a dual-curve request if
+     * the date has it, the VOL one otherwise.  False if nothing was
+     * appended on the date.
+     */
+    bool snapshot(const Date &date, PricingRequest &request) const;
+
+    // one quote on the dates in [from, to] it was appended on
+    void series(const std::string &key, const Date &from, const Date &to,
+                std::vector<Date> &dates, std::vector<double> &values) const;
+
+private:
+    enum Group { Ois, Deposit, Future, Swap, Vol, OisVol };
+
+    // an instrument key, parsed once
+    struct Instrument {
+        Group group;
+        Period tenor;
+        Date maturity;
+        // the surface labels of a vol
+        std::string volExpiry, volTenor;
+    };
+
+    Size instrument(const std::string &key);
+
+    std::string directory_;
+    std::unique_ptr<MappedColumn> dates_, instruments_, values_, batches_;
+    std::ofstream keys_;
+    std::vector<Instrument> parsed_;
+    std::map<std::string, Size> ids_;
+    // batch records by date, in append order
+    std::map<Date, std::vector<Size> > byDate_;
+};
+
+// the workbook's quotes as history rows; an OIS-discounted surface is
+// keyed OISVOL rather than VOL
+HistoryQuotes workbookQuotes(const BbgWorkbook &workbook);
+
+/*
+ * Parses the workbooks on maxThreads threads, 0 for the hardware
+ * concurrency, and appends them on the dates in their names, in the
+ * sorted order of the names whatever order they are parsed in.
+ * Workbooks that cannot be read or dated, such as the undated
+ * DepoFutureSwap_BbgTmplt.xlsx template, are reported and skipped;
+ * returns the number appended.
+ */
+Size ingestBbgWorkbooks(MarketHistory &history,
+                        const std::vector<std::string> &files,
+                        Size maxThreads = 0);
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Client of the local pricing daemon.
+ */
+
+#include <ql/errors.hpp>
+
+#include "service/pricingClient.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+PricingClient::PricingClient(const std::string &socketPath) : fd_(-1) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    QL_REQUIRE(socketPath.size() < sizeof(address.sun_path),
+               "socket path too long: " << socketPath);
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    QL_REQUIRE(fd_ >= 0, "socket failed: " << std::strerror(errno));
+    if (::connect(fd_, reinterpret_cast<sockaddr *>(&address),
+                  sizeof(address)) != 0) {
+        int error = errno;
+        ::close(fd_);
+        fd_ = -1;
+        QL_FAIL("connect " << socketPath << " failed: "
+                << std::strerror(error));
+    }
+}
+
+PricingClient::~PricingClient() {
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+PricingResponse PricingClient::price(const PricingRequest &request) {
+    writeFrame(fd_, encodeRequest(request));
+    std::string payload;
+    QL_REQUIRE(readFrame(fd_, payload), "pricing daemon closed the connection");
+    return decodeResponse(payload);
+}
+
+std::vector<PricingResponse> PricingClient::priceBook(
+        const std::vector<PricingRequest> &requests,
+        double valueThreshold, double moneynessThreshold) {
+    writeFrame(fd_, encodeBookRequest(requests, valueThreshold,
+                                      moneynessThreshold));
+    std::string payload;
+    QL_REQUIRE(readFrame(fd_, payload), "pricing daemon closed the connection");
+    return decodeBookResponse(payload);
+}
@@ -0,0 +1,37 @@
+/*
+ * Client of the local pricing daemon.
+ */
+
+#ifndef PRICING_CLIENT_H
+#define PRICING_CLIENT_H
+
+#include "service/pricingProtocol.h"
+
+#include <string>
+#include <vector>
+
+/*
+ * One connection to the daemon, kept open across requests.  Connection
+ * and I/O failures throw; a pricing failure inside the daemon comes back
+ * as a response with ok unset.
+ */
+class PricingClient {
+public:
+    explicit PricingClient(const std::string &socketPath);
+    ~PricingClient();
+
+    PricingResponse price(const PricingRequest &request);
+    // PricingService::priceBook() in the daemon; a request the daemon
+    // cannot decode comes back as a single failed response
+    std::vector<PricingResponse> priceBook(
+            const std::vector<PricingRequest> &requests,
+            double valueThreshold = 0.01, double moneynessThreshold = 1.0);
+
+private:
+    PricingClient(const PricingClient &);
+    PricingClient &operator=(const PricingClient &);
+
+    int fd_;
+};
+
+#endif
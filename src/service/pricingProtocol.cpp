@@ -0,0 +1,450 @@
+/*
+ * Binary protocol of the local pricing daemon.
+ */
+
+#include <ql/errors.hpp>
+
+#include "service/pricingProtocol.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+    class Writer {
+    public:
+        void u8(std::uint8_t v) { buffer_.push_back(char(v)); }
+        void flag(bool v) { u8(v ? 1 : 0); }
+        void u32(std::uint32_t v) { raw(&v, sizeof(v)); }
+        void i32(std::int32_t v) { raw(&v, sizeof(v)); }
+        void f64(double v) { raw(&v, sizeof(v)); }
+        void str(const std::string &v) {
+            u32(std::uint32_t(v.size()));
+            buffer_.append(v);
+        }
+        void date(const Date &v) { i32(std::int32_t(v.serialNumber())); }
+        void period(const Period &v) {
+            i32(v.length());
+            u8(std::uint8_t(v.units()));
+        }
+        void f64s(const std::vector<double> &v) {
+            u32(std::uint32_t(v.size()));
+            if (!v.empty())
+                raw(&v[0], v.size() * sizeof(double));
+        }
+        void strs(const std::vector<std::string> &v) {
+            u32(std::uint32_t(v.size()));
+            for (Size i = 0; i < v.size(); i++)
+                str(v[i]);
+        }
+        void dates(const std::vector<Date> &v) {
+            u32(std::uint32_t(v.size()));
+            for (Size i = 0; i < v.size(); i++)
+                date(v[i]);
+        }
+        void periods(const std::vector<Period> &v) {
+            u32(std::uint32_t(v.size()));
+            for (Size i = 0; i < v.size(); i++)
+                period(v[i]);
+        }
+
+        const std::string &buffer() const { return buffer_; }
+
+    private:
+        void raw(const void *p, std::size_t n) {
+            buffer_.append(static_cast<const char *>(p), n);
+        }
+
+        std::string buffer_;
+    };
+
+    class Reader {
+    public:
+        explicit Reader(const std::string &buffer)
+        : p_(buffer.data()), end_(buffer.data() + buffer.size()) {}
+
+        std::uint8_t u8() {
+            need(1);
+            return std::uint8_t(*p_++);
+        }
+        bool flag() { return u8() != 0; }
+        std::uint32_t u32() { std::uint32_t v; raw(&v, sizeof(v)); return v; }
+        std::int32_t i32() { std::int32_t v; raw(&v, sizeof(v)); return v; }
+        double f64() { double v; raw(&v, sizeof(v)); return v; }
+        std::string str() {
+            std::uint32_t n = u32();
+            need(n);
+            std::string v(p_, n);
+            p_ += n;
+            return v;
+        }
+        Date date() { return Date(BigInteger(i32())); }
+        Period period() {
+            Integer n = i32();
+            return Period(n, TimeUnit(u8()));
+        }
+        std::vector<double> f64s() {
+            std::vector<double> v(count(sizeof(double)));
+            if (!v.empty())
+                raw(&v[0], v.size() * sizeof(double));
+            return v;
+        }
+        std::vector<std::string> strs() {
+            std::vector<std::string> v(count(sizeof(std::uint32_t)));
+            for (Size i = 0; i < v.size(); i++)
+                v[i] = str();
+            return v;
+        }
+        std::vector<Date> dates() {
+            std::vector<Date> v(count(sizeof(std::int32_t)));
+            for (Size i = 0; i < v.size(); i++)
+                v[i] = date();
+            return v;
+        }
+        std::vector<Period> periods() {
+            std::vector<Period> v(count(sizeof(std::int32_t) + 1));
+            for (Size i = 0; i < v.size(); i++)
+                v[i] = period();
+            return v;
+        }
+
+        // element count, checked against the bytes left before allocating
+        Size count(std::size_t minSize) {
+            std::uint32_t n = u32();
+            need(std::size_t(n) * minSize);
+            return n;
+        }
+
+        void finish() const {
+            QL_REQUIRE(p_ == end_, "trailing bytes in pricing message");
+        }
+
+    private:
+        void need(std::size_t n) const {
+            QL_REQUIRE(std::size_t(end_ - p_) >= n,
+                       "truncated pricing message");
+        }
+        void raw(void *v, std::size_t n) {
+            need(n);
+            std::memcpy(v, p_, n);
+            p_ += n;
+        }
+
+        const char *p_, *end_;
+    };
+
+    void writeMarket(Writer &w, const PricingRequest &r) {
+        w.str(r.today);
+        w.str(r.curve);
+        w.flag(r.useExternalVolSurface);
+        w.u32(std::uint32_t(r.volSurface.size()));
+        for (Size i = 0; i < r.volSurface.size(); i++)
+            w.f64s(r.volSurface[i]);
+        w.strs(r.volExpiries);
+        w.strs(r.volTenors);
+        w.periods(r.oisTenors);
+        w.f64s(r.oisRates);
+        w.period(r.depositTenor);
+        w.f64(r.depositRate);
+        w.dates(r.futuresMaturities);
+        w.f64s(r.futuresPrices);
+        w.periods(r.swapTenors);
+        w.f64s(r.swapQuotes);
+        w.flag(r.useGlobalBootstrap);
+    }
+
+    void readMarket(Reader &r, PricingRequest &q) {
+        q.today = r.str();
+        q.curve = r.str();
+        q.useExternalVolSurface = r.flag();
+        q.volSurface.resize(r.count(sizeof(std::uint32_t)));
+        for (Size i = 0; i < q.volSurface.size(); i++)
+            q.volSurface[i] = r.f64s();
+        q.volExpiries = r.strs();
+        q.volTenors = r.strs();
+        q.oisTenors = r.periods();
+        q.oisRates = r.f64s();
+        q.depositTenor = r.period();
+        q.depositRate = r.f64();
+        q.futuresMaturities = r.dates();
+        q.futuresPrices = r.f64s();
+        q.swapTenors = r.periods();
+        q.swapQuotes = r.f64s();
+        q.useGlobalBootstrap = r.flag();
+    }
+
+    void writeDeal(Writer &w, const PricingRequest &r) {
+        w.f64(r.notional);
+        w.str(r.effectiveDate);
+        w.str(r.maturityDate);
+        w.flag(r.changeFirstExerciseDate);
+        w.str(r.firstExerciseDate);
+        w.str(r.fixedDirection);
+        w.f64(r.fixedCoupon);
+        w.str(r.fixedPayFreq);
+        w.str(r.fixedDayCounter);
+        w.str(r.floatDirection);
+        w.str(r.floatIndex);
+        w.str(r.floatPayFreq);
+        w.str(r.floatDayCounter);
+        w.str(r.style);
+        w.str(r.position);
+        w.str(r.callFreq);
+    }
+
+    void readDeal(Reader &r, PricingRequest &q) {
+        q.notional = r.f64();
+        q.effectiveDate = r.str();
+        q.maturityDate = r.str();
+        q.changeFirstExerciseDate = r.flag();
+        q.firstExerciseDate = r.str();
+        q.fixedDirection = r.str();
+        q.fixedCoupon = r.f64();
+        q.fixedPayFreq = r.str();
+        q.fixedDayCounter = r.str();
+        q.floatDirection = r.str();
+        q.floatIndex = r.str();
+        q.floatPayFreq = r.str();
+        q.floatDayCounter = r.str();
+        q.style = r.str();
+        q.position = r.str();
+        q.callFreq = r.str();
+    }
+
+    void writeModel(Writer &w, const PricingRequest &r) {
+        w.str(r.currency);
+        w.str(r.model);
+        w.str(r.engine);
+        w.str(r.complexity);
+        w.flag(r.adaptiveGrid);
+    }
+
+    void readModel(Reader &r, PricingRequest &q) {
+        q.currency = r.str();
+        q.model = r.str();
+        q.engine = r.str();
+        q.complexity = r.str();
+        q.adaptiveGrid = r.flag();
+    }
+
+    void writeResponse(Writer &w, const PricingResponse &response) {
+        w.flag(response.ok);
+        w.f64(response.price);
+        w.flag(response.marketCached);
+        w.flag(response.engineCached);
+        w.f64(response.elapsedMilliseconds);
+        w.str(response.error);
+    }
+
+    PricingResponse readResponse(Reader &r) {
+        PricingResponse response;
+        response.ok = r.flag();
+        response.price = r.f64();
+        response.marketCached = r.flag();
+        response.engineCached = r.flag();
+        response.elapsedMilliseconds = r.f64();
+        response.error = r.str();
+        return response;
+    }
+
+}
+
+std::string encodeRequest(const PricingRequest &r) {
+    Writer w;
+    w.u8(PRICING_PROTOCOL_VERSION);
+    w.u8(PriceSwaptionRequest);
+    writeDeal(w, r);
+    writeModel(w, r);
+    writeMarket(w, r);
+    return w.buffer();
+}
+
+PricingRequest decodeRequest(const std::string &payload) {
+    Reader r(payload);
+    QL_REQUIRE(r.u8() == PRICING_PROTOCOL_VERSION,
+               "unsupported pricing protocol version");
+    QL_REQUIRE(r.u8() == PriceSwaptionRequest,
+               "unknown pricing message type");
+
+    PricingRequest q;
+    readDeal(r, q);
+    readModel(r, q);
+    readMarket(r, q);
+    r.finish();
+    return q;
+}
+
+std::string encodeResponse(const PricingResponse &response) {
+    Writer w;
+    writeResponse(w, response);
+    return w.buffer();
+}
+
+PricingResponse decodeResponse(const std::string &payload) {
+    Reader r(payload);
+    PricingResponse response = readResponse(r);
+    r.finish();
+    return response;
+}
+
+PricingMessage requestMessage(const std::string &payload) {
+    Reader r(payload);
+    QL_REQUIRE(r.u8() == PRICING_PROTOCOL_VERSION,
+               "unsupported pricing protocol version");
+    std::uint8_t type = r.u8();
+    QL_REQUIRE(type == PriceSwaptionRequest || type == PriceBookRequest,
+               "unknown pricing message type");
+    return PricingMessage(type);
+}
+
+std::string encodeBookRequest(const std::vector<PricingRequest> &requests,
+                              double valueThreshold,
+                              double moneynessThreshold) {
+    QL_REQUIRE(!requests.empty(), "no pricing requests given");
+    Writer w;
+    w.u8(PRICING_PROTOCOL_VERSION);
+    w.u8(PriceBookRequest);
+    w.u32(std::uint32_t(requests.size()));
+    for (Size i = 0; i < requests.size(); i++)
+        writeDeal(w, requests[i]);
+    writeModel(w, requests[0]);
+    writeMarket(w, requests[0]);
+    w.f64(valueThreshold);
+    w.f64(moneynessThreshold);
+    return w.buffer();
+}
+
+std::vector<PricingRequest> decodeBookRequest(const std::string &payload,
+                                              double &valueThreshold,
+                                              double &moneynessThreshold) {
+    Reader r(payload);
+    QL_REQUIRE(r.u8() == PRICING_PROTOCOL_VERSION,
+               "unsupported pricing protocol version");
+    QL_REQUIRE(r.u8() == PriceBookRequest,
+               "not a book pricing message");
+
+    // a deal is at least its notional, coupon and empty strings
+    std::vector<PricingRequest> requests(
+            r.count(2 * sizeof(double) + 13 * sizeof(std::uint32_t) + 1));
+    QL_REQUIRE(!requests.empty(), "empty book pricing message");
+    for (Size i = 0; i < requests.size(); i++)
+        readDeal(r, requests[i]);
+    PricingRequest shared;
+    readModel(r, shared);
+    readMarket(r, shared);
+    valueThreshold = r.f64();
+    moneynessThreshold = r.f64();
+    r.finish();
+
+    for (Size i = 0; i < requests.size(); i++) {
+        PricingRequest &q = requests[i];
+        q.currency = shared.currency;
+        q.model = shared.model;
+        q.engine = shared.engine;
+        q.complexity = shared.complexity;
+        q.adaptiveGrid = shared.adaptiveGrid;
+        q.today = shared.today;
+        q.curve = shared.curve;
+        q.useExternalVolSurface = shared.useExternalVolSurface;
+        q.volSurface = shared.volSurface;
+        q.volExpiries = shared.volExpiries;
+        q.volTenors = shared.volTenors;
+        q.oisTenors = shared.oisTenors;
+        q.oisRates = shared.oisRates;
+        q.depositTenor = shared.depositTenor;
+        q.depositRate = shared.depositRate;
+        q.futuresMaturities = shared.futuresMaturities;
+        q.futuresPrices = shared.futuresPrices;
+        q.swapTenors = shared.swapTenors;
+        q.swapQuotes = shared.swapQuotes;
+        q.useGlobalBootstrap = shared.useGlobalBootstrap;
+    }
+    return requests;
+}
+
+std::string encodeBookResponse(const std::vector<PricingResponse> &responses) {
+    Writer w;
+    w.u32(std::uint32_t(responses.size()));
+    for (Size i = 0; i < responses.size(); i++)
+        writeResponse(w, responses[i]);
+    return w.buffer();
+}
+
+std::vector<PricingResponse> decodeBookResponse(const std::string &payload) {
+    Reader r(payload);
+    std::vector<PricingResponse> responses(
+            r.count(2 * sizeof(double) + sizeof(std::uint32_t) + 3));
+    for (Size i = 0; i < responses.size(); i++)
+        responses[i] = readResponse(r);
+    r.finish();
+    return responses;
+}
+
+std::string marketKey(const PricingRequest &request) {
+    Writer w;
+    writeMarket(w, request);
+    return w.buffer();
+}
+
+std::string modelKey(const PricingRequest &request) {
+    Writer w;
+    writeModel(w, request);
+    // the grid tolerance is relative to the notional
+    if (request.adaptiveGrid)
+        w.f64(request.notional);
+    return w.buffer();
+}
+
+namespace {
+
+    bool readFully(int fd, char *p, std::size_t n) {
+        while (n > 0) {
+            ssize_t got = ::read(fd, p, n);
+            if (got < 0 && errno == EINTR)
+                continue;
+            QL_REQUIRE(got >= 0, "socket read failed: " << std::strerror(errno));
+            if (got == 0)
+                return false;
+            p += got;
+            n -= std::size_t(got);
+        }
+        return true;
+    }
+
+    void writeFully(int fd, const char *p, std::size_t n) {
+        while (n > 0) {
+            ssize_t sent = ::send(fd, p, n, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR)
+                continue;
+            QL_REQUIRE(sent >= 0,
+                       "socket write failed: " << std::strerror(errno));
+            p += sent;
+            n -= std::size_t(sent);
+        }
+    }
+
+}
+
+bool readFrame(int fd, std::string &payload) {
+    std::uint32_t size;
+    if (!readFully(fd, reinterpret_cast<char *>(&size), sizeof(size)))
+        return false;
+    QL_REQUIRE(size <= PRICING_MAX_FRAME,
+               "pricing frame of " << size << " bytes too large");
+    payload.resize(size);
+    QL_REQUIRE(size == 0 || readFully(fd, &payload[0], size),
+               "connection closed inside a pricing frame");
+    return true;
+}
+
+void writeFrame(int fd, const std::string &payload) {
+    QL_REQUIRE(payload.size() <= PRICING_MAX_FRAME,
+               "pricing frame of " << payload.size() << " bytes too large");
+    std::uint32_t size = std::uint32_t(payload.size());
+    std::string frame(reinterpret_cast<const char *>(&size), sizeof(size));
+    frame.append(payload);
+    writeFully(fd, frame.data(), frame.size());
+}
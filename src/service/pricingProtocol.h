@@ -0,0 +1,112 @@
+/*
+ * Binary protocol of the local pricing daemon.
+ */
+
+#ifndef PRICING_PROTOCOL_H
+#define PRICING_PROTOCOL_H
+
+#include <ql/time/date.hpp>
+#include <ql/time/period.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace QuantLib;
+
+/*
+ * Every message is a frame: a uint32 payload length followed by the
+ * payload, all in host byte order since both ends run on the same
+ * machine.  A request payload starts with the protocol version and the
+ * message type, then the fields of PricingRequest in declaration order;
+ * strings are a uint32 length and UTF-8 bytes, vectors a uint32 count and
+ * their elements, dates the serial number and periods length and units.
+ *
+ * A book request carries the deals of one market and model: the count
+ * and each deal's fields up to callFreq, then the model and market
+ * fields once, then the screening thresholds.  Its response is the
+ * count and one response per deal.
+ */
+const std::uint8_t PRICING_PROTOCOL_VERSION = 1;
+const std::uint32_t PRICING_MAX_FRAME = 64 * 1024 * 1024;
+
+enum PricingMessage {
+    PriceSwaptionRequest = 1,
+    PriceBookRequest = 2
+};
+
+// the arguments of priceSwaption(), Qt strings as UTF-8
+struct PricingRequest {
+    double notional;
+    std::string currency;
+    std::string effectiveDate, maturityDate;
+    bool changeFirstExerciseDate;
+    std::string firstExerciseDate;
+
+    std::string fixedDirection;
+    double fixedCoupon;
+    std::string fixedPayFreq, fixedDayCounter;
+
+    std::string floatDirection, floatIndex, floatPayFreq, floatDayCounter;
+
+    std::string style, position, callFreq;
+
+    std::string today;
+    std::string model, engine, complexity, curve;
+
+    bool useExternalVolSurface;
+    std::vector<std::vector<double> > volSurface;
+    std::vector<std::string> volExpiries, volTenors;
+
+    std::vector<Period> oisTenors;
+    std::vector<double> oisRates;
+    Period depositTenor;
+    double depositRate;
+    std::vector<Date> futuresMaturities;
+    std::vector<double> futuresPrices;
+    std::vector<Period> swapTenors;
+    std::vector<double> swapQuotes;
+
+    bool useGlobalBootstrap, adaptiveGrid;
+};
+
+struct PricingResponse {
+    bool ok;
+    double price;
+    // whether the curves and the calibrated model were already built
+    bool marketCached, engineCached;
+    double elapsedMilliseconds;
+    std::string error;
+};
+
+std::string encodeRequest(const PricingRequest &request);
+PricingRequest decodeRequest(const std::string &payload);
+std::string encodeResponse(const PricingResponse &response);
+PricingResponse decodeResponse(const std::string &payload);
+
+// the message type of a request payload, its version checked
+PricingMessage requestMessage(const std::string &payload);
+
+// the deals must share market and model; the market and model fields are
+// taken from the first one
+std::string encodeBookRequest(const std::vector<PricingRequest> &requests,
+                              double valueThreshold,
+                              double moneynessThreshold);
+std::vector<PricingRequest> decodeBookRequest(const std::string &payload,
+                                              double &valueThreshold,
+                                              double &moneynessThreshold);
+std::string encodeBookResponse(const std::vector<PricingResponse> &responses);
+std::vector<PricingResponse> decodeBookResponse(const std::string &payload);
+
+/*
+ * Cache keys: the encoded inputs the market (curves and surface) and the
+ * calibrated model depend on.
+ */
+std::string marketKey(const PricingRequest &request);
+std::string modelKey(const PricingRequest &request);
+
+// blocking frame I/O on a socket; readFrame returns false on a clean EOF
+bool readFrame(int fd, std::string &payload);
+void writeFrame(int fd, const std::string &payload);
+
+#endif
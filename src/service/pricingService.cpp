@@ -0,0 +1,333 @@
+/*
+ * Local pricing daemon: warm curves and calibrated models behind a
+ * Unix-domain socket.
+ */
+
+#include <ql/instruments/swaption.hpp>
+#include <ql/settings.hpp>
+
+#include <QString>
+
+#include "model/approximateSwaption.h"
+#include "service/pricingService.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+    QString fromUtf8(const std::string &s) {
+        return QString::fromUtf8(s.c_str());
+    }
+
+}
+
+ScenarioBook requestBook(const PricingRequest &request) {
+    return requestBook(std::vector<PricingRequest>(1, request));
+}
+
+ScenarioBook requestBook(const std::vector<PricingRequest> &requests) {
+    QL_REQUIRE(!requests.empty(), "no pricing requests given");
+    const PricingRequest &request = requests[0];
+    for (Size i = 1; i < requests.size(); i++)
+        QL_REQUIRE(marketKey(requests[i]) == marketKey(request) &&
+                   modelKey(requests[i]) == modelKey(request),
+                   "the deals of a book must share market and model");
+
+    ScenarioBook book;
+    book.market = [request]() {
+        // buildSwaptionMarket() takes the quotes by reference
+        PricingRequest q = request;
+        return buildSwaptionMarket(q.today, fromUtf8(q.curve),
+                    q.useExternalVolSurface,
+                    q.volSurface, q.volExpiries, q.volTenors,
+                    q.oisTenors, q.oisRates, q.depositTenor, q.depositRate,
+                    q.futuresMaturities, q.futuresPrices,
+                    q.swapTenors, q.swapQuotes, q.useGlobalBootstrap);
+    };
+    for (Size i = 0; i < requests.size(); i++) {
+        const PricingRequest &deal = requests[i];
+        book.deals.push_back([deal](const SwaptionMarket &m) {
+            return buildSwaptionDeal(m, deal.notional,
+                        deal.effectiveDate, deal.maturityDate,
+                        deal.changeFirstExerciseDate,
+                        deal.firstExerciseDate,
+                        fromUtf8(deal.fixedDirection), deal.fixedCoupon,
+                        fromUtf8(deal.fixedPayFreq), deal.fixedDayCounter,
+                        fromUtf8(deal.floatPayFreq), fromUtf8(deal.style));
+        });
+    }
+    book.engine = [request](SwaptionMarket &m, const SwaptionDeal &deal,
+                            Real volScale) {
+        return calibrateSwaptionEngine(m, deal,
+                    fromUtf8(request.currency), fromUtf8(request.model),
+                    fromUtf8(request.engine), fromUtf8(request.complexity),
+                    request.adaptiveGrid ? 1.0e-5 * request.notional : 0.0,
+                    volScale);
+    };
+    return book;
+}
+
+PricingService::PricingService(const std::string &socketPath, Size workers,
+                               Size maxMarkets)
+: socketPath_(socketPath), workers_(workers),
+  maxMarkets_(std::max<Size>(1, maxMarkets)), listenFd_(-1),
+  stopping_(false), clock_(0) {
+    if (workers_ == 0)
+        workers_ = std::max(1u, std::thread::hardware_concurrency());
+}
+
+PricingService::~PricingService() {
+    stop();
+    if (listenFd_ >= 0)
+        ::close(listenFd_);
+}
+
+void PricingService::run() {
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    QL_REQUIRE(listenFd_ >= 0, "socket failed: " << std::strerror(errno));
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    QL_REQUIRE(socketPath_.size() < sizeof(address.sun_path),
+               "socket path too long: " << socketPath_);
+    std::strcpy(address.sun_path, socketPath_.c_str());
+
+    // a socket file left over by a daemon that did not shut down
+    ::unlink(socketPath_.c_str());
+    QL_REQUIRE(::bind(listenFd_, reinterpret_cast<sockaddr *>(&address),
+                      sizeof(address)) == 0,
+               "bind " << socketPath_ << " failed: " << std::strerror(errno));
+    QL_REQUIRE(::listen(listenFd_, SOMAXCONN) == 0,
+               "listen failed: " << std::strerror(errno));
+
+    for (Size i = 0; i < workers_; i++)
+        pool_.push_back(std::thread([this]() { serve(); }));
+    std::cout << "Pricing daemon on " << socketPath_ << " with "
+              << workers_ << " workers" << std::endl;
+
+    while (!stopping_) {
+        int fd = ::accept(listenFd_, NULL, NULL);
+        if (fd < 0) {
+            if (!stopping_ && errno != EINTR)
+                std::cout << "accept failed: " << std::strerror(errno)
+                          << std::endl;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        connections_.push_back(fd);
+        queueReady_.notify_one();
+    }
+
+    queueReady_.notify_all();
+    for (Size i = 0; i < pool_.size(); i++)
+        pool_[i].join();
+    pool_.clear();
+    ::unlink(socketPath_.c_str());
+    std::cout << "Pricing daemon stopped" << std::endl;
+}
+
+void PricingService::stop() {
+    if (stopping_.exchange(true))
+        return;
+    // wakes up accept(); connections still open end on the client side
+    if (listenFd_ >= 0)
+        ::shutdown(listenFd_, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    queueReady_.notify_all();
+}
+
+void PricingService::serve() {
+    for (;;) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this]() {
+                    return stopping_ || !connections_.empty(); });
+            if (connections_.empty())
+                return;
+            fd = connections_.front();
+            connections_.pop_front();
+        }
+        handle(fd);
+        ::close(fd);
+    }
+}
+
+void PricingService::handle(int fd) {
+    try {
+        std::string payload;
+        while (!stopping_ && readFrame(fd, payload)) {
+            std::string answer;
+            bool book = false;
+            try {
+                book = requestMessage(payload) == PriceBookRequest;
+                if (book) {
+                    double valueThreshold, moneynessThreshold;
+                    std::vector<PricingRequest> requests = decodeBookRequest(
+                                payload, valueThreshold, moneynessThreshold);
+                    answer = encodeBookResponse(priceBook(requests,
+                                valueThreshold, moneynessThreshold));
+                } else {
+                    answer = encodeResponse(price(decodeRequest(payload)));
+                }
+            } catch (std::exception &e) {
+                // malformed request: answer, then drop the connection
+                PricingResponse response;
+                response.ok = false;
+                response.price = 0.0;
+                response.marketCached = response.engineCached = false;
+                response.elapsedMilliseconds = 0.0;
+                response.error = e.what();
+                writeFrame(fd, book ?
+                           encodeBookResponse(
+                               std::vector<PricingResponse>(1, response)) :
+                           encodeResponse(response));
+                return;
+            }
+            writeFrame(fd, answer);
+        }
+    } catch (std::exception &e) {
+        std::cout << "Pricing connection dropped: " << e.what() << std::endl;
+    }
+}
+
+PricingService::MarketEntry &PricingService::market(
+        const PricingRequest &request, bool &cached) {
+    std::string key = marketKey(request);
+    std::map<std::string, MarketEntry>::iterator it = markets_.find(key);
+    cached = (it != markets_.end());
+    if (!cached) {
+        if (markets_.size() >= maxMarkets_) {
+            std::map<std::string, MarketEntry>::iterator oldest =
+                    markets_.begin();
+            for (it = markets_.begin(); it != markets_.end(); ++it)
+                if (it->second.lastUse < oldest->second.lastUse)
+                    oldest = it;
+            markets_.erase(oldest);
+        }
+
+        // buildSwaptionMarket() takes the quotes by reference
+        PricingRequest q = request;
+        MarketEntry entry;
+        entry.market = buildSwaptionMarket(q.today, fromUtf8(q.curve),
+                    q.useExternalVolSurface,
+                    q.volSurface, q.volExpiries, q.volTenors,
+                    q.oisTenors, q.oisRates, q.depositTenor, q.depositRate,
+                    q.futuresMaturities, q.futuresPrices,
+                    q.swapTenors, q.swapQuotes, q.useGlobalBootstrap, true);
+        it = markets_.insert(std::make_pair(key, entry)).first;
+    }
+    it->second.lastUse = ++clock_;
+    return it->second;
+}
+
+PricingResponse PricingService::price(const PricingRequest &request) {
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+    PricingResponse response;
+    response.ok = false;
+    response.price = 0.0;
+    response.marketCached = response.engineCached = false;
+
+    try {
+        std::lock_guard<std::mutex> lock(quantLibMutex_);
+        MarketEntry &entry = market(request, response.marketCached);
+        SwaptionMarket &m = *entry.market;
+        // the vol surface floats with the evaluation date
+        Settings::instance().evaluationDate() = m.today;
+
+        SwaptionDeal deal = buildSwaptionDeal(m, request.notional,
+                    request.effectiveDate, request.maturityDate,
+                    request.changeFirstExerciseDate,
+                    request.firstExerciseDate,
+                    fromUtf8(request.fixedDirection), request.fixedCoupon,
+                    fromUtf8(request.fixedPayFreq), request.fixedDayCounter,
+                    fromUtf8(request.floatPayFreq), fromUtf8(request.style));
+        Swaption swaption(deal.swap, deal.exercise);
+
+        QString engine = fromUtf8(request.engine);
+        if (isApproximateEngine(engine) && m.volMatrix) {
+            Handle<SwaptionVolatilityStructure> vol(m.volMatrix);
+            response.price = haganBermudanValue(deal.swap, deal.exercise,
+                        m.discountTermStructure, vol);
+        } else {
+            // the calibration basket follows the exercise schedule
+            std::ostringstream key;
+            key << modelKey(request) << deal.maturity.serialNumber();
+            const std::vector<Date> &dates = deal.exercise->dates();
+            for (Size i = 0; i < dates.size(); i++)
+                key << ',' << dates[i].serialNumber();
+
+            ext::shared_ptr<PricingEngine> &pricingEngine =
+                    entry.engines[key.str()];
+            response.engineCached = bool(pricingEngine);
+            if (!pricingEngine)
+                pricingEngine = checkpointedSwaptionEngine(m, deal,
+                            fromUtf8(request.currency),
+                            fromUtf8(request.model), engine,
+                            fromUtf8(request.complexity),
+                            request.adaptiveGrid ?
+                                1.0e-5 * request.notional : 0.0);
+            swaption.setPricingEngine(pricingEngine);
+            response.price = swaption.NPV();
+        }
+        response.ok = true;
+    } catch (std::exception &e) {
+        response.error = e.what();
+    }
+
+    response.elapsedMilliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    std::cout << "Priced " << (response.ok ? "" : "(failed) ")
+              << response.price << " in " << response.elapsedMilliseconds
+              << " ms, market " << (response.marketCached ? "warm" : "cold")
+              << ", model " << (response.engineCached ? "warm" : "cold")
+              << std::endl;
+    return response;
+}
+
+std::vector<PricingResponse> PricingService::priceBook(
+        const std::vector<PricingRequest> &requests,
+        Real valueThreshold, Real moneynessThreshold) {
+    std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+    std::vector<PricingResponse> responses(requests.size());
+    for (Size i = 0; i < responses.size(); i++) {
+        responses[i].ok = false;
+        responses[i].price = 0.0;
+        responses[i].marketCached = responses[i].engineCached = false;
+    }
+
+    try {
+        // the book workers run in contexts of their own, but without
+        // isolated contexts the run is serial on this thread
+        std::lock_guard<std::mutex> lock(quantLibMutex_);
+        BookValuation valuation = priceSwaptionBook(requestBook(requests),
+                    valueThreshold, moneynessThreshold, workers_);
+        for (Size i = 0; i < responses.size(); i++) {
+            responses[i].ok = true;
+            responses[i].price = valuation.prices[i];
+        }
+        std::cout << "Priced a book of " << requests.size() << " deals, "
+                  << valuation.fullyPriced << " on the model" << std::endl;
+    } catch (std::exception &e) {
+        for (Size i = 0; i < responses.size(); i++)
+            responses[i].error = e.what();
+    }
+
+    double elapsed = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    for (Size i = 0; i < responses.size(); i++)
+        responses[i].elapsedMilliseconds = elapsed;
+    return responses;
+}
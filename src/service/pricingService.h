@@ -0,0 +1,91 @@
+/*
+ * Local pricing daemon: warm curves and calibrated models behind a
+ * Unix-domain socket.
+ */
+
+#ifndef PRICING_SERVICE_H
+#define PRICING_SERVICE_H
+
+#include <ql/pricingengine.hpp>
+
+#include "model/bermudanSwaption.h"
+#include "model/bookPricing.h"
+#include "model/scenarioBook.h"
+#include "service/pricingProtocol.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace QuantLib;
+
+// the request's deal and model settings as a one-deal scenario book;
+// the approximate engine has no model and is calibrated as the default
+ScenarioBook requestBook(const PricingRequest &request);
+// the same for several deals, which must share the market and the model
+ScenarioBook requestBook(const std::vector<PricingRequest> &requests);
+
+/*
+ * Owns the markets built by buildSwaptionMarket() and the engines
+ * calibrated on them, keyed by the encoded inputs, so only the first
+ * request on a market pays for the bootstrap and only the first on a
+ * model and exercise schedule pays for the calibration.
+ *
+ * Connections are served by a pool of workers; frame I/O and request
+ * decoding run concurrently, but QuantLib's evaluation date and observer
+ * graph are process-wide and not thread-safe, so the pricing itself is
+ * serialized on one lock.  With warm caches that section is the deal
+ * set-up and one model NPV.
+ */
+class PricingService {
+public:
+    // workers = 0 uses the hardware concurrency
+    PricingService(const std::string &socketPath, Size workers = 0,
+                   Size maxMarkets = 4);
+    ~PricingService();
+
+    // accepts connections until stop() is called
+    void run();
+    void stop();
+
+    // the same pricing, in process
+    PricingResponse price(const PricingRequest &request);
+    // a book on one market and model, screened off the vol surface: only
+    // the deals flagged by priceSwaptionBook() are priced on the model;
+    // also served for PriceBookRequest messages
+    std::vector<PricingResponse> priceBook(
+            const std::vector<PricingRequest> &requests,
+            Real valueThreshold = 0.01, Real moneynessThreshold = 1.0);
+
+private:
+    struct MarketEntry {
+        ext::shared_ptr<SwaptionMarket> market;
+        std::map<std::string, ext::shared_ptr<PricingEngine> > engines;
+        Size lastUse;
+    };
+
+    void serve();
+    void handle(int fd);
+    MarketEntry &market(const PricingRequest &request, bool &cached);
+
+    std::string socketPath_;
+    Size workers_, maxMarkets_;
+    int listenFd_;
+    std::atomic<bool> stopping_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueReady_;
+    std::deque<int> connections_;
+    std::vector<std::thread> pool_;
+
+    std::mutex quantLibMutex_;
+    std::map<std::string, MarketEntry> markets_;
+    Size clock_;
+};
+
+#endif
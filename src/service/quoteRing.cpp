@@ -0,0 +1,36 @@
+/*
+ * Lock-free single-producer, single-consumer ring of quote ticks.
+ */
+
+#include "service/quoteRing.h"
+
+QuoteRing::QuoteRing(Size capacity) : head_(0), tail_(0) {
+    Size size = 2;
+    while (size < capacity)
+        size *= 2;
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+bool QuoteRing::push(const QuoteTick &tick) {
+    Size tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+        return false;
+    slots_[tail & mask_] = tick;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool QuoteRing::pop(QuoteTick &tick) {
+    Size head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+        return false;
+    tick = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool QuoteRing::empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+}
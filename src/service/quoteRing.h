@@ -0,0 +1,54 @@
+/*
+ * Lock-free single-producer, single-consumer ring of quote ticks.
+ */
+
+#ifndef QUOTE_RING_H
+#define QUOTE_RING_H
+
+#include <ql/types.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using namespace QuantLib;
+
+struct QuoteTick {
+    // index of the quote in the consumer's table
+    Size quote;
+    double value;
+    // steady clock nanoseconds at receipt
+    std::int64_t timestamp;
+};
+
+/*
+ * One thread pushes, one other thread pops; neither ever waits for the
+ * other.  Each index is written by one side only and published with
+ * release/acquire ordering, so a popped tick is always complete.  The
+ * indexes sit on cache lines of their own so that the two sides do not
+ * contend on them.
+ */
+class QuoteRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit QuoteRing(Size capacity = 4096);
+
+    // producer side; false, leaving the ring alone, when it is full
+    bool push(const QuoteTick &tick);
+    // consumer side; false when the ring is empty
+    bool pop(QuoteTick &tick);
+    bool empty() const;
+
+private:
+    QuoteRing(const QuoteRing &);
+    QuoteRing &operator=(const QuoteRing &);
+
+    std::vector<QuoteTick> slots_;
+    Size mask_;
+    // next slot to pop, written by the consumer
+    alignas(64) std::atomic<Size> head_;
+    // next slot to push, written by the producer
+    alignas(64) std::atomic<Size> tail_;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include <QAction>
+#include <QColor>
 #include <QFileDialog>
 #include <QString>
 #include <QMenuBar>
@@ -6,29 +7,31 @@
 #include <QMessageBox>
 #include <QTableWidgetItem>
 
-#include <OpenXLSX/OpenXLSX.h>
-
 #include "widgets/mainWindow.h"
 #include "model/bermudanSwaption.h"
+#include "model/evaluationContext.h"
+#include "model/scenarioGrid.h"
+#include "service/bbgWorkbook.h"
+#include "service/liveMarks.h"
+#include "service/pricingClient.h"
+#include "service/pricingService.h"
 
 #include <ql/time/calendars/target.hpp>
 #include <ql/time/daycounters/thirty360.hpp>
 #include <ql/time/timeunit.hpp>
 #include <ql/utilities/dataparsers.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
-using namespace OpenXLSX;
-
-#define FORWARD_CURVE_TERM_IDX 0
-#define FORWARD_CURVE_UNIT_IDX 1
-#define FORWARD_CURVE_BID_IDX  8
-#define FORWARD_CURVE_ASK_IDX  9
-#define OIS_CURVE_TERM_IDX  0
-#define OIS_CURVE_UNIT_IDX  1
-#define OIS_CURVE_BID_IDX   3
-#define OIS_CURVE_ASK_IDX   4
+// scenario grid: 25bp steps to 100bp, 0.1 steps to 20% of the vols
+#define SCENARIO_RATE_STEPS 4
+#define SCENARIO_RATE_STEP  0.0025
+#define SCENARIO_VOL_STEPS  2
+#define SCENARIO_VOL_STEP   0.1
 
 Period OIS_TENORS[] = {
     Period( 1, Days ),  Period( 1, Weeks ),   Period( 2, Weeks ),
@@ -72,25 +75,20 @@ double SWAP_QUOTES[] = {
     0.019608, 0.020005, 0.020390, 0.020730, 0.021035, 0.021717,
     0.022360, 0.022591, 0.022665, 0.022498, 0.022188 };
 
-TimeUnit getTimeUnit(std::string tu) {
-    TimeUnit t = Years;
-    if (tu == "DY") {
-        t = Days;
-    } else if (tu == "WK") {
-        t = Weeks;
-    } else if (tu == "MO") {
-        t = Months;
-    }
-
-    return t;
-}
-
 int date2string(char *buffer, Date d) {
     return sprintf(buffer, "%d-%02d-%02d", d.year(), d.month(),
                 d.dayOfMonth());
 }
 
-RatesMainWindow::~RatesMainWindow() {}
+RatesMainWindow::RatesMainWindow()
+: scenarioTable_(NULL), scenarioScale_(0.0), scenarioRunning_(false),
+  liveNotional_(0.0) {}
+
+RatesMainWindow::~RatesMainWindow() {
+    stopFeed();
+    if (scenarioThread_.joinable())
+        scenarioThread_.join();
+}
 
 void RatesMainWindow::setupMenu() {
     QMenuBar *menuBar = this->menuBar();
@@ -106,10 +104,23 @@ void RatesMainWindow::setupMenu() {
     QAction *saveForecastAction = new QAction(QString::fromUtf8("保存远期曲线"), this);
     connect(saveForecastAction, SIGNAL(triggered()), this, SLOT(saveForecast()));
 
+    // rate by vol scenario grid
+    QAction *scenarioAction = new QAction(QString::fromUtf8("情景分析"), this);
+    connect(scenarioAction, SIGNAL(triggered()), this, SLOT(runScenarioGrid()));
+
+    // live marks off a quote feed
+    QAction *openFeedAction = new QAction(QString::fromUtf8("打开行情流"), this);
+    connect(openFeedAction, SIGNAL(triggered()), this, SLOT(openFeed()));
+    QAction *stopFeedAction = new QAction(QString::fromUtf8("停止行情流"), this);
+    connect(stopFeedAction, SIGNAL(triggered()), this, SLOT(stopFeed()));
+
     QMenu *fileMenu = menuBar->addMenu(QString::fromUtf8("文件"));
     fileMenu->addAction(openAction);
     fileMenu->addAction(saveOisAction);
     fileMenu->addAction(saveForecastAction);
+    fileMenu->addAction(scenarioAction);
+    fileMenu->addAction(openFeedAction);
+    fileMenu->addAction(stopFeedAction);
 }
 
 void RatesMainWindow::setVolTableWidget(QTableWidget *volTable) {
@@ -124,25 +135,25 @@ void RatesMainWindow::setForwardTableWidget(QTableWidget *forwardTable) {
     forwardCurveTable_ = forwardTable;
 }
 
+void RatesMainWindow::setScenarioTableWidget(QTableWidget *scenarioTable) {
+    scenarioTable_ = scenarioTable;
+}
+
 std::vector<std::string> RatesMainWindow::getRowIndex() {
-    return volRowIndex_;
+    return workbook_.volExpiries;
 }
 
 std::vector<std::string> RatesMainWindow::getColIndex() {
-    return volColIndex_;
+    return workbook_.volTenors;
 }
 
 std::vector<std::vector<double>> RatesMainWindow::getValue() {
-    return vol_;
+    return workbook_.volSurface;
 }
 
 void RatesMainWindow::getOisQuoteData(std::vector<Period> &oisTenors,
             std::vector<double> &oisRates) {
-    for (unsigned int i = 0; i < oisTerm_.size(); i++) {
-        Period p(oisTerm_[i], getTimeUnit(oisUnit_[i]));
-        oisTenors.push_back(p);
-        oisRates.push_back(0.5 * (oisBid_[i] + oisAsk_[i]) * 0.01);
-    }
+    bbgOisQuotes(workbook_, oisTenors, oisRates);
 }
 
 void RatesMainWindow::getForwardQuoteData(
@@ -151,100 +162,15 @@ void RatesMainWindow::getForwardQuoteData(
             std::vector<double> &futuresPrices,
             std::vector<Period> &swapTenors,
             std::vector<double> &swapQuotes) {
-    for (unsigned int i = 0; i < forwardTerm_.size(); i++) {
-        double value = 0.5 * (forwardBid_[i] + forwardAsk_[i]) / 100;
-        if (i == 0) {
-            depositTenor = Period(forwardTerm_[i], getTimeUnit(forwardUnit_[i]));
-            depositRate = value;
-        } else if (forwardUnit_[i] == "ACTDATE") {
-            int dnum = forwardTerm_[i];
-            Date d(Day(dnum % 100),
-                   Month((dnum % 10000) / 100),
-                   Year(dnum / 10000));
-            futuresMats.push_back(d);
-            futuresPrices.push_back(100 - value * 100);
-        } else {
-            Period p(forwardTerm_[i], getTimeUnit(forwardUnit_[i]));
-            swapTenors.push_back(p);
-            swapQuotes.push_back(value);
-        }
-    }
-}
-
-template<typename T> void readColumn(
-        XLWorksheet &sheet, int columnIndex, int rowCount, std::vector<T> &data) {
-    // empty current storage
-    data.clear();
-
-    // skip header
-    for (int i = 1; i < rowCount; i++) {
-        std::cout << i << " "
-                  << columnIndex << " "
-                  << sheet.Cell(i + 1, columnIndex + 1).Value().Get<T>()
-                  << std::endl;
-        data.push_back(sheet.Cell(i + 1, columnIndex + 1).Value().Get<T>());
-    }
+    bbgForwardQuotes(workbook_, depositTenor, depositRate,
+                futuresMats, futuresPrices, swapTenors, swapQuotes);
 }
 
 void RatesMainWindow::openBbg() {
     // select a file
     QString filename = QFileDialog::getOpenFileName(
             this, QString::fromUtf8("打开文件"), "doc", "Excel (*.xlsx)");
-    XLDocument doc(filename.toUtf8().constData());
-    XLWorkbook workbook = doc.Workbook();
-    // need the VolSurface sheet
-    XLWorksheet sheet = workbook.Worksheet("VolSurface");
-
-    int rowCount = sheet.RowCount();
-    int colCount = sheet.ColumnCount();
-
-    // re-construct vector
-    volRowIndex_.clear();
-    volColIndex_.clear();
-    vol_.clear();
-
-    for (int i = 0; i < rowCount - 1; i++)
-        vol_.push_back(std::vector<double>(colCount - 1));
-
-    // the first column is the row index and the first row is the col index
-    for (int i = 0; i < rowCount; i++) {
-        for (int j = 0; j < colCount; j++) {
-            if ((i > 0) || (j > 0)) {
-                if ((i == 0) && (j > 0)) {
-                    volColIndex_.push_back(
-                            sheet.Cell(i + 1, j + 1).Value().Get<std::string>());
-                } else if (( i > 0) && (j == 0)) {
-                    volRowIndex_.push_back(
-                            sheet.Cell(i + 1, j + 1).Value().Get<std::string>());
-                } else {
-                    try {
-                        vol_[i - 1][j - 1] = sheet.Cell(i + 1, j + 1).Value().Get<double>();
-                    } catch ( OpenXLSX::XLException e ) {
-                        vol_[i - 1][j - 1] = sheet.Cell(i + 1, j + 1).Value().Get<int>();
-                    }
-                    std::cout << i << " " << j << std::endl;
-                    std::cout << vol_[i - 1][j - 1] << std::endl;
-                }
-            }
-        }
-    }
-    
-    // load curve
-    XLWorksheet forwards = workbook.Worksheet("Forward");
-    rowCount = forwards.RowCount();
-    std::cout << "Forward row count " << rowCount << std::endl;
-    readColumn<int>(forwards, FORWARD_CURVE_TERM_IDX, rowCount, forwardTerm_);
-    readColumn<std::string>(forwards, FORWARD_CURVE_UNIT_IDX, rowCount, forwardUnit_);
-    readColumn<double>(forwards, FORWARD_CURVE_BID_IDX, rowCount, forwardBid_);
-    readColumn<double>(forwards, FORWARD_CURVE_ASK_IDX, rowCount, forwardAsk_);
-
-    // ois curve
-    XLWorksheet ois = workbook.Worksheet("OIS");
-    rowCount = ois.RowCount();
-    readColumn<int>(ois, OIS_CURVE_TERM_IDX, rowCount, oisTerm_);
-    readColumn<std::string>(ois, OIS_CURVE_UNIT_IDX, rowCount, oisUnit_);
-    readColumn<double>(ois, OIS_CURVE_BID_IDX, rowCount, oisBid_);
-    readColumn<double>(ois, OIS_CURVE_ASK_IDX, rowCount, oisAsk_);
+    workbook_ = readBbgWorkbook(filename.toUtf8().constData());
 
     std::cout << "Read file done." << std::endl;
     // notify the vol table value changes
@@ -288,7 +214,8 @@ void RatesMainWindow::openBbg() {
             swapTenors, swapQuotes,
             settlementDays, calendar, settlementDate,
             fixedLegDayCounter, liborIndex,
-            true, true, discountTermStructure, forecastTermStructure);
+            true, true, discountTermStructure, forecastTermStructure,
+            modelInfo_->isGlobalBootstrap());
     std::cout << "IR term structure bootstrapped." << std::endl;
 
     updateOisTable(settlementDate, calendar,
@@ -345,25 +272,27 @@ void RatesMainWindow::updateVolTable() {
     volTable_->setRowCount(0);
     volTable_->setColumnCount(0);
 
-    volTable_->setRowCount(volRowIndex_.size());
-    volTable_->setColumnCount(volColIndex_.size());
+    const std::vector<std::string> &volRowIndex = workbook_.volExpiries;
+    const std::vector<std::string> &volColIndex = workbook_.volTenors;
+    volTable_->setRowCount(volRowIndex.size());
+    volTable_->setColumnCount(volColIndex.size());
 
     // update new contents
-    for (unsigned long i = 0; i < volColIndex_.size(); i++) {
+    for (unsigned long i = 0; i < volColIndex.size(); i++) {
         volTable_->setHorizontalHeaderItem(i,
                 new QTableWidgetItem(
-                        QString::fromUtf8(volColIndex_[i].c_str())));
+                        QString::fromUtf8(volColIndex[i].c_str())));
     }
-    for (unsigned long i = 0; i < volRowIndex_.size(); i++) {
+    for (unsigned long i = 0; i < volRowIndex.size(); i++) {
         volTable_->setVerticalHeaderItem(i,
                 new QTableWidgetItem(
-                    QString::fromUtf8(volRowIndex_[i].c_str())));
+                    QString::fromUtf8(volRowIndex[i].c_str())));
     }
 
-    for (unsigned long i = 0; i < volRowIndex_.size(); i++) {
-        for (unsigned long j = 0; j < volColIndex_.size(); j++) {
+    for (unsigned long i = 0; i < volRowIndex.size(); i++) {
+        for (unsigned long j = 0; j < volColIndex.size(); j++) {
             volTable_->setItem(i, j, new QTableWidgetItem(
-                        QString::number(vol_[i][j], 'g', 4)));
+                        QString::number(workbook_.volSurface[i][j], 'g', 4)));
         }
     }
 }
@@ -485,89 +414,265 @@ void RatesMainWindow::setModelInfoWidget(ModelInfo *modelInfo) {
     modelInfo_ = modelInfo;
 }
 
-void RatesMainWindow::calculate() {
-    std::cout << "In calculating..." << std::endl;
+bool RatesMainWindow::backgroundBusy() {
+    // the grid, and without isolated evaluation contexts the live marks,
+    // own QuantLib's global state while they run
+    if (scenarioRunning_) {
+        QMessageBox::warning(this, QString::fromUtf8("情景分析进行中"),
+                    QString::fromUtf8("请等待情景分析完成！"),
+                               QMessageBox::Ok);
+        return true;
+    }
+    if (liveMarks_ && !EvaluationContext::isolated()) {
+        QMessageBox::warning(this, QString::fromUtf8("行情流运行中"),
+                    QString::fromUtf8("请先停止行情流！"),
+                               QMessageBox::Ok);
+        return true;
+    }
+    return false;
+}
+
+bool RatesMainWindow::pricingRequest(PricingRequest &request) {
     // collect necessary parameters
     // deal related parameters
-    double notional = dealInfo_->notional().toDouble();
-    QString currency = dealInfo_->currency();
-    std::string effectiveDate = dealInfo_->effectiveDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
-    std::string maturityDate  = dealInfo_->maturityDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
-    bool changeFirstExerciseDate = dealInfo_->changeFirstExerciseDate();
-    std::string firstExerciseDate  = dealInfo_->firstExerciseDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
+    request.notional = dealInfo_->notional().toDouble();
+    request.currency = dealInfo_->currency().toUtf8().constData();
+    request.effectiveDate = dealInfo_->effectiveDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
+    request.maturityDate  = dealInfo_->maturityDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
+    request.changeFirstExerciseDate = dealInfo_->changeFirstExerciseDate();
+    request.firstExerciseDate  = dealInfo_->firstExerciseDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
 
     // fix leg related information
-    QString fixedDirection = fixedLegSpec_->direction();
-    double fixedCoupon = fixedLegSpec_->coupon().toDouble();
-    QString fixedPayFreq = fixedLegSpec_->payFreq();
-    std::string fixedDayCounter = fixedLegSpec_->dayCounter().toUtf8().constData();
+    request.fixedDirection = fixedLegSpec_->direction().toUtf8().constData();
+    request.fixedCoupon = fixedLegSpec_->coupon().toDouble();
+    request.fixedPayFreq = fixedLegSpec_->payFreq().toUtf8().constData();
+    request.fixedDayCounter = fixedLegSpec_->dayCounter().toUtf8().constData();
 
     // float leg related information
-    QString floatDirection = floatLegSpec_->direction();
-    QString floatIndex = floatLegSpec_->index();
-    QString floatPayFreq = floatLegSpec_->payFreq();
-    std::string floatDayCounter = floatLegSpec_->dayCounter().toUtf8().constData();
+    request.floatDirection = floatLegSpec_->direction().toUtf8().constData();
+    request.floatIndex = floatLegSpec_->index().toUtf8().constData();
+    request.floatPayFreq = floatLegSpec_->payFreq().toUtf8().constData();
+    request.floatDayCounter = floatLegSpec_->dayCounter().toUtf8().constData();
 
     // optionality
-    QString style = optionality_->style();
-    QString position = optionality_->position();
-    QString callFreq = optionality_->callFreq();
+    request.style = optionality_->style().toUtf8().constData();
+    request.position = optionality_->position().toUtf8().constData();
+    request.callFreq = optionality_->callFreq().toUtf8().constData();
 
     // model
-    std::string pricingDate = modelInfo_->pricingDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
-    QString model = modelInfo_->model();
-    QString engine = modelInfo_->engine();
-    QString complexity = modelInfo_->complexity();
-    QString curve = modelInfo_->curve();
+    request.today = modelInfo_->pricingDate().toString(QString::fromUtf8("yyyy/MM/dd")).toUtf8().constData();
+    request.model = modelInfo_->model().toUtf8().constData();
+    request.engine = modelInfo_->engine().toUtf8().constData();
+    request.complexity = modelInfo_->complexity().toUtf8().constData();
+    request.curve = modelInfo_->curve().toUtf8().constData();
+    request.useGlobalBootstrap = modelInfo_->isGlobalBootstrap();
+    request.adaptiveGrid = modelInfo_->isAdaptiveGrid();
 
     // prepare interest rate curve
-    std::vector<Period> oisTenors;
-    std::vector<double> oisRates;
-    Period depositTenor;
-    double depositRate;
-    std::vector<Date> futuresMaturities;
-    std::vector<double> futuresPrices;
-    std::vector<Period> swapTenors;
-    std::vector<double> swapQuotes;
-    
-    bool useExternalVolSurface = modelInfo_->isExternalVolSurface();
-    if (!useExternalVolSurface) {
-        oisTenors.insert(oisTenors.begin(),
+    request.useExternalVolSurface = modelInfo_->isExternalVolSurface();
+    if (!request.useExternalVolSurface) {
+        request.oisTenors.assign(
             std::begin(OIS_TENORS), std::end(OIS_TENORS));
-        oisRates.insert(oisRates.begin(),
+        request.oisRates.assign(
             std::begin(OIS_RATES), std::end(OIS_RATES));
-        depositTenor = DEPOSIT_TENOR;
-        depositRate  = DEPOSIT_RATE;
-        futuresMaturities.insert(futuresMaturities.begin(),
+        request.depositTenor = DEPOSIT_TENOR;
+        request.depositRate  = DEPOSIT_RATE;
+        request.futuresMaturities.assign(
             std::begin(FUTURES_MATURITIES), std::end(FUTURES_MATURITIES));
-        futuresPrices.insert(futuresPrices.begin(),
+        request.futuresPrices.assign(
             std::begin(FUTURES_PRICES), std::end(FUTURES_PRICES));
-        swapTenors.insert(swapTenors.begin(),
+        request.swapTenors.assign(
             std::begin(SWAP_TENORS), std::end(SWAP_TENORS));
-        swapQuotes.insert(swapQuotes.begin(),
+        request.swapQuotes.assign(
             std::begin(SWAP_QUOTES), std::end(SWAP_QUOTES));
-    } else if (vol_.size() > 0) {
-        getOisQuoteData(oisTenors, oisRates);
-        getForwardQuoteData(depositTenor, depositRate,
-                    futuresMaturities, futuresPrices,
-                    swapTenors, swapQuotes);
+    } else if (workbook_.volSurface.size() > 0) {
+        getOisQuoteData(request.oisTenors, request.oisRates);
+        getForwardQuoteData(request.depositTenor, request.depositRate,
+                    request.futuresMaturities, request.futuresPrices,
+                    request.swapTenors, request.swapQuotes);
     } else {
         // no vol surface loaded, alert.
         QMessageBox::critical(this, QString::fromUtf8("未加载波动率曲面"),
                     QString::fromUtf8("请先加载波动率曲面！"),
                                QMessageBox::Ok);
+        return false;
     }
+    request.volSurface = workbook_.volSurface;
+    request.volExpiries = workbook_.volExpiries;
+    request.volTenors = workbook_.volTenors;
+    return true;
+}
+
+void RatesMainWindow::calculate() {
+    std::cout << "In calculating..." << std::endl;
+    if (backgroundBusy())
+        return;
+
+    PricingRequest request;
+    if (!pricingRequest(request))
+        return;
+
+    // a running pricing daemon keeps the curves and models warm
+    const char *socketPath = std::getenv("RATES_PRICING_SOCKET");
+    if (socketPath) {
+        try {
+            PricingClient client(socketPath);
+            PricingResponse response = client.price(request);
+            if (response.ok) {
+                std::cout << "Daemon price at " << response.price
+                          << " in " << response.elapsedMilliseconds
+                          << " ms" << std::endl;
+                modelInfo_->setPrice(response.price / request.notional,
+                                     response.price);
+                return;
+            }
+            std::cout << "Daemon pricing failed: " << response.error
+                      << std::endl;
+        } catch (std::exception &e) {
+            std::cout << "Pricing daemon unavailable, pricing in "
+                      << "process: " << e.what() << std::endl;
+        }
+    }
+
+    double price = priceSwaption(request.notional,
+            QString::fromUtf8(request.currency.c_str()),
+            request.effectiveDate, request.maturityDate,
+            request.changeFirstExerciseDate, request.firstExerciseDate,
+            QString::fromUtf8(request.fixedDirection.c_str()),
+            request.fixedCoupon,
+            QString::fromUtf8(request.fixedPayFreq.c_str()),
+            request.fixedDayCounter,
+            QString::fromUtf8(request.floatDirection.c_str()),
+            QString::fromUtf8(request.floatIndex.c_str()),
+            QString::fromUtf8(request.floatPayFreq.c_str()),
+            request.floatDayCounter,
+            QString::fromUtf8(request.style.c_str()),
+            QString::fromUtf8(request.position.c_str()),
+            QString::fromUtf8(request.callFreq.c_str()),
+            request.today,
+            QString::fromUtf8(request.model.c_str()),
+            QString::fromUtf8(request.engine.c_str()),
+            QString::fromUtf8(request.complexity.c_str()),
+            QString::fromUtf8(request.curve.c_str()),
+            request.useExternalVolSurface,
+            request.volSurface, request.volExpiries, request.volTenors,
+            request.oisTenors, request.oisRates,
+            request.depositTenor, request.depositRate,
+            request.futuresMaturities, request.futuresPrices,
+            request.swapTenors, request.swapQuotes,
+            request.useGlobalBootstrap, request.adaptiveGrid);
+    modelInfo_->setPrice(price / request.notional, price);
+}
 
-    if (!useExternalVolSurface || vol_.size() > 0) {
-        double price = priceSwaption(notional,
-                currency, effectiveDate, maturityDate, changeFirstExerciseDate, firstExerciseDate,
-                fixedDirection, fixedCoupon, fixedPayFreq, fixedDayCounter,
-                floatDirection, floatIndex, floatPayFreq, floatDayCounter,
-                style, position, callFreq,
-                pricingDate, model, engine, complexity, curve,
-                useExternalVolSurface, vol_,
-                oisTenors, oisRates,
-                depositTenor, depositRate, futuresMaturities, futuresPrices, swapTenors, swapQuotes);
-        modelInfo_->setPrice(price / notional, price);
+void RatesMainWindow::runScenarioGrid() {
+    if (backgroundBusy())
+        return;
+
+    PricingRequest request;
+    if (!pricingRequest(request))
+        return;
+
+    // parallel shifts of -100bp to +100bp against vol multipliers
+    std::vector<Real> rateShifts, volMultipliers;
+    for (int i = -SCENARIO_RATE_STEPS; i <= SCENARIO_RATE_STEPS; i++)
+        rateShifts.push_back(i * SCENARIO_RATE_STEP);
+    for (int j = -SCENARIO_VOL_STEPS; j <= SCENARIO_VOL_STEPS; j++)
+        volMultipliers.push_back(1.0 + j * SCENARIO_VOL_STEP);
+
+    // erase old data
+    scenarioTable_->setRowCount(0);
+    scenarioTable_->setColumnCount(0);
+
+    scenarioTable_->setRowCount(rateShifts.size());
+    scenarioTable_->setColumnCount(volMultipliers.size());
+    for (unsigned long i = 0; i < rateShifts.size(); i++) {
+        scenarioTable_->setVerticalHeaderItem(i, new QTableWidgetItem(
+                    QString::number(rateShifts[i] * 1.0e4, 'f', 0)
+                    + QString::fromUtf8("bp")));
     }
+    for (unsigned long j = 0; j < volMultipliers.size(); j++) {
+        scenarioTable_->setHorizontalHeaderItem(j, new QTableWidgetItem(
+                    QString::fromUtf8("x") +
+                    QString::number(volMultipliers[j], 'f', 2)));
+    }
+    scenarioScale_ = 0.0;
+
+    // the cells come back on the GUI thread as they finish.  The model
+    // is calibrated once per vol column and kept under the rate shifts;
+    // recalibrating every cell would cost one calibration per cell.
+    if (scenarioThread_.joinable())
+        scenarioThread_.join();
+    scenarioRunning_ = true;
+    scenarioThread_ = std::thread([this, request, rateShifts,
+                                   volMultipliers]() {
+        try {
+            scenarioGrid(requestBook(request), rateShifts, volMultipliers,
+                         false, [this](Size row, Size col, Real pnl) {
+                QMetaObject::invokeMethod(this, "updateScenarioCell",
+                            Qt::QueuedConnection,
+                            Q_ARG(int, int(row)), Q_ARG(int, int(col)),
+                            Q_ARG(double, pnl));
+            });
+        } catch (std::exception &e) {
+            std::cout << "Scenario grid failed: " << e.what() << std::endl;
+        }
+        scenarioRunning_ = false;
+    });
+}
+
+void RatesMainWindow::updateScenarioCell(int row, int col, double price) {
+    QTableWidgetItem *item = new QTableWidgetItem(
+                QString::number(price, 'f', 0));
+
+    // shade by the size of the P&L against the largest seen so far
+    scenarioScale_ = std::max(scenarioScale_, std::fabs(price));
+    int shade = scenarioScale_ > 0.0 ?
+                int(155.0 * std::fabs(price) / scenarioScale_) : 0;
+    item->setBackground(price >= 0.0 ?
+                        QColor(255 - shade, 255, 255 - shade) :
+                        QColor(255, 255 - shade, 255 - shade));
+    scenarioTable_->setItem(row, col, item);
+}
+
+void RatesMainWindow::openFeed() {
+    // a new feed replaces the running one
+    stopFeed();
+    if (backgroundBusy())
+        return;
+
+    PricingRequest request;
+    if (!pricingRequest(request))
+        return;
+
+    QString path = QFileDialog::getOpenFileName(this,
+                QString::fromUtf8("打开行情流"), QString::fromUtf8("."));
+    if (path.isEmpty())
+        return;
+
+    // the marks come back on the GUI thread as the ticks are applied
+    liveNotional_ = request.notional;
+    liveMarks_.reset(new LiveMarks(requestBook(request), feedKeys(request),
+                                   path.toUtf8().constData()));
+    liveThread_ = std::thread([this]() {
+        try {
+            liveMarks_->run([this](Size, Real price) {
+                QMetaObject::invokeMethod(this, "updateLivePrice",
+                            Qt::QueuedConnection, Q_ARG(double, price));
+            });
+        } catch (std::exception &e) {
+            std::cout << "Live marks stopped: " << e.what() << std::endl;
+        }
+    });
+}
+
+void RatesMainWindow::stopFeed() {
+    if (!liveMarks_)
+        return;
+    liveMarks_->stop();
+    liveThread_.join();
+    liveMarks_.reset();
+}
+
+void RatesMainWindow::updateLivePrice(double price) {
+    modelInfo_->setPrice(price / liveNotional_, price);
 }
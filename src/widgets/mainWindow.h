@@ -8,6 +8,9 @@
 #include <QMainWindow>
 #include <QTableWidget>
 
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -16,6 +19,10 @@
 #include "widgets/floatLegSpec.h"
 #include "widgets/optionality.h"
 #include "widgets/modelInfo.h"
+#include "service/bbgWorkbook.h"
+#include "service/pricingProtocol.h"
+
+class LiveMarks;
 
 #include <ql/handle.hpp>
 #include <ql/time/date.hpp>
@@ -27,6 +34,7 @@ using namespace QuantLib;
 class RatesMainWindow : public QMainWindow {
     Q_OBJECT
 public:
+    RatesMainWindow();
     virtual ~RatesMainWindow();
     void setupMenu();
 
@@ -39,6 +47,7 @@ public:
     void setVolTableWidget(QTableWidget *volTable);
     void setOisTableWidget(QTableWidget *oisTable);
     void setForwardTableWidget(QTableWidget *forwardTable);
+    void setScenarioTableWidget(QTableWidget *scenarioTable);
 
     std::vector<std::string> getRowIndex();
     std::vector<std::string> getColIndex();
@@ -57,8 +66,17 @@ private slots:
     void saveOis();
     void saveForecast();
     void calculate();
+    void runScenarioGrid();
+    void updateScenarioCell(int row, int col, double price);
+    void openFeed();
+    void stopFeed();
+    void updateLivePrice(double price);
 
 private:
+    // true if a background run holds QuantLib, after alerting
+    bool backgroundBusy();
+    // false if the inputs are incomplete, after alerting
+    bool pricingRequest(PricingRequest &request);
     void updateVolTable();
     void updateOisTable(Date startDate, Calendar calendar,
             const std::vector<Period> &oisTerms,
@@ -69,21 +87,8 @@ private:
             const std::vector<Period> &swapTenors,
             const RelinkableHandle<YieldTermStructure> &forecastTermStructure);
 
-    std::vector<std::string> volRowIndex_;
-    std::vector<std::string> volColIndex_;
-    std::vector<std::vector<double>> vol_;
-
-    // forward rate curves
-    std::vector<int> forwardTerm_;
-    std::vector<std::string> forwardUnit_;
-    std::vector<double> forwardBid_;
-    std::vector<double> forwardAsk_;
-
-    // ois rate curves
-    std::vector<int> oisTerm_;
-    std::vector<std::string> oisUnit_;
-    std::vector<double> oisBid_;
-    std::vector<double> oisAsk_;
+    // vol surface, forward and ois rate curves
+    BbgWorkbook workbook_;
 
     // widgets
     DealInfo *dealInfo_;
@@ -95,6 +100,17 @@ private:
     QTableWidget *volTable_;
     QTableWidget *oisCurveTable_;
     QTableWidget *forwardCurveTable_;
+    QTableWidget *scenarioTable_;
+
+    // scenario grid running in the background
+    double scenarioScale_;
+    std::atomic<bool> scenarioRunning_;
+    std::thread scenarioThread_;
+
+    // live marks running in the background
+    std::unique_ptr<LiveMarks> liveMarks_;
+    std::thread liveThread_;
+    double liveNotional_;
 };
 
 #endif
@@ -25,6 +25,8 @@ ModelInfo::ModelInfo() : QWidget() {
     complexity_ = new QComboBox();
     curves_ = new QComboBox();
     externalVols_ = new QCheckBox(QString::fromUtf8("使用导入波动率曲面"));
+    globalBootstrap_ = new QCheckBox(QString::fromUtf8("全局牛顿曲线构建"));
+    adaptiveGrid_ = new QCheckBox(QString::fromUtf8("自适应网格"));
     pricePerc_ = new QLabel();
     price_ = new QLabel();
 
@@ -35,6 +37,8 @@ ModelInfo::ModelInfo() : QWidget() {
     // default engine
     engine_->addItem(QString::fromUtf8("有限差分(FD)"));
     engine_->addItem(QString::fromUtf8("Black方法"));
+    engine_->addItem(QString::fromUtf8("高斯积分(Gaussian1d)"));
+    engine_->addItem(QString::fromUtf8("近似(Hagan)"));
 
     // complexity
     complexity_->addItem(QString::fromUtf8("常函数"));
@@ -69,6 +73,9 @@ ModelInfo::ModelInfo() : QWidget() {
     layout->addWidget(labelPrice_, 4, 3, Qt::AlignLeft);
     layout->addWidget(price_, 4, 4, Qt::AlignLeft);
 
+    layout->addWidget(globalBootstrap_, 5, 1, Qt::AlignLeft);
+    layout->addWidget(adaptiveGrid_, 5, 2, Qt::AlignLeft);
+
     this->setLayout(layout);
 }
 
@@ -87,6 +94,8 @@ ModelInfo::~ModelInfo() {
     delete complexity_;
     delete curves_;
     delete externalVols_;
+    delete globalBootstrap_;
+    delete adaptiveGrid_;
     delete pricePerc_;
     delete price_;
 
@@ -117,6 +126,14 @@ bool ModelInfo::isExternalVolSurface() {
     return externalVols_->checkState() == Qt::Checked;
 }
 
+bool ModelInfo::isGlobalBootstrap() {
+    return globalBootstrap_->checkState() == Qt::Checked;
+}
+
+bool ModelInfo::isAdaptiveGrid() {
+    return adaptiveGrid_->checkState() == Qt::Checked;
+}
+
 void ModelInfo::setPrice(double returnRate, double price) {
     QLocale cLocale = QLocale::c();
     pricePerc_->setText(cLocale.toString(returnRate * 100, 'f', 3));
@@ -25,6 +25,8 @@ public:
     QString complexity();
     QString curve();
     bool isExternalVolSurface();
+    bool isGlobalBootstrap();
+    bool isAdaptiveGrid();
 
     void setPrice(double returnRate, double price);
 private:
@@ -43,6 +45,8 @@ private:
     QComboBox *complexity_;
     QComboBox *curves_;
     QCheckBox *externalVols_;
+    QCheckBox *globalBootstrap_;
+    QCheckBox *adaptiveGrid_;
     QLabel *pricePerc_;
     QLabel *price_;
 
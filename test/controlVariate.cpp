@@ -0,0 +1,179 @@
+/*
+ * The control-variate Bermudan engines on their default coarse grids
+ * against fine-grid reference prices.
+ */
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+#include <ql/pricingengines/swaption/fdg2swaptionengine.hpp>
+#include <ql/pricingengines/swaption/fdhullwhiteswaptionengine.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <ql/time/daycounters/thirty360.hpp>
+#include <ql/time/schedule.hpp>
+
+#include "model/controlVariateSwaptionEngine.h"
+#include "model/fdG2GridSwaptionEngine.h"
+#include "model/fdHullWhiteExerciseEngine.h"
+#include "model/g2GaussHermiteSwaptionEngine.h"
+#include "model/hullWhiteKernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+    const Real notional = 1000000.0;
+    // half a basis point of notional
+    const Real tolerance = 0.5e-4 * notional;
+
+    // the default grids of getQuantLibPricingEngine()
+    const Size hwTGrid = 50, hwXGrid = 25;
+    const Size g2TGrid = 100, g2XGrid = 25, g2YGrid = 25;
+
+    struct Bermudan {
+        std::string name;
+        ext::shared_ptr<Swaption> swaption;
+    };
+
+    // callable on every fixed coupon start of a swap starting in
+    // startYears and running for lengthYears, struck moneyness off the
+    // money
+    Bermudan bermudan(const Handle<YieldTermStructure> &curve,
+                      Integer startYears, Integer lengthYears,
+                      VanillaSwap::Type type, Spread moneyness) {
+        Calendar calendar = TARGET();
+        Date settlement = curve->referenceDate();
+        ext::shared_ptr<IborIndex> libor(
+                    new USDLibor(Period(3, Months), curve));
+        Date start = calendar.advance(settlement, startYears, Years);
+        Date maturity = calendar.advance(start, lengthYears, Years);
+        Schedule fixedSchedule(start, maturity, Period(Annual), calendar,
+                               ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        Schedule floatSchedule(start, maturity, Period(Quarterly), calendar,
+                               ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        VanillaSwap atm(type, notional, fixedSchedule, 0.0, Thirty360(),
+                        floatSchedule, libor, 0.0, Actual360());
+        atm.setPricingEngine(ext::make_shared<DiscountingSwapEngine>(curve));
+        Rate strike = atm.fairRate() + moneyness;
+        ext::shared_ptr<VanillaSwap> swap(new VanillaSwap(
+                    type, notional, fixedSchedule, strike, Thirty360(),
+                    floatSchedule, libor, 0.0, Actual360()));
+
+        std::vector<Date> exerciseDates;
+        for (Size i = 0; i < swap->fixedLeg().size(); i++)
+            exerciseDates.push_back(ext::dynamic_pointer_cast<Coupon>(
+                        swap->fixedLeg()[i])->accrualStartDate());
+
+        Bermudan b;
+        std::ostringstream name;
+        name << startYears << "y into " << lengthYears << "y "
+             << (type == VanillaSwap::Payer ? "payer" : "receiver")
+             << " at " << strike;
+        b.name = name.str();
+        b.swaption = ext::make_shared<Swaption>(
+                    swap, ext::make_shared<BermudanExercise>(exerciseDates));
+        return b;
+    }
+
+    Real price(Swaption &swaption,
+               const ext::shared_ptr<PricingEngine> &engine, double &ms) {
+        std::chrono::steady_clock::time_point start =
+                    std::chrono::steady_clock::now();
+        swaption.setPricingEngine(engine);
+        Real value = swaption.NPV();
+        ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        return value;
+    }
+
+    // the corrected coarse price must be within the tolerance of the
+    // reference; the uncorrected coarse price and the old uncorrected
+    // default are reported for comparison.  Returns the number of
+    // failures.
+    int compare(const std::string &model, Swaption &swaption,
+                const ext::shared_ptr<PricingEngine> &reference,
+                const ext::shared_ptr<PricingEngine> &baseline,
+                const ext::shared_ptr<GridSwaptionEngine> &coarse,
+                const ext::shared_ptr<PricingEngine> &analytic) {
+        int failures = 0;
+        try {
+            double referenceMs, baselineMs, coarseMs, correctedMs;
+            Real expected = price(swaption, reference, referenceMs);
+            Real old = price(swaption, baseline, baselineMs);
+            Real uncorrected = price(swaption,
+                    ext::dynamic_pointer_cast<PricingEngine>(coarse),
+                    coarseMs);
+            Real corrected = price(swaption,
+                    ext::make_shared<ControlVariateSwaptionEngine>(
+                            coarse, analytic), correctedMs);
+            std::cout << model << ": reference " << expected << " ("
+                      << referenceMs << " ms), old default "
+                      << old - expected << " (" << baselineMs
+                      << " ms), coarse " << uncorrected - expected << " ("
+                      << coarseMs << " ms), corrected "
+                      << corrected - expected << " (" << correctedMs
+                      << " ms)" << std::endl;
+            if (std::fabs(corrected - expected) > tolerance) {
+                std::cout << model << ": off the reference by more than "
+                          << tolerance << std::endl;
+                failures++;
+            }
+        } catch (std::exception &e) {
+            std::cout << model << ": " << e.what() << std::endl;
+            failures++;
+        }
+        return failures;
+    }
+
+}
+
+int main() {
+    Date today(16, July, 2019);
+    Settings::instance().evaluationDate() = today;
+    Handle<YieldTermStructure> curve(ext::make_shared<FlatForward>(
+                TARGET().advance(today, 2, Days), 0.02, Actual365Fixed()));
+
+    // the initial guesses of getQuantLibPricingEngine()
+    ext::shared_ptr<HullWhite> hw(new HullWhite(curve, 0.03, 0.00727));
+    ext::shared_ptr<G2> g2(new G2(curve, 0.049235, 0.00278221, 0.049235,
+                                  0.00916386, -0.650439));
+
+    std::vector<Bermudan> deals;
+    deals.push_back(bermudan(curve, 1, 10, VanillaSwap::Payer, 0.0));
+    deals.push_back(bermudan(curve, 1, 10, VanillaSwap::Payer, -0.01));
+    deals.push_back(bermudan(curve, 5, 5, VanillaSwap::Receiver, -0.01));
+    deals.push_back(bermudan(curve, 2, 20, VanillaSwap::Receiver, 0.0));
+
+    int failures = 0;
+    for (Size i = 0; i < deals.size(); i++) {
+        int dealFailures = 0;
+        Swaption &swaption = *deals[i].swaption;
+        std::cout << deals[i].name << std::endl;
+        dealFailures += compare("Hull-White", swaption,
+                ext::make_shared<FdHullWhiteSwaptionEngine>(hw, 1000, 1000),
+                ext::make_shared<FdHullWhiteSwaptionEngine>(hw, 100, 100),
+                ext::make_shared<FdHullWhiteExerciseSwaptionEngine>(
+                        hw, hwTGrid, hwXGrid),
+                ext::make_shared<BatchedJamshidianSwaptionEngine>(hw));
+        dealFailures += compare("G2", swaption,
+                ext::make_shared<FdG2SwaptionEngine>(g2, 400, 150, 150),
+                ext::make_shared<FdG2SwaptionEngine>(g2, 500),
+                ext::make_shared<FdG2GridSwaptionEngine>(
+                        g2, g2TGrid, g2XGrid, g2YGrid),
+                ext::make_shared<G2GaussHermiteSwaptionEngine>(g2, 64));
+        std::cout << deals[i].name << (dealFailures ? " failed" : " passed")
+                  << std::endl;
+        failures += dealFailures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+include(test.pri)
+TARGET = controlVariate
+SOURCES += controlVariate.cpp \
+           ../src/model/controlVariateSwaptionEngine.cpp \
+           ../src/model/fdG2GridSwaptionEngine.cpp \
+           ../src/model/fdHullWhiteExerciseEngine.cpp \
+           ../src/model/g2GaussHermiteSwaptionEngine.cpp \
+           ../src/model/gridSwaptionEngine.cpp \
+           ../src/model/hullWhiteKernels.cpp
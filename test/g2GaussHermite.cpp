@@ -0,0 +1,125 @@
+/*
+ * The Gauss-Hermite G2 swaption engine against QuantLib's
+ * G2SwaptionEngine and G2::swaption().
+ */
+
+#include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/instruments/makevanillaswap.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+#include <ql/pricingengines/swaption/g2swaptionengine.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include "model/g2GaussHermiteSwaptionEngine.h"
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+    const Real notional = 1000000.0;
+    // per unit notional
+    const Real tolerance = 1.0e-8;
+    // fine enough that the segment integral is exact to well below the
+    // tolerance
+    const Real range = 10.0;
+    const Size intervals = 2000;
+
+    // ATM, ITM and OTM payers and receivers of one expiry and length;
+    // returns the number of failures
+    int compare(const std::string &name, const ext::shared_ptr<G2> &model,
+                const Handle<YieldTermStructure> &curve,
+                const Period &expiry, const Period &length) {
+        Date today = Settings::instance().evaluationDate();
+        ext::shared_ptr<IborIndex> libor(
+                    new USDLibor(Period(3, Months), curve));
+        Date exerciseDate = TARGET().advance(today, expiry);
+        ext::shared_ptr<Exercise> exercise(
+                    new EuropeanExercise(exerciseDate));
+        ext::shared_ptr<VanillaSwap> atmSwap =
+                MakeVanillaSwap(length, libor, Null<Rate>(), expiry)
+                .withDiscountingTermStructure(curve);
+        Rate atm = atmSwap->fixedRate();
+
+        ext::shared_ptr<PricingEngine> gaussHermite(
+                    new G2GaussHermiteSwaptionEngine(model, 64));
+        ext::shared_ptr<PricingEngine> segment(
+                    new G2SwaptionEngine(model, range, intervals));
+
+        int failures = 0;
+        const VanillaSwap::Type types[] = { VanillaSwap::Payer,
+                                            VanillaSwap::Receiver };
+        const Spread moneyness[] = { 0.0, -0.01, 0.01 };
+        for (Size t = 0; t < 2; t++) {
+            for (Size m = 0; m < 3; m++) {
+                Rate strike = atm + moneyness[m];
+                ext::shared_ptr<VanillaSwap> swap =
+                        MakeVanillaSwap(length, libor, strike, expiry)
+                        .withType(types[t])
+                        .withNominal(notional)
+                        .withDiscountingTermStructure(curve);
+                Swaption swaption(swap, exercise);
+
+                swaption.setPricingEngine(gaussHermite);
+                Real actual = swaption.NPV();
+                swaption.setPricingEngine(segment);
+                Real expected = swaption.NPV();
+                // the model's own closed form, on the same arguments
+                Swaption::arguments arguments;
+                swaption.setupArguments(&arguments);
+                Real direct = model->swaption(arguments, strike, range,
+                                              intervals);
+
+                std::ostringstream label;
+                label << name << " " << expiry << "x" << length << " "
+                      << (types[t] == VanillaSwap::Payer ? "payer" :
+                                                           "receiver")
+                      << " at " << strike;
+                if (std::fabs(actual - expected) > tolerance * notional ||
+                    std::fabs(actual - direct) > tolerance * notional) {
+                    std::cout << label.str() << ": " << actual
+                              << ", expected " << expected
+                              << " (G2::swaption " << direct << ")"
+                              << std::endl;
+                    failures++;
+                }
+            }
+        }
+        std::cout << name << " " << expiry << "x" << length
+                  << (failures ? " failed" : " passed") << std::endl;
+        return failures;
+    }
+
+}
+
+int main() {
+    Date today(16, July, 2019);
+    Settings::instance().evaluationDate() = today;
+    Handle<YieldTermStructure> curve(ext::make_shared<FlatForward>(
+                TARGET().advance(today, 2, Days), 0.02, Actual365Fixed()));
+
+    int failures = 0;
+    try {
+        // the initial guess of getQuantLibPricingEngine(), a = b
+        ext::shared_ptr<G2> initial(new G2(curve, 0.049235, 0.00278221,
+                                           0.049235, 0.00916386,
+                                           -0.650439));
+        ext::shared_ptr<G2> distinct(new G2(curve, 0.1, 0.01, 0.02, 0.008,
+                                            -0.75));
+        const Period expiries[] = { Period(1, Years), Period(5, Years),
+                                    Period(10, Years) };
+        for (Size i = 0; i < 3; i++) {
+            failures += compare("initial", initial, curve, expiries[i],
+                                Period(10, Years));
+            failures += compare("distinct", distinct, curve, expiries[i],
+                                Period(5, Years));
+        }
+    } catch (std::exception &e) {
+        std::cout << e.what() << std::endl;
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+include(test.pri)
+TARGET = g2GaussHermite
+SOURCES += g2GaussHermite.cpp \
+           ../src/model/g2GaussHermiteSwaptionEngine.cpp
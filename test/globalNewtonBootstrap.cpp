@@ -0,0 +1,100 @@
+/*
+ * The global Newton bootstrap against QuantLib's iterative bootstrap.
+ */
+
+#include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/termstructures/yield/piecewiseyieldcurve.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/thirty360.hpp>
+
+#include "model/globalNewtonBootstrap.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+    typedef PiecewiseYieldCurve<ZeroYield, Linear> IterativeCurve;
+    typedef PiecewiseYieldCurve<ZeroYield, Linear, GlobalNewtonBootstrap>
+            NewtonCurve;
+
+    // deposit and swap helpers; the swaps discount on discountCurve,
+    // which may be linked to the curve they are bootstrapping
+    std::vector<ext::shared_ptr<ZeroYield::helper> > helpers(
+            const Handle<YieldTermStructure> &discountCurve) {
+        Calendar calendar = TARGET();
+        ext::shared_ptr<IborIndex> libor(new USDLibor(Period(3, Months)));
+        std::vector<ext::shared_ptr<ZeroYield::helper> > h;
+        h.push_back(ext::make_shared<DepositRateHelper>(
+                    Handle<Quote>(ext::make_shared<SimpleQuote>(0.0230)),
+                    Period(3, Months), 2, calendar, ModifiedFollowing, true,
+                    Actual360()));
+        const Integer years[] = { 2, 3, 5, 7, 10, 15, 20, 30 };
+        const Rate rates[] = { 0.0205, 0.0198, 0.0196, 0.0199, 0.0206,
+                               0.0215, 0.0220, 0.0222 };
+        for (Size i = 0; i < 8; i++)
+            h.push_back(ext::make_shared<SwapRateHelper>(
+                        Handle<Quote>(ext::make_shared<SimpleQuote>(rates[i])),
+                        Period(years[i], Years), calendar, Semiannual,
+                        ModifiedFollowing, Thirty360(), libor,
+                        Handle<Quote>(), Period(0, Days), discountCurve, 2));
+        return h;
+    }
+
+    // both bootstraps on the same helpers; returns the number of failures
+    int compare(const std::string &name, bool singleCurve) {
+        Date today(16, July, 2019);
+        Settings::instance().evaluationDate() = today;
+        Date settlement = TARGET().advance(today, 2, Days);
+
+        RelinkableHandle<YieldTermStructure> iterativeDiscount, newtonDiscount;
+        if (!singleCurve) {
+            ext::shared_ptr<YieldTermStructure> ois(
+                        new FlatForward(settlement, 0.0190, Actual360()));
+            iterativeDiscount.linkTo(ois);
+            newtonDiscount.linkTo(ois);
+        }
+        ext::shared_ptr<IterativeCurve> iterative(new IterativeCurve(
+                    settlement, helpers(iterativeDiscount), Actual360()));
+        ext::shared_ptr<NewtonCurve> newton(new NewtonCurve(
+                    settlement, helpers(newtonDiscount), Actual360()));
+        if (singleCurve) {
+            iterativeDiscount.linkTo(iterative);
+            newtonDiscount.linkTo(newton);
+        }
+
+        int failures = 0;
+        try {
+            const std::vector<Real> &expected = iterative->data();
+            const std::vector<Real> &actual = newton->data();
+            if (expected.size() != actual.size())
+                QL_FAIL(actual.size() << " nodes instead of "
+                        << expected.size());
+            for (Size i = 0; i < expected.size(); i++) {
+                if (std::fabs(actual[i] - expected[i]) > 1.0e-10) {
+                    std::cout << name << ": node " << i << " is "
+                              << actual[i] << ", expected " << expected[i]
+                              << std::endl;
+                    failures++;
+                }
+            }
+        } catch (std::exception &e) {
+            std::cout << name << ": " << e.what() << std::endl;
+            failures++;
+        }
+        std::cout << name << (failures ? " failed" : " passed") << std::endl;
+        return failures;
+    }
+
+}
+
+int main() {
+    int failures = 0;
+    failures += compare("exogenous discounting", false);
+    // the swap helpers discount through a handle linked to the curve
+    // being solved, as bootstrapIrTermStructure() sets them up
+    failures += compare("single-curve discounting", true);
+    return failures == 0 ? 0 : 1;
+}
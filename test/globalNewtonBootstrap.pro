@@ -0,0 +1,3 @@
+include(test.pri)
+TARGET = globalNewtonBootstrap
+SOURCES += globalNewtonBootstrap.cpp
@@ -0,0 +1,156 @@
+/*
+ * Gsr with Gaussian1d integration against the GHW tree on the same
+ * co-terminal basket.
+ */
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+#include <ql/pricingengines/swaption/gaussian1dswaptionengine.hpp>
+#include <ql/pricingengines/swaption/treeswaptionengine.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <ql/time/daycounters/thirty360.hpp>
+#include <ql/time/schedule.hpp>
+
+#include "model/calibrationBasket.h"
+#include "model/piecewiseHullWhite.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+    // both models fit the basket exactly, so the Bermudans differ by the
+    // tree's discretization; one basis point of notional
+    const Real notional = 1000000.0;
+    const Real tolerance = 1.0e-4 * notional;
+
+    double milliseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    // a downward sloping lognormal vol term structure
+    Volatility basketVol(const Date &expiry, const Date &) {
+        Time t = Actual365Fixed().yearFraction(
+                    Settings::instance().evaluationDate(), expiry);
+        return 0.24 - 0.006 * t;
+    }
+
+    // 10y into 1y forward payer at the money, callable on every fixed
+    // coupon start; returns the number of failures
+    int compare(const std::string &name, Rate flatRate) {
+        Date today(16, July, 2019);
+        Settings::instance().evaluationDate() = today;
+        Calendar calendar = TARGET();
+        Date settlement = calendar.advance(today, 2, Days);
+        Handle<YieldTermStructure> curve(ext::make_shared<FlatForward>(
+                    settlement, flatRate, Actual365Fixed()));
+        ext::shared_ptr<IborIndex> libor(
+                    new USDLibor(Period(3, Months), curve));
+
+        Date start = calendar.advance(settlement, 1, Years);
+        Date maturity = calendar.advance(start, 10, Years);
+        Schedule fixedSchedule(start, maturity, Period(Annual), calendar,
+                               ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        Schedule floatSchedule(start, maturity, Period(Quarterly), calendar,
+                               ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        ext::shared_ptr<VanillaSwap> swap(new VanillaSwap(
+                    VanillaSwap::Payer, notional, fixedSchedule, 0.0,
+                    Thirty360(), floatSchedule, libor, 0.0, Actual360()));
+        swap->setPricingEngine(
+                    ext::make_shared<DiscountingSwapEngine>(curve));
+        Rate atm = swap->fairRate();
+        swap.reset(new VanillaSwap(
+                    VanillaSwap::Payer, notional, fixedSchedule, atm,
+                    Thirty360(), floatSchedule, libor, 0.0, Actual360()));
+
+        std::vector<Date> exerciseDates;
+        for (Size i = 0; i < swap->fixedLeg().size(); i++)
+            exerciseDates.push_back(ext::dynamic_pointer_cast<Coupon>(
+                        swap->fixedLeg()[i])->accrualStartDate());
+        ext::shared_ptr<Exercise> exercise(
+                    new BermudanExercise(exerciseDates));
+        Swaption bermudan(swap, exercise);
+
+        int failures = 0;
+        try {
+            // one basket each, as the engines are set on the helpers
+            std::vector<ext::shared_ptr<BlackCalibrationHelper> > gsrBasket =
+                    coterminalBasket(exercise, maturity, basketVol, libor,
+                                     Period(1, Years), Thirty360(),
+                                     Actual360(), curve);
+            std::vector<ext::shared_ptr<BlackCalibrationHelper> > ghwBasket =
+                    coterminalBasket(exercise, maturity, basketVol, libor,
+                                     Period(1, Years), Thirty360(),
+                                     Actual360(), curve);
+
+            std::chrono::steady_clock::time_point gsrStart =
+                        std::chrono::steady_clock::now();
+            ext::shared_ptr<Gsr> gsr(buildGsr(curve, gsrBasket, 0.03));
+            for (Size i = 0; i < gsrBasket.size(); i++)
+                gsrBasket[i]->setPricingEngine(
+                        ext::make_shared<Gaussian1dSwaptionEngine>(
+                            gsr, 64, 7.0, true, false, curve));
+            calibrateGsr(gsr, gsrBasket);
+            double gsrCalibration = milliseconds(gsrStart);
+            gsrStart = std::chrono::steady_clock::now();
+            bermudan.setPricingEngine(
+                        ext::make_shared<Gaussian1dSwaptionEngine>(
+                            gsr, 64, 7.0, true, false, curve));
+            Real gsrPrice = bermudan.NPV();
+            double gsrPricing = milliseconds(gsrStart);
+
+            // as getQuantLibPricingEngine() calibrates GHW from scratch
+            std::chrono::steady_clock::time_point ghwStart =
+                        std::chrono::steady_clock::now();
+            ext::shared_ptr<GeneralizedHullWhite> ghw(
+                        buildGhw(curve, ghwBasket, 0.03));
+            for (Size i = 0; i < ghwBasket.size(); i++)
+                ghwBasket[i]->setPricingEngine(
+                        ext::make_shared<TreeSwaptionEngine>(ghw, 150, curve));
+            calibrateGhw(ghw, ghwBasket, true);
+            for (Size pass = 0; pass < 2; pass++)
+                calibrateGhw(ghw, ghwBasket, false);
+            double ghwCalibration = milliseconds(ghwStart);
+            ghwStart = std::chrono::steady_clock::now();
+            bermudan.setPricingEngine(
+                        ext::make_shared<TreeSwaptionEngine>(ghw, 500, curve));
+            Real ghwPrice = bermudan.NPV();
+            double ghwPricing = milliseconds(ghwStart);
+
+            std::cout << name << ": Gsr " << gsrPrice << " (calibration "
+                      << gsrCalibration << " ms, pricing " << gsrPricing
+                      << " ms), GHW " << ghwPrice << " (calibration "
+                      << ghwCalibration << " ms, pricing " << ghwPricing
+                      << " ms)" << std::endl;
+            if (std::fabs(gsrPrice - ghwPrice) > tolerance) {
+                std::cout << name << ": prices differ by "
+                          << gsrPrice - ghwPrice << ", tolerance "
+                          << tolerance << std::endl;
+                failures++;
+            }
+        } catch (std::exception &e) {
+            std::cout << name << ": " << e.what() << std::endl;
+            failures++;
+        }
+        std::cout << name << (failures ? " failed" : " passed") << std::endl;
+        return failures;
+    }
+
+}
+
+int main() {
+    int failures = 0;
+    failures += compare("2% flat curve", 0.02);
+    failures += compare("4% flat curve", 0.04);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+include(test.pri)
+TARGET = gsrGhw
+SOURCES += gsrGhw.cpp \
+           ../src/model/calibrationBasket.cpp \
+           ../src/model/impliedVolatility.cpp \
+           ../src/model/piecewiseHullWhite.cpp
@@ -0,0 +1,138 @@
+/*
+ * The exercise-aware Hull-White FD engine on its reduced default grid
+ * against a fine uniform FdHullWhiteSwaptionEngine.
+ */
+
+#include <ql/cashflows/coupon.hpp>
+#include <ql/indexes/ibor/usdlibor.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+#include <ql/pricingengines/swaption/fdhullwhiteswaptionengine.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <ql/time/daycounters/thirty360.hpp>
+#include <ql/time/schedule.hpp>
+
+#include "model/fdHullWhiteExerciseEngine.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+    const Real notional = 1000000.0;
+    // half a basis point of notional
+    const Real tolerance = 0.5e-4 * notional;
+    // the default grid of getQuantLibPricingEngine()
+    const Size tGrid = 100, xGrid = 50;
+
+    double milliseconds(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    Real price(Swaption &swaption,
+               const ext::shared_ptr<PricingEngine> &engine, double &ms) {
+        std::chrono::steady_clock::time_point start =
+                    std::chrono::steady_clock::now();
+        swaption.setPricingEngine(engine);
+        Real value = swaption.NPV();
+        ms = milliseconds(start);
+        return value;
+    }
+
+    // a Bermudan callable on every fixed coupon start of a swap starting
+    // in startYears and running for lengthYears, struck moneyness off the
+    // money; returns the number of failures
+    int compare(const ext::shared_ptr<HullWhite> &model,
+                const Handle<YieldTermStructure> &curve,
+                Integer startYears, Integer lengthYears, Frequency fixedFreq,
+                VanillaSwap::Type type, Spread moneyness) {
+        Calendar calendar = TARGET();
+        Date settlement = curve->referenceDate();
+        ext::shared_ptr<IborIndex> libor(
+                    new USDLibor(Period(3, Months), curve));
+        Date start = calendar.advance(settlement, startYears, Years);
+        Date maturity = calendar.advance(start, lengthYears, Years);
+        Schedule fixedSchedule(start, maturity, Period(fixedFreq), calendar,
+                               ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        Schedule floatSchedule(start, maturity, Period(Quarterly), calendar,
+                               ModifiedFollowing, ModifiedFollowing,
+                               DateGeneration::Forward, false);
+        VanillaSwap atm(type, notional, fixedSchedule, 0.0, Thirty360(),
+                        floatSchedule, libor, 0.0, Actual360());
+        atm.setPricingEngine(ext::make_shared<DiscountingSwapEngine>(curve));
+        Rate strike = atm.fairRate() + moneyness;
+        ext::shared_ptr<VanillaSwap> swap(new VanillaSwap(
+                    type, notional, fixedSchedule, strike, Thirty360(),
+                    floatSchedule, libor, 0.0, Actual360()));
+
+        std::vector<Date> exerciseDates;
+        for (Size i = 0; i < swap->fixedLeg().size(); i++)
+            exerciseDates.push_back(ext::dynamic_pointer_cast<Coupon>(
+                        swap->fixedLeg()[i])->accrualStartDate());
+        Swaption bermudan(swap, ext::make_shared<BermudanExercise>(
+                                    exerciseDates));
+
+        std::ostringstream name;
+        name << startYears << "y into " << lengthYears << "y "
+             << (type == VanillaSwap::Payer ? "payer" : "receiver")
+             << " at " << strike;
+        int failures = 0;
+        try {
+            double referenceMs, uniformMs, reducedMs;
+            Real reference = price(bermudan,
+                    ext::make_shared<FdHullWhiteSwaptionEngine>(
+                            model, 1000, 1000), referenceMs);
+            Real uniform = price(bermudan,
+                    ext::make_shared<FdHullWhiteSwaptionEngine>(
+                            model, 100, 100), uniformMs);
+            Real reduced = price(bermudan,
+                    ext::make_shared<FdHullWhiteExerciseSwaptionEngine>(
+                            model, tGrid, xGrid), reducedMs);
+            std::cout << name.str() << ": reference " << reference
+                      << " (" << referenceMs << " ms), uniform 100 x 100 "
+                      << uniform - reference << " (" << uniformMs
+                      << " ms), exercise " << tGrid << " x " << xGrid << " "
+                      << reduced - reference << " (" << reducedMs << " ms)"
+                      << std::endl;
+            if (std::fabs(reduced - reference) > tolerance) {
+                std::cout << name.str() << ": off the reference by more "
+                          << "than " << tolerance << std::endl;
+                failures++;
+            }
+        } catch (std::exception &e) {
+            std::cout << name.str() << ": " << e.what() << std::endl;
+            failures++;
+        }
+        std::cout << name.str() << (failures ? " failed" : " passed")
+                  << std::endl;
+        return failures;
+    }
+
+}
+
+int main() {
+    Date today(16, July, 2019);
+    Settings::instance().evaluationDate() = today;
+    Handle<YieldTermStructure> curve(ext::make_shared<FlatForward>(
+                TARGET().advance(today, 2, Days), 0.02, Actual365Fixed()));
+    // the initial guess of getQuantLibPricingEngine()
+    ext::shared_ptr<HullWhite> model(new HullWhite(curve, 0.03, 0.00727));
+
+    int failures = 0;
+    failures += compare(model, curve, 1, 10, Annual, VanillaSwap::Payer, 0.0);
+    failures += compare(model, curve, 1, 10, Annual, VanillaSwap::Payer,
+                        -0.01);
+    failures += compare(model, curve, 5, 5, Annual, VanillaSwap::Receiver,
+                        -0.01);
+    failures += compare(model, curve, 2, 20, Semiannual,
+                        VanillaSwap::Receiver, 0.0);
+    return failures == 0 ? 0 : 1;
+}
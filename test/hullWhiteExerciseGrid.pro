@@ -0,0 +1,6 @@
+include(test.pri)
+TARGET = hullWhiteExerciseGrid
+SOURCES += hullWhiteExerciseGrid.cpp \
+           ../src/model/fdHullWhiteExerciseEngine.cpp \
+           ../src/model/gridSwaptionEngine.cpp \
+           ../src/model/hullWhiteKernels.cpp
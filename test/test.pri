@@ -0,0 +1,7 @@
+# settings shared by the check programs
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+DEPENDPATH += . ../src
+INCLUDEPATH += ../src ../include
+LIBS += -L../lib -lQuantLib
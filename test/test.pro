@@ -0,0 +1,15 @@
+######################################################################
+# Checks of the model code; each program exits non-zero on failure:
+#     qmake test.pro && make && ./globalNewtonBootstrap && ./gsrGhw &&
+#         ./g2GaussHermite && ./hullWhiteExerciseGrid &&
+#         ./controlVariate
+######################################################################
+
+TEMPLATE = subdirs
+SUBDIRS += globalNewtonBootstrap gsrGhw g2GaussHermite \
+           hullWhiteExerciseGrid controlVariate
+globalNewtonBootstrap.file = globalNewtonBootstrap.pro
+gsrGhw.file = gsrGhw.pro
+g2GaussHermite.file = g2GaussHermite.pro
+hullWhiteExerciseGrid.file = hullWhiteExerciseGrid.pro
+controlVariate.file = controlVariate.pro